@@ -0,0 +1,491 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "void_mapper.h"
+#include "void_mapper_parallel.h"
+#include "void_mapper_replay.h"
+#include "scenes.h"
+
+/*
+ * Benchmark of void mapper on seeded synthetic scenes.
+ *
+ * Every scene is run for a number of frames at each sprite count. The phases of a frame
+ * are timed one by one: void_mapper(), void_mapper_group_with_workspace() on its result,
+ * void_mapper_partition(), void_mapper_sweep(), void_mapper_soa() on the same
+ * sprites kept as separate arrays, and void_mapper_parallel() on --threads threads. The report has one line per scene, sprite count and phase,
+ * as CSV or JSON. Two CSV reports, for example from two builds, can be compared with
+ * --compare, which fails when a phase got slower than the threshold. With --record, the
+ * frames are written to a scene file for build/void-mapper instead of being timed.
+ */
+
+#define MAX_SPRITES 2000
+#define MAX_FRAMES 10000
+#define MAX_REPORTS (SCENE_COUNT * 16 * PHASE_COUNT)
+#define STACK_PAINT_SIZE (256 * 1024)
+#define STACK_PAINT 0xA5
+
+typedef enum {
+    PHASE_MAP,
+    PHASE_GROUP,
+    PHASE_PARTITION,
+    PHASE_SWEEP,
+    PHASE_SOA,
+    PHASE_PARALLEL,
+    PHASE_COUNT
+} phase_t;
+
+typedef struct {
+    char scene[16];
+    void_mapper_count_t sprites;
+    char phase[16];
+    uint32_t frames;
+    double mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    double rectangles;
+    size_t workspace_bytes;
+    size_t stack_bytes;
+} report_t;
+
+typedef struct {
+    scene_kind_t scenes[SCENE_COUNT];
+    int n_scenes;
+    void_mapper_count_t sprites[16];
+    int n_sprites;
+    uint32_t frames;
+    uint32_t seed;
+    void_mapper_rectangle_t area;
+    bool json;
+    const char *output;
+} options_t;
+
+static const char *phase_names[PHASE_COUNT] = { "map", "group", "partition", "sweep", "soa", "parallel" };
+static const void_mapper_count_t default_sprites[] = { 1, 10, 100, 500, 1000, 2000 };
+
+static void_mapper_rectangle_t sprites[MAX_SPRITES];
+static void_mapper_coord_t sprite_x[MAX_SPRITES];
+static void_mapper_coord_t sprite_y[MAX_SPRITES];
+static void_mapper_coord_t sprite_width[MAX_SPRITES];
+static void_mapper_coord_t sprite_height[MAX_SPRITES];
+static void_mapper_rectangle_t buffer[UINT16_MAX];
+/* Output of the engines that do not build on the result of void_mapper() */
+static void_mapper_rectangle_t engine_buffer[UINT16_MAX];
+static uint64_t samples[PHASE_COUNT][MAX_FRAMES];
+static report_t reports[MAX_REPORTS];
+
+/* Scratch of the partition or of the grouping of a full buffer, the largest workspace, allocated once */
+static void_mapper_workspace_t workspace;
+/* Threads of void_mapper_parallel(), 0 for one per processor */
+static unsigned int n_threads;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t *sorted, uint32_t n, uint32_t p)
+{
+    return sorted[(uint64_t) (n - 1) * p / 100];
+}
+
+/*
+ * The stack use of a call is measured by painting the stack below the caller, making the
+ * call and looking for the deepest byte that lost its paint. Both helpers must not be
+ * inlined so that their frames start where the frame of the measured call starts.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+static __attribute__((noinline)) void stack_paint(void)
+{
+    volatile uint8_t paint[STACK_PAINT_SIZE];
+    for (size_t i = 0; i < STACK_PAINT_SIZE; i++) {
+        paint[i] = STACK_PAINT;
+    }
+}
+
+static __attribute__((noinline)) size_t stack_used(void)
+{
+    volatile uint8_t paint[STACK_PAINT_SIZE];
+    size_t i = 0;
+    while (i < STACK_PAINT_SIZE && paint[i] == STACK_PAINT) {
+        i++;
+    }
+    return STACK_PAINT_SIZE - i;
+}
+#pragma GCC diagnostic pop
+
+static void_mapper_count_t run_phase(phase_t phase, void_mapper_rectangle_t area, void_mapper_count_t n_sprites, void_mapper_count_t n_voids)
+{
+    switch (phase) {
+    case PHASE_MAP:
+        return void_mapper(area, sprites, n_sprites, buffer, UINT16_MAX);
+    case PHASE_GROUP:
+        return void_mapper_group_with_workspace(buffer, n_voids, &workspace);
+    case PHASE_PARTITION:
+        return void_mapper_partition(area, sprites, n_sprites, engine_buffer, UINT16_MAX, &workspace);
+    case PHASE_SWEEP:
+        return void_mapper_sweep(area, sprites, n_sprites, engine_buffer, UINT16_MAX, &workspace);
+    case PHASE_SOA:
+        return void_mapper_soa(area, sprite_x, sprite_y, sprite_width, sprite_height, n_sprites,
+                               engine_buffer, UINT16_MAX, &workspace);
+    case PHASE_PARALLEL:
+        return void_mapper_parallel(area, sprites, n_sprites, engine_buffer, UINT16_MAX, n_threads);
+    default:
+        return 0;
+    }
+}
+
+static size_t phase_workspace(phase_t phase, void_mapper_count_t n_sprites)
+{
+    switch (phase) {
+    case PHASE_MAP:
+    case PHASE_SOA:
+        return void_mapper_workspace_size(n_sprites);
+    case PHASE_PARTITION:
+        return void_mapper_partition_workspace_size(n_sprites);
+    case PHASE_SWEEP:
+        return void_mapper_sweep_workspace_size(n_sprites);
+    case PHASE_GROUP:
+        return void_mapper_group_workspace_size(UINT16_MAX);
+    default:
+        return 0;
+    }
+}
+
+static int run_scene(const options_t *options, scene_kind_t kind, void_mapper_count_t n_sprites, report_t *report)
+{
+    const void_mapper_rectangle_t area = options->area;
+    double rectangles[PHASE_COUNT] = { 0 };
+    size_t stack[PHASE_COUNT] = { 0 };
+    scene_t scene;
+
+    scene_init(&scene, kind, area, options->seed + n_sprites);
+
+    for (uint32_t frame = 0; frame < options->frames; frame++) {
+        scene_frame(&scene, frame, sprites, n_sprites);
+        for (void_mapper_count_t i = 0; i < n_sprites; i++) {
+            sprite_x[i] = sprites[i].position.x;
+            sprite_y[i] = sprites[i].position.y;
+            sprite_width[i] = sprites[i].size.x;
+            sprite_height[i] = sprites[i].size.y;
+        }
+
+        /* The first frame measures the stack of each phase, and warms the caches up */
+        if (frame == 0) {
+            void_mapper_count_t n_voids = 0;
+            for (int p = 0; p < PHASE_COUNT; p++) {
+                n_voids = run_phase(PHASE_MAP, area, n_sprites, 0);
+                run_phase(p, area, n_sprites, n_voids);
+                if (p == PHASE_GROUP) {
+                    n_voids = run_phase(PHASE_MAP, area, n_sprites, 0);
+                }
+                stack_paint();
+                run_phase(p, area, n_sprites, n_voids);
+                stack[p] = stack_used();
+            }
+        }
+
+        void_mapper_count_t n_voids = 0;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            uint64_t start = now_ns();
+            void_mapper_count_t n = run_phase(p, area, n_sprites, n_voids);
+            samples[p][frame] = now_ns() - start;
+
+            rectangles[p] += n;
+            if (p == PHASE_MAP) {
+                n_voids = n;
+            }
+        }
+    }
+
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        double total = 0;
+        for (uint32_t f = 0; f < options->frames; f++) {
+            total += samples[p][f];
+        }
+        qsort(samples[p], options->frames, sizeof(samples[p][0]), compare_samples);
+
+        report_t *r = &report[p];
+        snprintf(r->scene, sizeof(r->scene), "%s", scene_name(kind));
+        snprintf(r->phase, sizeof(r->phase), "%s", phase_names[p]);
+        r->sprites = n_sprites;
+        r->frames = options->frames;
+        r->mean_ns = total / options->frames;
+        r->p50_ns = percentile(samples[p], options->frames, 50);
+        r->p90_ns = percentile(samples[p], options->frames, 90);
+        r->p99_ns = percentile(samples[p], options->frames, 99);
+        r->max_ns = samples[p][options->frames - 1];
+        r->rectangles = rectangles[p] / options->frames;
+        r->workspace_bytes = phase_workspace(p, n_sprites);
+        r->stack_bytes = stack[p];
+    }
+
+    return PHASE_COUNT;
+}
+
+static void print_csv(FILE *out, const report_t *reports, int n_reports)
+{
+    fprintf(out, "scene,sprites,phase,frames,mean_ns,p50_ns,p90_ns,p99_ns,max_ns,rectangles,workspace_bytes,stack_bytes\n");
+    for (int i = 0; i < n_reports; i++) {
+        const report_t *r = &reports[i];
+        fprintf(out, "%s,%u,%s,%u,%.1f,%llu,%llu,%llu,%llu,%.1f,%zu,%zu\n",
+                r->scene, r->sprites, r->phase, r->frames, r->mean_ns,
+                (unsigned long long) r->p50_ns, (unsigned long long) r->p90_ns,
+                (unsigned long long) r->p99_ns, (unsigned long long) r->max_ns,
+                r->rectangles, r->workspace_bytes, r->stack_bytes);
+    }
+}
+
+static void print_json(FILE *out, const report_t *reports, int n_reports)
+{
+    fprintf(out, "[\n");
+    for (int i = 0; i < n_reports; i++) {
+        const report_t *r = &reports[i];
+        fprintf(out, "  {\"scene\": \"%s\", \"sprites\": %u, \"phase\": \"%s\", \"frames\": %u, "
+                "\"mean_ns\": %.1f, \"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu, "
+                "\"rectangles\": %.1f, \"workspace_bytes\": %zu, \"stack_bytes\": %zu}%s\n",
+                r->scene, r->sprites, r->phase, r->frames, r->mean_ns,
+                (unsigned long long) r->p50_ns, (unsigned long long) r->p90_ns,
+                (unsigned long long) r->p99_ns, (unsigned long long) r->max_ns,
+                r->rectangles, r->workspace_bytes, r->stack_bytes, i + 1 < n_reports ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+static int read_csv(const char *path, report_t *reports, int max_reports)
+{
+    FILE *in = fopen(path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "bench: cannot open %s\n", path);
+        return -1;
+    }
+
+    char line[512];
+    int n = 0;
+    while (n < max_reports && fgets(line, sizeof(line), in) != NULL) {
+        report_t *r = &reports[n];
+        unsigned int sprites;
+        unsigned long long p50, p90, p99, max;
+        if (sscanf(line, "%15[^,],%u,%15[^,],%u,%lf,%llu,%llu,%llu,%llu,%lf,%zu,%zu",
+                   r->scene, &sprites, r->phase, &r->frames, &r->mean_ns, &p50, &p90, &p99, &max,
+                   &r->rectangles, &r->workspace_bytes, &r->stack_bytes) != 12) {
+            continue; /* Header */
+        }
+        r->sprites = sprites;
+        r->p50_ns = p50;
+        r->p90_ns = p90;
+        r->p99_ns = p99;
+        r->max_ns = max;
+        n++;
+    }
+
+    fclose(in);
+    return n;
+}
+
+static int compare_reports(const char *base_path, const char *new_path, double threshold)
+{
+    static report_t base[MAX_REPORTS];
+    static report_t next[MAX_REPORTS];
+    int n_base = read_csv(base_path, base, MAX_REPORTS);
+    int n_next = read_csv(new_path, next, MAX_REPORTS);
+    if (n_base < 0 || n_next < 0) {
+        return EXIT_FAILURE;
+    }
+
+    int n_regressions = 0;
+    printf("%-10s %8s %-10s %12s %12s %9s %10s %10s\n",
+           "scene", "sprites", "phase", "base_p50", "new_p50", "change", "base_rects", "new_rects");
+    for (int i = 0; i < n_next; i++) {
+        const report_t *n = &next[i];
+        const report_t *b = NULL;
+        for (int j = 0; j < n_base && b == NULL; j++) {
+            if (base[j].sprites == n->sprites && strcmp(base[j].scene, n->scene) == 0 && strcmp(base[j].phase, n->phase) == 0) {
+                b = &base[j];
+            }
+        }
+        if (b == NULL) {
+            continue;
+        }
+
+        double change = b->p50_ns > 0 ? 100.0 * ((double) n->p50_ns - (double) b->p50_ns) / (double) b->p50_ns : 0;
+        bool regression = change > threshold;
+        n_regressions += regression;
+        printf("%-10s %8u %-10s %12llu %12llu %+8.1f%% %10.1f %10.1f%s\n",
+               n->scene, n->sprites, n->phase, (unsigned long long) b->p50_ns, (unsigned long long) n->p50_ns,
+               change, b->rectangles, n->rectangles, regression ? "  SLOWER" : "");
+    }
+
+    printf("%d regression(s) over %.1f%%\n", n_regressions, threshold);
+    return n_regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* Write the frames of every scene and sprite count to a scene file, one after the other */
+static int record_scenes(const options_t *options, const char *path)
+{
+    void_mapper_replay_writer_t writer;
+    if (!void_mapper_replay_create(&writer, path, VOID_MAPPER_REPLAY_SCENES)) {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    bool written = true;
+    for (int s = 0; s < options->n_scenes; s++) {
+        for (int c = 0; c < options->n_sprites; c++) {
+            scene_t scene;
+            scene_init(&scene, options->scenes[s], options->area, options->seed + options->sprites[c]);
+            for (uint32_t frame = 0; frame < options->frames; frame++) {
+                scene_frame(&scene, frame, sprites, options->sprites[c]);
+                written = void_mapper_replay_write(&writer, options->area, sprites, options->sprites[c]) && written;
+            }
+        }
+    }
+
+    if (!void_mapper_replay_finish(&writer) || !written) {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: bench [--scene random|tiles|particles|hud]... [--sprites N]... [--frames N]\n"
+            "             [--seed N] [--area WIDTHxHEIGHT] [--threads N] [--json] [--output FILE]\n"
+            "             [--record SCENES]\n"
+            "       bench --compare BASE.csv NEW.csv [--threshold PERCENT]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    options_t options = { .frames = 100, .seed = 0x9E3779B9u, .area = { .position = { 0, 0 }, .size = { 320, 240 } } };
+    const char *compare[2] = { NULL, NULL };
+    const char *record = NULL;
+    double threshold = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--scene") == 0 && has_value && options.n_scenes < SCENE_COUNT) {
+            if (!scene_parse(argv[++i], &options.scenes[options.n_scenes++])) {
+                usage();
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[i], "--sprites") == 0 && has_value && options.n_sprites < 16) {
+            long n = strtol(argv[++i], NULL, 10);
+            if (n < 1 || n > MAX_SPRITES) {
+                fprintf(stderr, "bench: between 1 and %d sprites\n", MAX_SPRITES);
+                return EXIT_FAILURE;
+            }
+            options.sprites[options.n_sprites++] = n;
+        } else if (strcmp(argv[i], "--frames") == 0 && has_value) {
+            long n = strtol(argv[++i], NULL, 10);
+            options.frames = n < 1 ? 1 : n > MAX_FRAMES ? MAX_FRAMES : n;
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            options.seed = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--area") == 0 && has_value) {
+            unsigned long width, height;
+            if (sscanf(argv[++i], "%lux%lu", &width, &height) != 2 || width < 1 || height < 1 ||
+                width > VOID_MAPPER_COORD_MAX || height > VOID_MAPPER_COORD_MAX) {
+                usage();
+                return EXIT_FAILURE;
+            }
+            options.area.size.x = width;
+            options.area.size.y = height;
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            n_threads = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        } else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            options.output = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) {
+            compare[0] = argv[++i];
+            compare[1] = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && has_value) {
+            record = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && has_value) {
+            threshold = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--help") == 0) {
+            usage();
+            return EXIT_SUCCESS;
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (compare[0] != NULL) {
+        return compare_reports(compare[0], compare[1], threshold);
+    }
+
+    if (options.n_scenes == 0) {
+        for (int k = 0; k < SCENE_COUNT; k++) {
+            options.scenes[options.n_scenes++] = k;
+        }
+    }
+    if (options.n_sprites == 0) {
+        for (size_t c = 0; c < sizeof(default_sprites) / sizeof(default_sprites[0]); c++) {
+            options.sprites[options.n_sprites++] = default_sprites[c];
+        }
+    }
+
+    if (record != NULL) {
+        return record_scenes(&options, record);
+    }
+
+    void_mapper_count_t max_sprites = 0;
+    for (int c = 0; c < options.n_sprites; c++) {
+        max_sprites = options.sprites[c] > max_sprites ? options.sprites[c] : max_sprites;
+    }
+    workspace.size = void_mapper_partition_workspace_size(max_sprites);
+    if (workspace.size < void_mapper_group_workspace_size(UINT16_MAX)) {
+        workspace.size = void_mapper_group_workspace_size(UINT16_MAX);
+    }
+    workspace.memory = malloc(workspace.size);
+    if (workspace.memory == NULL) {
+        fprintf(stderr, "bench: out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    int n_reports = 0;
+    for (int s = 0; s < options.n_scenes; s++) {
+        for (int c = 0; c < options.n_sprites; c++) {
+            n_reports += run_scene(&options, options.scenes[s], options.sprites[c], &reports[n_reports]);
+        }
+    }
+    free(workspace.memory);
+
+    FILE *out = stdout;
+    if (options.output != NULL && (out = fopen(options.output, "w")) == NULL) {
+        fprintf(stderr, "bench: cannot write %s\n", options.output);
+        return EXIT_FAILURE;
+    }
+
+    if (options.json) {
+        print_json(out, reports, n_reports);
+    } else {
+        print_csv(out, reports, n_reports);
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    return EXIT_SUCCESS;
+}
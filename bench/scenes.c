@@ -0,0 +1,216 @@
+#include <string.h>
+#include "scenes.h"
+
+#define TICKER_GLYPHS_PER_LINE 40
+
+static const char *names[SCENE_COUNT] = {
+    [SCENE_RANDOM] = "random",
+    [SCENE_TILES] = "tiles",
+    [SCENE_PARTICLES] = "particles",
+    [SCENE_HUD] = "hud",
+};
+
+/**
+ * @brief Next number of the xorshift32 sequence of the scene.
+ */
+static uint32_t next_random(scene_t *scene);
+
+/**
+ * @brief Greatest common divisor.
+ */
+static uint32_t gcd(uint32_t a, uint32_t b);
+
+/**
+ * @brief Sprites of random size at random positions, partly outside the area.
+ */
+static void random_frame(scene_t *scene, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites);
+
+/**
+ * @brief Tiles on a fixed map, the largest tile size that still fits all of them.
+ */
+static void tiles_frame(scene_t *scene, uint32_t frame, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites);
+
+/**
+ * @brief Particles of a burst, the burst starts over every 64 frames.
+ */
+static void particles_frame(scene_t *scene, uint32_t frame, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites);
+
+/**
+ * @brief Two status bars, and glyphs scrolling to the left in the bottom bar.
+ */
+static void hud_frame(scene_t *scene, uint32_t frame, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites);
+
+static uint32_t next_random(scene_t *scene)
+{
+    scene->random_state ^= scene->random_state << 13;
+    scene->random_state ^= scene->random_state >> 17;
+    scene->random_state ^= scene->random_state << 5;
+    return scene->random_state;
+}
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static void random_frame(scene_t *scene, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites)
+{
+    void_mapper_rectangle_t area = scene->area;
+    for (void_mapper_count_t i = 0; i < n_sprites; i++) {
+        sprites[i] = (void_mapper_rectangle_t) {
+            .position.x = area.position.x + next_random(scene) % area.size.x,
+            .position.y = area.position.y + next_random(scene) % area.size.y,
+            .size.x = 8 + next_random(scene) % 40,
+            .size.y = 8 + next_random(scene) % 40,
+        };
+    }
+}
+
+static void tiles_frame(scene_t *scene, uint32_t frame, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites)
+{
+    void_mapper_rectangle_t area = scene->area;
+    void_mapper_coord_t tile = 32;
+    while (tile > 1 && (uint32_t) (area.size.x / tile) * (area.size.y / tile) < n_sprites) {
+        tile /= 2;
+    }
+
+    uint32_t columns = area.size.x / tile;
+    uint32_t rows = area.size.y / tile;
+    uint32_t n_tiles = columns * rows;
+    void_mapper_coord_t scroll = frame % tile;
+
+    /* Walk the map with a stride coprime to its size, each tile is used at most once */
+    uint32_t stride = 1 + scene->seed % n_tiles;
+    while (gcd(stride, n_tiles) != 1) {
+        stride++;
+    }
+
+    for (void_mapper_count_t i = 0; i < n_sprites; i++) {
+        uint32_t t = ((uint32_t) i * stride) % n_tiles;
+        sprites[i] = (void_mapper_rectangle_t) {
+            .position.x = area.position.x + (t % columns) * tile + scroll,
+            .position.y = area.position.y + (t / columns) * tile,
+            .size.x = tile,
+            .size.y = tile,
+        };
+    }
+}
+
+static void particles_frame(scene_t *scene, uint32_t frame, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites)
+{
+    void_mapper_rectangle_t area = scene->area;
+    int32_t cx = area.position.x + area.size.x / 2;
+    int32_t cy = area.position.y + area.size.y / 2;
+    int32_t t = frame % 64;
+
+    /* The velocities are the same for every frame of a burst */
+    scene->random_state = scene->seed;
+    for (void_mapper_count_t i = 0; i < n_sprites; i++) {
+        int32_t vx = (int32_t) (next_random(scene) % 129) - 64;
+        int32_t vy = (int32_t) (next_random(scene) % 129) - 64;
+        void_mapper_coord_t size = 2 + next_random(scene) % 3;
+        int32_t x = cx + vx * t / 16;
+        int32_t y = cy + vy * t / 16;
+
+        /* Particles leaving the area stay at its edge, clamped in 64 bits for unsigned 32 bit coordinates */
+        int64_t x_lo = area.position.x, x_hi = (int64_t) area.position.x + area.size.x - size;
+        int64_t y_lo = area.position.y, y_hi = (int64_t) area.position.y + area.size.y - size;
+        x = x < x_lo ? (int32_t) x_lo : x > x_hi ? (int32_t) x_hi : x;
+        y = y < y_lo ? (int32_t) y_lo : y > y_hi ? (int32_t) y_hi : y;
+
+        sprites[i] = (void_mapper_rectangle_t) {
+            .position.x = x,
+            .position.y = y,
+            .size.x = size,
+            .size.y = size,
+        };
+    }
+}
+
+static void hud_frame(scene_t *scene, uint32_t frame, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites)
+{
+    void_mapper_rectangle_t area = scene->area;
+    void_mapper_coord_t bar = area.size.y / 10;
+    void_mapper_count_t i = 0;
+
+    if (i < n_sprites) {
+        sprites[i++] = (void_mapper_rectangle_t) {
+            .position = area.position,
+            .size.x = area.size.x,
+            .size.y = bar,
+        };
+    }
+
+    if (i < n_sprites) {
+        sprites[i++] = (void_mapper_rectangle_t) {
+            .position.x = area.position.x,
+            .position.y = area.position.y + area.size.y - bar,
+            .size.x = area.size.x / 4,
+            .size.y = bar,
+        };
+    }
+
+    /* Glyphs of 6x8 pixels with a gap of 2, the lines stack upwards from the bottom bar */
+    void_mapper_coord_t scroll = frame % 8;
+    for (void_mapper_count_t g = 0; i < n_sprites; g++, i++) {
+        void_mapper_count_t line = g / TICKER_GLYPHS_PER_LINE;
+        void_mapper_count_t column = g % TICKER_GLYPHS_PER_LINE;
+        sprites[i] = (void_mapper_rectangle_t) {
+            .position.x = area.position.x + area.size.x / 4 + column * 8 - scroll,
+            .position.y = area.position.y + area.size.y - bar + 2 - (line % ((area.size.y - bar) / 8)) * 8,
+            .size.x = 6,
+            .size.y = 8,
+        };
+    }
+}
+
+const char *scene_name(scene_kind_t kind)
+{
+    return kind < SCENE_COUNT ? names[kind] : "unknown";
+}
+
+bool scene_parse(const char *name, scene_kind_t *kind)
+{
+    for (int k = 0; k < SCENE_COUNT; k++) {
+        if (strcmp(name, names[k]) == 0) {
+            *kind = k;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void scene_init(scene_t *scene, scene_kind_t kind, void_mapper_rectangle_t area, uint32_t seed)
+{
+    scene->kind = kind;
+    scene->area = area;
+    scene->seed = seed != 0 ? seed : 1;
+    scene->random_state = scene->seed;
+}
+
+void scene_frame(scene_t *scene, uint32_t frame, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites)
+{
+    switch (scene->kind) {
+    case SCENE_RANDOM:
+        random_frame(scene, sprites, n_sprites);
+        break;
+    case SCENE_TILES:
+        tiles_frame(scene, frame, sprites, n_sprites);
+        break;
+    case SCENE_PARTICLES:
+        particles_frame(scene, frame, sprites, n_sprites);
+        break;
+    case SCENE_HUD:
+        hud_frame(scene, frame, sprites, n_sprites);
+        break;
+    default:
+        memset(sprites, 0, n_sprites * sizeof(sprites[0]));
+        break;
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef __SCENES_H__
+#define __SCENES_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "void_mapper.h"
+
+/**
+ * @brief Synthetic sprite scenes of the benchmark. Every scene is generated from a seed,
+ * so the same seed gives the same frames on every run and every build.
+ */
+
+typedef enum {
+    SCENE_RANDOM,       /* Sprites of random size at random positions, new ones every frame */
+    SCENE_TILES,        /* Square tiles sharing their edges, scrolling by a pixel per frame */
+    SCENE_PARTICLES,    /* Small particles flying away from the middle of the area */
+    SCENE_HUD,          /* Status bars and a line of glyphs scrolling through the bottom bar */
+    SCENE_COUNT
+} scene_kind_t;
+
+typedef struct {
+    scene_kind_t kind;
+    void_mapper_rectangle_t area;
+    uint32_t seed;
+    uint32_t random_state;
+} scene_t;
+
+/**
+ * @brief Name of a kind of scene, as used on the command line and in the reports.
+ *
+ * @param kind Kind of scene
+ * @return const char* the name
+ */
+const char *scene_name(scene_kind_t kind);
+
+/**
+ * @brief Find a kind of scene by its name.
+ *
+ * @param name Name of the scene
+ * @param kind Kind of the scene, set if found
+ * @return true if the name is known
+ * @return false if it is not
+ */
+bool scene_parse(const char *name, scene_kind_t *kind);
+
+/**
+ * @brief Prepare a scene.
+ *
+ * @param scene Scene to prepare
+ * @param kind Kind of scene
+ * @param area Area of the screen
+ * @param seed Seed of the scene
+ */
+void scene_init(scene_t *scene, scene_kind_t kind, void_mapper_rectangle_t area, uint32_t seed);
+
+/**
+ * @brief Generate the sprites of one frame of a scene.
+ *
+ * @param scene Prepared scene
+ * @param frame Number of the frame
+ * @param sprites Storage for the sprites
+ * @param n_sprites Number of sprites to generate
+ */
+void scene_frame(scene_t *scene, uint32_t frame, void_mapper_rectangle_t *sprites, void_mapper_count_t n_sprites);
+
+#endif /* __SCENES_H__ */
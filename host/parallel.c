@@ -0,0 +1,492 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "void_mapper_parallel.h"
+#include "coordinates.h"
+#include "stats.h"
+
+/* More bands than threads, so that a thread done with an empty band takes another one */
+#define BANDS_PER_THREAD 4
+
+/* Jobs of a batch taken at once by a thread, small jobs are not worth a trip to the counter */
+#define BATCH_CHUNK 8
+
+typedef struct {
+    void_mapper_rectangle_t area;       /* Part of the area covered by the band */
+    void_mapper_rectangle_t *input;     /* Input rectangles crossing the band */
+    void_mapper_count_t input_length;
+    void_mapper_rectangle_t *voids;     /* Voids of the band, in raster order */
+    void_mapper_count_t n_voids;
+    bool failed;
+} band_t;
+
+typedef struct {
+    band_t *bands;
+    void_mapper_count_t n_bands;
+    void_mapper_count_t max_input;      /* Longest input of a band, sizes the workspaces */
+    atomic_uint next;                   /* Next band to be taken by a thread */
+} job_t;
+
+typedef struct {
+    void_mapper_coord_t x;
+    void_mapper_count_t index;
+} seam_t;
+
+typedef struct {
+    void_mapper_job_t *jobs;
+    size_t n_jobs;
+    size_t workspace_size;              /* Workspace of each thread, for the longest input */
+    atomic_size_t next;                 /* Next job to be taken by a thread */
+    atomic_size_t n_failed;
+} batch_t;
+
+/**
+ * @brief Find the bands crossed by an input rectangle.
+ *
+ * @param area Area to search
+ * @param band_height Height of every band but the last
+ * @param rectangle Input rectangle
+ * @param first First band crossed
+ * @param last Last band crossed
+ * @return true if the rectangle covers some of the area
+ * @return false if it does not
+ */
+static bool band_range(void_mapper_rectangle_t area, void_mapper_coord_t band_height, const void_mapper_rectangle_t *rectangle,
+                       void_mapper_count_t *first, void_mapper_count_t *last);
+
+/**
+ * @brief Map the voids of a band into a buffer of the thread, then keep them in a copy of
+ * their exact size. The buffer starts small and doubles while it is too small, jumping to
+ * the count of void cells at the first step, up to VOID_MAPPER_COUNT_MAX elements.
+ *
+ * @param band Band to map
+ * @param workspace Workspace of the thread
+ * @param scratch Buffer of the thread, grown when needed
+ * @param scratch_length Number of elements of the buffer
+ * @return true on success
+ * @return false if memory is short
+ */
+static bool map_band(band_t *band, const void_mapper_workspace_t *workspace,
+                     void_mapper_rectangle_t **scratch, size_t *scratch_length);
+
+/**
+ * @brief Thread taking bands until none is left.
+ *
+ * @param arg Job shared by the threads
+ * @return void* NULL
+ */
+static void *worker(void *arg);
+
+/**
+ * @brief Thread taking chunks of a batch until none is left.
+ *
+ * @param arg Batch shared by the threads
+ * @return void* NULL
+ */
+static void *batch_worker(void *arg);
+
+/**
+ * @brief Number of threads to use.
+ *
+ * @param n_threads Number of threads asked for, 0 for one per online processor
+ * @return unsigned int the number of threads, at least 1
+ */
+static unsigned int thread_count(unsigned int n_threads);
+
+/**
+ * @brief Run a function on the calling thread and n_threads - 1 more, and wait for all of
+ * them. Threads that fail to start leave their share to the others. The statistics are
+ * unhooked meanwhile, as their counters are shared by all threads.
+ *
+ * @param work Function run by every thread
+ * @param arg Argument of the function, shared by the threads
+ * @param n_threads Number of threads
+ */
+static void run_threads(void *(*work)(void *), void *arg, unsigned int n_threads);
+
+/**
+ * @brief Join the voids of the bands in the buffer, merging the voids across the seams.
+ *
+ * @param bands Mapped bands, from top to bottom
+ * @param n_bands Number of bands
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param open Voids ending on the current seam, room for the most voids of a band
+ * @param next Voids ending on the next seam, same size as open
+ * @return void_mapper_count_t number of voids, 0 if the buffer is too small
+ */
+static void_mapper_count_t stitch(const band_t *bands, void_mapper_count_t n_bands,
+                                  void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                  seam_t *open, seam_t *next);
+
+/**
+ * @brief Give each band the input rectangles crossing it. The bands share one array of
+ * rectangles, a rectangle crossing several bands is in it once for each.
+ *
+ * @param job Job with its bands allocated
+ * @param area Area to search
+ * @param band_height Height of every band but the last
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @return void_mapper_rectangle_t* the shared array, NULL if memory is short
+ */
+static void_mapper_rectangle_t *bin_input(job_t *job, void_mapper_rectangle_t area, void_mapper_coord_t band_height,
+                                          const void_mapper_rectangle_t *input, void_mapper_count_t input_length);
+
+/**
+ * @brief Stitch the voids of the mapped bands into the buffer.
+ *
+ * @param job Job with its bands mapped
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @return void_mapper_count_t number of voids, 0 if a band failed or the buffer is too small
+ */
+static void_mapper_count_t join_bands(const job_t *job, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length);
+
+static bool band_range(void_mapper_rectangle_t area, void_mapper_coord_t band_height, const void_mapper_rectangle_t *rectangle,
+                       void_mapper_count_t *first, void_mapper_count_t *last)
+{
+    void_mapper_coord_t x0 = rectangle->position.x > area.position.x ? rectangle->position.x : area.position.x;
+    void_mapper_coord_t y0 = rectangle->position.y > area.position.y ? rectangle->position.y : area.position.y;
+    void_mapper_coord_t x1 = coordinates_end(rectangle->position.x, rectangle->size.x);
+    void_mapper_coord_t y1 = coordinates_end(rectangle->position.y, rectangle->size.y);
+    void_mapper_coord_t area_x1 = coordinates_end(area.position.x, area.size.x);
+    void_mapper_coord_t area_y1 = coordinates_end(area.position.y, area.size.y);
+    x1 = x1 < area_x1 ? x1 : area_x1;
+    y1 = y1 < area_y1 ? y1 : area_y1;
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+
+    *first = (y0 - area.position.y) / band_height;
+    *last = (y1 - 1 - area.position.y) / band_height;
+
+    return true;
+}
+
+static bool map_band(band_t *band, const void_mapper_workspace_t *workspace,
+                     void_mapper_rectangle_t **scratch, size_t *scratch_length)
+{
+    /* Most inputs leave a few voids per rectangle, far from the bound of the grid */
+    size_t length = 4 * (size_t) band->input_length + 16;
+    length = length > VOID_MAPPER_COUNT_MAX ? VOID_MAPPER_COUNT_MAX : length;
+    length = length > *scratch_length ? length : *scratch_length;
+
+    /* Void cells of the band, only counted once the first guess fails */
+    size_t bound = 0;
+    bool counted = false;
+
+    void_mapper_count_t n = 0;
+    for (;;) {
+        if (length > *scratch_length) {
+            void_mapper_rectangle_t *grown = realloc(*scratch, length * sizeof(grown[0]));
+            if (grown == NULL) {
+                return false;
+            }
+            *scratch = grown;
+            *scratch_length = length;
+        }
+
+        n = void_mapper_grouped(band->area, band->input, band->input_length, *scratch, *scratch_length, workspace);
+        if (n > 0) {
+            break;
+        }
+
+        /* Either the band is covered, or the buffer is too small for its voids */
+        if (!counted) {
+            bound = void_mapper_count(band->area, band->input, band->input_length, workspace);
+            counted = true;
+        }
+        if (bound == 0 || *scratch_length >= VOID_MAPPER_COUNT_MAX) {
+            break;
+        }
+
+        /* The count saturates, so it is a first step rather than the exact need */
+        length = 2 * *scratch_length;
+        length = length < bound ? bound : length;
+        length = length > VOID_MAPPER_COUNT_MAX ? VOID_MAPPER_COUNT_MAX : length;
+    }
+
+    band->n_voids = n;
+    if (n == 0) {
+        return bound == 0;
+    }
+
+    band->voids = malloc(n * sizeof(band->voids[0]));
+    if (band->voids == NULL) {
+        return false;
+    }
+    memcpy(band->voids, *scratch, n * sizeof(band->voids[0]));
+
+    return true;
+}
+
+static void *worker(void *arg)
+{
+    job_t *job = arg;
+    void_mapper_workspace_t workspace = { .size = void_mapper_workspace_size(job->max_input) };
+    void_mapper_rectangle_t *scratch = NULL;
+    size_t scratch_length = 0;
+
+    /* Aligned for void_mapper_word_t, as malloc is aligned for every type */
+    workspace.memory = malloc(workspace.size);
+
+    while (true) {
+        unsigned int b = atomic_fetch_add(&job->next, 1);
+        if (b >= job->n_bands) {
+            break;
+        }
+
+        band_t *band = &job->bands[b];
+        band->failed = workspace.memory == NULL || !map_band(band, &workspace, &scratch, &scratch_length);
+    }
+
+    free(scratch);
+    free(workspace.memory);
+
+    return NULL;
+}
+
+static int compare_seams(const void *a, const void *b)
+{
+    void_mapper_coord_t x = ((const seam_t *) a)->x;
+    void_mapper_coord_t y = ((const seam_t *) b)->x;
+    return x < y ? -1 : x > y;
+}
+
+static void_mapper_count_t stitch(const band_t *bands, void_mapper_count_t n_bands,
+                                  void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                  seam_t *open, seam_t *next)
+{
+    void_mapper_count_t n_found = 0;
+    void_mapper_count_t n_open = 0;
+
+    for (void_mapper_count_t b = 0; b < n_bands; b++) {
+        const band_t *band = &bands[b];
+        void_mapper_coord_t top = band->area.position.y;
+        void_mapper_coord_t bottom = coordinates_end(top, band->area.size.y);
+        void_mapper_count_t n_next = 0;
+        void_mapper_count_t k = 0;
+
+        for (void_mapper_count_t v = 0; v < band->n_voids; v++) {
+            const void_mapper_rectangle_t *r = &band->voids[v];
+            void_mapper_count_t index;
+
+            /* The voids on the top edge come first, from left to right like the open list */
+            while (r->position.y == top && k < n_open && open[k].x < r->position.x) {
+                k++;
+            }
+
+            if (r->position.y == top && k < n_open && open[k].x == r->position.x &&
+                buffer[open[k].index].size.x == r->size.x) {
+                index = open[k++].index;
+                buffer[index].size.y += r->size.y;
+            } else if (n_found < buffer_length) {
+                index = n_found;
+                buffer[n_found++] = *r;
+            } else {
+                return 0;
+            }
+
+            if (coordinates_end(r->position.y, r->size.y) == bottom) {
+                next[n_next++] = (seam_t) { .x = r->position.x, .index = index };
+            }
+        }
+
+        qsort(next, n_next, sizeof(next[0]), compare_seams);
+
+        seam_t *swap = open;
+        open = next;
+        next = swap;
+        n_open = n_next;
+    }
+
+    return n_found;
+}
+
+static void_mapper_rectangle_t *bin_input(job_t *job, void_mapper_rectangle_t area, void_mapper_coord_t band_height,
+                                          const void_mapper_rectangle_t *input, void_mapper_count_t input_length)
+{
+    /* Count the input of each band, then hand it out */
+    size_t n_refs = 0;
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        void_mapper_count_t first, last;
+        if (band_range(area, band_height, &input[i], &first, &last)) {
+            for (void_mapper_count_t b = first; b <= last; b++) {
+                job->bands[b].input_length++;
+            }
+            n_refs += last - first + 1;
+        }
+    }
+
+    void_mapper_rectangle_t *refs = malloc((n_refs > 0 ? n_refs : 1) * sizeof(refs[0]));
+    if (refs == NULL) {
+        return NULL;
+    }
+
+    size_t offset = 0;
+    for (void_mapper_count_t b = 0; b < job->n_bands; b++) {
+        band_t *band = &job->bands[b];
+        band->area = area;
+        band->area.position.y = area.position.y + b * band_height;
+        band->area.size.y = b + 1 < job->n_bands ? band_height : area.size.y - b * band_height;
+        band->input = refs + offset;
+        offset += band->input_length;
+        job->max_input = band->input_length > job->max_input ? band->input_length : job->max_input;
+        band->input_length = 0;
+    }
+
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        void_mapper_count_t first, last;
+        if (band_range(area, band_height, &input[i], &first, &last)) {
+            for (void_mapper_count_t b = first; b <= last; b++) {
+                job->bands[b].input[job->bands[b].input_length++] = input[i];
+            }
+        }
+    }
+
+    return refs;
+}
+
+static void *batch_worker(void *arg)
+{
+    batch_t *batch = arg;
+    void_mapper_workspace_t workspace = { .size = batch->workspace_size };
+
+    /* Without memory the jobs fail, but still get their result */
+    workspace.memory = malloc(workspace.size);
+
+    while (true) {
+        size_t start = atomic_fetch_add(&batch->next, BATCH_CHUNK);
+        if (start >= batch->n_jobs) {
+            break;
+        }
+
+        size_t length = batch->n_jobs - start < BATCH_CHUNK ? batch->n_jobs - start : BATCH_CHUNK;
+        atomic_fetch_add(&batch->n_failed, void_mapper_batch(&batch->jobs[start], length, &workspace));
+    }
+
+    free(workspace.memory);
+
+    return NULL;
+}
+
+static unsigned int thread_count(unsigned int n_threads)
+{
+    if (n_threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = online > 0 ? (unsigned int) online : 1;
+    }
+
+    return n_threads;
+}
+
+static void run_threads(void *(*work)(void *), void *arg, unsigned int n_threads)
+{
+#ifdef VOID_MAPPER_STATS
+    void_mapper_stats_t *sink = stats_sink;
+    void_mapper_clock_t clock = stats_clock;
+    void_mapper_stats_hook(NULL, NULL);
+#endif
+
+    pthread_t threads[n_threads];
+    unsigned int n_started = 0;
+    for (unsigned int t = 1; t < n_threads; t++) {
+        if (pthread_create(&threads[n_started], NULL, work, arg) == 0) {
+            n_started++;
+        }
+    }
+
+    work(arg);
+
+    for (unsigned int t = 0; t < n_started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+#ifdef VOID_MAPPER_STATS
+    void_mapper_stats_hook(sink, clock);
+#endif
+}
+
+static void_mapper_count_t join_bands(const job_t *job, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length)
+{
+    void_mapper_count_t max_voids = 0;
+    for (void_mapper_count_t b = 0; b < job->n_bands; b++) {
+        if (job->bands[b].failed) {
+            return 0;
+        }
+        max_voids = job->bands[b].n_voids > max_voids ? job->bands[b].n_voids : max_voids;
+    }
+
+    seam_t *seams = malloc(2 * ((size_t) max_voids + 1) * sizeof(seams[0]));
+    if (seams == NULL) {
+        return 0;
+    }
+
+    void_mapper_count_t n_found = stitch(job->bands, job->n_bands, buffer, buffer_length, seams, seams + max_voids + 1);
+    free(seams);
+
+    return n_found;
+}
+
+void_mapper_count_t void_mapper_parallel(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                         void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                         unsigned int n_threads)
+{
+    if (buffer == NULL || buffer_length == 0) {
+        return 0;
+    }
+
+    if (input == NULL || input_length == 0 || area.size.x == 0 || area.size.y == 0) {
+        buffer[0] = area;
+        return 1;
+    }
+
+    n_threads = thread_count(n_threads);
+
+    /* Bands of equal height, at least one pixel high */
+    size_t n_bands = (size_t) n_threads * BANDS_PER_THREAD;
+    n_bands = n_bands > area.size.y ? area.size.y : n_bands;
+    void_mapper_coord_t band_height = (area.size.y + n_bands - 1) / n_bands;
+    n_bands = (area.size.y + band_height - 1) / band_height;
+
+    job_t job = { .n_bands = n_bands, .max_input = 0 };
+    atomic_init(&job.next, 0);
+    job.bands = calloc(n_bands, sizeof(job.bands[0]));
+    if (job.bands == NULL) {
+        return 0;
+    }
+
+    void_mapper_count_t result = 0;
+    void_mapper_rectangle_t *refs = bin_input(&job, area, band_height, input, input_length);
+    if (refs != NULL) {
+        run_threads(worker, &job, n_threads > n_bands ? n_bands : n_threads);
+        result = join_bands(&job, buffer, buffer_length);
+    }
+
+    for (void_mapper_count_t b = 0; b < n_bands; b++) {
+        free(job.bands[b].voids);
+    }
+    free(refs);
+    free(job.bands);
+
+    return result;
+}
+
+size_t void_mapper_batch_parallel(void_mapper_job_t *jobs, size_t n_jobs, unsigned int n_threads)
+{
+    batch_t batch = { .jobs = jobs, .n_jobs = n_jobs, .workspace_size = void_mapper_batch_workspace_size(jobs, n_jobs) };
+    atomic_init(&batch.next, 0);
+    atomic_init(&batch.n_failed, 0);
+
+    size_t n_chunks = (n_jobs + BATCH_CHUNK - 1) / BATCH_CHUNK;
+    n_threads = thread_count(n_threads);
+    n_threads = n_threads > n_chunks ? (n_chunks > 0 ? n_chunks : 1) : n_threads;
+    run_threads(batch_worker, &batch, n_threads);
+
+    return atomic_load(&batch.n_failed);
+}
@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "void_mapper_replay.h"
+
+/**
+ * @brief Get the number of bytes of a frame, header included.
+ *
+ * @param length Number of rectangles of the frame
+ * @return size_t number of bytes
+ */
+static size_t frame_size(uint32_t length);
+
+static size_t frame_size(uint32_t length)
+{
+    return sizeof(void_mapper_replay_frame_t) + (size_t) length * sizeof(void_mapper_rectangle_t);
+}
+
+bool void_mapper_replay_load(void_mapper_replay_t *replay, const void *data, size_t size, const char *magic)
+{
+    const void_mapper_replay_header_t *header = data;
+    if (replay == NULL || data == NULL || (uintptr_t) data % 8 != 0 || size < sizeof(*header) ||
+        memcmp(header->magic, magic, sizeof(header->magic)) != 0 ||
+        header->version != VOID_MAPPER_REPLAY_VERSION || header->coord_bits != VOID_MAPPER_COORD_BITS) {
+        return false;
+    }
+
+    *replay = (void_mapper_replay_t) { .data = data, .size = size, .n_frames = header->n_frames };
+
+    /* Walk the frames once, the replay then trusts every length */
+    size_t offset = sizeof(*header);
+    for (uint64_t f = 0; f < header->n_frames; f++) {
+        if (size - offset < sizeof(void_mapper_replay_frame_t)) {
+            return false;
+        }
+
+        const void_mapper_replay_frame_t *frame = (const void_mapper_replay_frame_t *) (replay->data + offset);
+        if ((size - offset - sizeof(*frame)) / sizeof(void_mapper_rectangle_t) < frame->length) {
+            return false;
+        }
+
+        replay->max_length = frame->length > replay->max_length ? frame->length : replay->max_length;
+        replay->n_rectangles += frame->length;
+        offset += frame_size(frame->length);
+    }
+
+    replay->end = replay->data + offset;
+    return true;
+}
+
+bool void_mapper_replay_open(void_mapper_replay_t *replay, const char *path, const char *magic)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    /* The mapping outlives the descriptor */
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    if (!void_mapper_replay_load(replay, data, st.st_size, magic)) {
+        munmap(data, st.st_size);
+        return false;
+    }
+
+    return true;
+}
+
+void void_mapper_replay_close(void_mapper_replay_t *replay)
+{
+    munmap((void *) replay->data, replay->size);
+    replay->data = NULL;
+    replay->size = 0;
+}
+
+const void_mapper_replay_frame_t *void_mapper_replay_first(const void_mapper_replay_t *replay)
+{
+    if (replay->n_frames == 0) {
+        return NULL;
+    }
+
+    return (const void_mapper_replay_frame_t *) (replay->data + sizeof(void_mapper_replay_header_t));
+}
+
+const void_mapper_replay_frame_t *void_mapper_replay_next(const void_mapper_replay_t *replay, const void_mapper_replay_frame_t *frame)
+{
+    const uint8_t *next = (const uint8_t *) frame + frame_size(frame->length);
+    if (next == replay->end) {
+        return NULL;
+    }
+
+    return (const void_mapper_replay_frame_t *) next;
+}
+
+void_mapper_count_t void_mapper_replay_map(const void_mapper_replay_frame_t *frame, void_mapper_rectangle_t *buffer,
+                                           void_mapper_count_t buffer_length, const void_mapper_workspace_t *workspace,
+                                           const void_mapper_workspace_t *group_workspace)
+{
+    /* The mapping is read only, and so is the input to the mappers */
+    void_mapper_count_t n_voids = void_mapper_with_workspace(frame->area, (void_mapper_rectangle_t *) void_mapper_replay_rectangles(frame),
+                                                             frame->length, buffer, buffer_length, workspace);
+    if (group_workspace != NULL && n_voids > 0) {
+        n_voids = void_mapper_group_with_workspace(buffer, n_voids, group_workspace);
+    }
+
+    return n_voids;
+}
+
+bool void_mapper_replay_create(void_mapper_replay_writer_t *writer, const char *path, const char *magic)
+{
+    writer->file = fopen(path, "wb");
+    writer->n_frames = 0;
+    if (writer->file == NULL) {
+        return false;
+    }
+
+    /* The number of frames is written last, by void_mapper_replay_finish() */
+    void_mapper_replay_header_t header = { .version = VOID_MAPPER_REPLAY_VERSION, .coord_bits = VOID_MAPPER_COORD_BITS };
+    memcpy(header.magic, magic, sizeof(header.magic));
+    if (fwrite(&header, sizeof(header), 1, writer->file) != 1) {
+        fclose(writer->file);
+        writer->file = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+bool void_mapper_replay_write(void_mapper_replay_writer_t *writer, void_mapper_rectangle_t area,
+                              const void_mapper_rectangle_t *rectangles, uint32_t length)
+{
+    void_mapper_replay_frame_t frame = { .area = area, .length = length };
+    if (fwrite(&frame, sizeof(frame), 1, writer->file) != 1 ||
+        (length > 0 && fwrite(rectangles, sizeof(rectangles[0]), length, writer->file) != length)) {
+        return false;
+    }
+
+    writer->n_frames++;
+    return true;
+}
+
+bool void_mapper_replay_finish(void_mapper_replay_writer_t *writer)
+{
+    bool written = fseek(writer->file, offsetof(void_mapper_replay_header_t, n_frames), SEEK_SET) == 0 &&
+                   fwrite(&writer->n_frames, sizeof(writer->n_frames), 1, writer->file) == 1;
+    written = fclose(writer->file) == 0 && written;
+    writer->file = NULL;
+
+    return written;
+}
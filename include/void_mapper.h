@@ -1,22 +1,179 @@
 #ifndef __VOID_MAPPER_H__
 #define __VOID_MAPPER_H__
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include "void_mapper_config.h"
 
-#define VOID_MAPPER_MIN_BUFFER_LENGTH(x) ((2 * (x) + 1)*(2 * (x) + 1) - x)
+/**
+ * @brief Upper bound of the number of voids for x input rectangles. Use void_mapper_count()
+ * to find the exact number needed for a particular input.
+ */
+#define VOID_MAPPER_MIN_BUFFER_LENGTH(x) ((size_t)(2 * (size_t)(x) + 1) * (2 * (size_t)(x) + 1) - (size_t)(x))
+
+/* Size of the internal representation of an input rectangle on the grid */
+#define VOID_MAPPER_SPAN_SIZE (4 * sizeof(void_mapper_count_t))
+
+/* Size of an element of the scratch vector, used for both coordinates and indices */
+#define VOID_MAPPER_SCRATCH_SIZE \
+    (sizeof(void_mapper_coord_t) > sizeof(void_mapper_count_t) ? sizeof(void_mapper_coord_t) : sizeof(void_mapper_count_t))
+
+/**
+ * @brief Number of bytes of workspace needed for x input rectangles. Usable for static
+ * allocation, e.g. "static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(32) / sizeof(void_mapper_word_t) + 1];"
+ */
+#define VOID_MAPPER_WORKSPACE_SIZE(x)                                                                    \
+    ((2 * (size_t)(x) + 2) * (sizeof(void_mapper_word_t) + 2 * sizeof(void_mapper_coord_t) + VOID_MAPPER_SCRATCH_SIZE) + \
+     (size_t)(x) * VOID_MAPPER_SPAN_SIZE)
+
+/*
+ * Deterministic build for tasks with a hard deadline. With VOID_MAPPER_DETERMINISTIC defined,
+ * the library and its users are compiled so that time and stack have static bounds: the
+ * calls take at most VOID_MAPPER_MAX_SPRITES input rectangles and return at most
+ * VOID_MAPPER_MAX_VOIDS voids, failing like on a workspace or buffer too small otherwise,
+ * void_mapper() keeps its workspace in an array of fixed size, and the loops of the grouping
+ * stop after VOID_MAPPER_MAX_GROUP_PASSES rounds. No function of the library recurses.
+ */
+#ifdef VOID_MAPPER_DETERMINISTIC
+#ifndef VOID_MAPPER_MAX_SPRITES
+#define VOID_MAPPER_MAX_SPRITES 32
+#endif
+#ifndef VOID_MAPPER_MAX_VOIDS
+#define VOID_MAPPER_MAX_VOIDS VOID_MAPPER_MIN_BUFFER_LENGTH(VOID_MAPPER_MAX_SPRITES)
+#endif
+#ifndef VOID_MAPPER_MAX_GROUP_PASSES
+#define VOID_MAPPER_MAX_GROUP_PASSES 4
+#endif
+#endif
+
+/**
+ * @brief Upper bound of the steps of the inner loops of void_mapper() over the cells for x
+ * input rectangles. The grid has at most 2x + 1 rows and columns, and each row tests the x
+ * spans against it and visits its cells, pushing at most one void each:
+ * (2x + 1) * x + (2x + 1)^2 steps.
+ */
+#define VOID_MAPPER_WCET_CELL_STEPS(x) ((2 * (uint64_t)(x) + 1) * (3 * (uint64_t)(x) + 1))
+
+/**
+ * @brief Upper bound of the steps of void_mapper() building the grid for x input rectangles.
+ * Each axis has 2x + 2 grid lines, which are gathered, radix sorted with two loops over them
+ * and two over the 256 buckets per byte of the coordinates, copied back and made unique.
+ * Each rectangle then looks its span up with four binary searches of at most
+ * VOID_MAPPER_COORD_BITS + 1 steps.
+ */
+#define VOID_MAPPER_WCET_GRID_STEPS(x)                                                                  \
+    (4 * ((uint64_t)(x) + 1) * (2 * (VOID_MAPPER_COORD_BITS / 8) + 3) + 1024 * (VOID_MAPPER_COORD_BITS / 8) + \
+     4 * (uint64_t)(x) * (VOID_MAPPER_COORD_BITS + 1))
+
+/**
+ * @brief Upper bound of all steps of void_mapper() for x input rectangles, the grid and the
+ * cells.
+ */
+#define VOID_MAPPER_WCET_STEPS(x) (VOID_MAPPER_WCET_GRID_STEPS(x) + VOID_MAPPER_WCET_CELL_STEPS(x))
+
+/**
+ * @brief Upper bound of the steps of void_mapper_group() in the deterministic build for x
+ * rectangles: every round tests each of the x(x - 1) / 2 pairs once, and the rectangles are
+ * filtered before and compacted after the rounds.
+ */
+#define VOID_MAPPER_WCET_GROUP_STEPS(x) (VOID_MAPPER_MAX_GROUP_PASSES * (uint64_t)(x) * (x) / 2 + 2 * (uint64_t)(x))
+
+/**
+ * @brief Stack used by void_mapper() besides its workspace, rounded up from the 1132 bytes
+ * with 16 bit types and 1752 with 32 bit types measured by the tests of the deterministic
+ * build with GCC on x86-64 without optimization. The tests check the measurement against it.
+ */
+#ifndef VOID_MAPPER_STACK_OVERHEAD
+#define VOID_MAPPER_STACK_OVERHEAD 2048
+#endif
+
+/**
+ * @brief Margin added to the measured overhead, for other compilers, flags and targets. Measure
+ * the overhead again for those, e.g. with -fstack-usage.
+ */
+#ifndef VOID_MAPPER_STACK_MARGIN
+#define VOID_MAPPER_STACK_MARGIN 1024
+#endif
+
+/**
+ * @brief Upper bound of the stack used by void_mapper() in the deterministic build, where
+ * the workspace for VOID_MAPPER_MAX_SPRITES rectangles is always on the stack.
+ */
+#define VOID_MAPPER_WCET_STACK(x) (VOID_MAPPER_WORKSPACE_SIZE(x) + VOID_MAPPER_STACK_OVERHEAD + VOID_MAPPER_STACK_MARGIN)
 
 typedef struct {
     struct {
-        uint16_t x;
-        uint16_t y;
+        void_mapper_coord_t x;
+        void_mapper_coord_t y;
     } position;
     struct
     {
-        uint16_t x;
-        uint16_t y;
+        void_mapper_coord_t x;
+        void_mapper_coord_t y;
     } size;
 } void_mapper_rectangle_t;
 
+/* Size of the internal representation of concave corners and chords used by the partition */
+#define VOID_MAPPER_CORNER_SIZE (2 * sizeof(void_mapper_count_t) + 4)
+#define VOID_MAPPER_CHORD_SIZE (6 * sizeof(void_mapper_count_t))
+
+/**
+ * @brief Number of bytes of workspace needed by void_mapper_partition() for x input rectangles.
+ */
+#define VOID_MAPPER_PARTITION_WORKSPACE_SIZE(x)                                             \
+    (VOID_MAPPER_WORKSPACE_SIZE(x) +                                                        \
+     (size_t)(x) * (4 * VOID_MAPPER_CORNER_SIZE + 4 * VOID_MAPPER_CHORD_SIZE) +             \
+     (size_t)(x) * 2 * (4 * sizeof(void_mapper_count_t) + 2) +                              \
+     (2 * (size_t)(x) + 1) * (2 * (size_t)(x) + 1))
+
+/* Size of the internal representation of an open strip of void used by the sweep */
+#define VOID_MAPPER_STRIP_SIZE (3 * sizeof(void_mapper_coord_t))
+
+/**
+ * @brief Number of bytes of workspace needed by void_mapper_sweep() for x input rectangles.
+ */
+#define VOID_MAPPER_SWEEP_WORKSPACE_SIZE(x) \
+    (((size_t)(x) + 1) * 2 * VOID_MAPPER_STRIP_SIZE + (size_t)(x) * 2 * sizeof(void_mapper_count_t))
+
+/**
+ * @brief Number of bytes of workspace needed by void_mapper_group_with_workspace() for x
+ * rectangles: a hash table of their edges and the rectangles left to visit.
+ */
+#define VOID_MAPPER_GROUP_WORKSPACE_SIZE(x) \
+    ((size_t)(x) * (8 * sizeof(uint32_t) + 2 * sizeof(void_mapper_count_t) + 1))
+
+/**
+ * @brief Number of bytes of workspace needed by void_mapper_mask() for a mask w pixels wide.
+ */
+#define VOID_MAPPER_MASK_WORKSPACE_SIZE(w) (2 * ((size_t)(w) / 2 + 1) * sizeof(void_mapper_count_t))
+
+/**
+ * @brief Scratch memory used by void mapper, supplied by the caller. This allows the memory
+ * to be placed in a static arena or in a particular memory region. The memory must be
+ * aligned for void_mapper_word_t and hold at least void_mapper_workspace_size() bytes.
+ */
+typedef struct {
+    void *memory;
+    size_t size;
+} void_mapper_workspace_t;
+
+/**
+ * @brief User supplied clock for the statistics and the deadlines, for example a cycle
+ * counter or a timer. Only differences between two readings are used, so the clock may
+ * wrap around.
+ */
+typedef uint32_t (*void_mapper_clock_t)(void);
+
+/**
+ * @brief Callback receiving one void at a time from void_mapper_stream().
+ *
+ * @param context Context given to void_mapper_stream()
+ * @param rectangle The void, only valid during the call
+ * @return true to continue, false to stop the mapping
+ */
+typedef bool (*void_mapper_emit_t)(void *context, const void_mapper_rectangle_t *rectangle);
+
 /**
  * @brief Void mapper returns a list of rectangles to fill all the void between the boxes.
  * It will search and find all the empty spaces within the area, returning a list of
@@ -33,20 +190,882 @@ typedef struct {
  * @param buffer_length Number of the elements in the buffer
  * @return Number of voids found. (The voids are in the buffer)
  */
-uint16_t void_mapper(void_mapper_rectangle_t area, void_mapper_rectangle_t *input, uint16_t input_length, void_mapper_rectangle_t * buffer, uint16_t buffer_length);
+void_mapper_count_t void_mapper(void_mapper_rectangle_t area, void_mapper_rectangle_t *input, void_mapper_count_t input_length, void_mapper_rectangle_t * buffer, void_mapper_count_t buffer_length);
+
+/**
+ * @brief Get the number of bytes of workspace needed to map input_length rectangles.
+ *
+ * @param input_length Number of elements of the input array
+ * @return size_t number of bytes
+ */
+size_t void_mapper_workspace_size(void_mapper_count_t input_length);
+
+/**
+ * @brief Same as void_mapper() but uses the workspace supplied by the caller, instead of
+ * placing the scratch memory on the stack.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of voids found. 0 if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_with_workspace(void_mapper_rectangle_t area, void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                               void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                               const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief One mapping of a batch: an area, its input and the buffer for its voids.
+ */
+typedef struct {
+    void_mapper_rectangle_t area;               /* Area to search */
+    const void_mapper_rectangle_t *input;       /* Array of the non void areas */
+    void_mapper_count_t input_length;           /* Number of elements of the input array */
+    void_mapper_rectangle_t *buffer;            /* For storage of the result */
+    void_mapper_count_t buffer_length;          /* Number of the elements in the buffer */
+    void_mapper_count_t result;                 /* Set to the number of voids found, 0 on failure */
+} void_mapper_job_t;
+
+/**
+ * @brief Get the number of bytes of workspace needed by void_mapper_batch(), the one of the
+ * job with the longest input.
+ *
+ * @param jobs Array of jobs
+ * @param n_jobs Number of jobs
+ * @return size_t number of bytes
+ */
+size_t void_mapper_batch_workspace_size(const void_mapper_job_t *jobs, size_t n_jobs);
+
+/**
+ * @brief Run void_mapper_with_workspace() on every job of an array, for many small mappings
+ * such as the layers of several panels. The workspace is set up once and shared by the jobs,
+ * one after the other, and the result of each job is stored in the job.
+ *
+ * @param jobs Array of jobs
+ * @param n_jobs Number of jobs
+ * @param workspace Scratch memory of at least void_mapper_batch_workspace_size(jobs, n_jobs) bytes
+ * @return size_t number of jobs that failed, because of a buffer or the workspace too small
+ */
+size_t void_mapper_batch(void_mapper_job_t *jobs, size_t n_jobs, const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Same as void_mapper_with_workspace(), but the input is given as separate arrays of
+ * coordinates and sizes, the way many sprite engines keep them. The input rectangle i is
+ * x[i], y[i], width[i], height[i]. The right and bottom edges are computed once, and the
+ * test of the input against each row of the grid uses vector instructions when the target
+ * has them (SSE2 or AVX2), unless VOID_MAPPER_NO_SIMD is defined.
+ *
+ * @param area Area to search
+ * @param x Left edges of the non void areas
+ * @param y Top edges of the non void areas
+ * @param width Widths of the non void areas
+ * @param height Heights of the non void areas
+ * @param input_length Number of elements of each input array
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of voids found. 0 if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_soa(void_mapper_rectangle_t area,
+                                    const void_mapper_coord_t *x, const void_mapper_coord_t *y, const void_mapper_coord_t *width, const void_mapper_coord_t *height,
+                                    void_mapper_count_t input_length, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                    const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Same as void_mapper() followed by a grouping, but the grouping is done directly on
+ * the rows of the grid: each row gives its longest horizontal runs of void, and a run is
+ * merged with the one right above it when they span the same columns. This takes a single
+ * pass over the grid.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of voids found. 0 if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_grouped(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                        void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Cost of clearing rectangles on a display: a fixed cost for each command sent to
+ * the controller and a cost for each pixel it fills, in any unit.
+ */
+typedef struct {
+    uint32_t per_command;
+    uint32_t per_pixel;
+} void_mapper_cost_t;
+
+/**
+ * @brief Get the cost of clearing rectangles, each one command plus its pixels. Pixels
+ * covered by several rectangles are paid for each time.
+ *
+ * @param cost Cost model
+ * @param rectangles Rectangles to clear
+ * @param length Number of rectangles
+ * @return uint64_t the cost
+ */
+uint64_t void_mapper_cost(const void_mapper_cost_t *cost, const void_mapper_rectangle_t *rectangles, void_mapper_count_t length);
+
+/**
+ * @brief Same as void_mapper_grouped(), but the voids may also cover input pixels, for
+ * pipelines that clear first and draw the input afterwards. Starting from the grouped
+ * voids, two voids of the same band (same top and height) or of the same column (same
+ * left and width) are replaced by the one rectangle spanning both, when the pixels in the
+ * gap between them cost less than the command saved. Then any two rectangles close enough
+ * are replaced the same way, when the pixels the spanning rectangle adds cost less than
+ * the command saved. This is repeated until nothing more can be merged.
+ *
+ * Each merge lowers the cost, so the result never costs more than the one of
+ * void_mapper_grouped(). It covers all void, but it is not always the cheapest cover. When
+ * commands are dear, most voids are merged and a pass takes up to O(n^2) time in the
+ * number of voids.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param cost Cost model of the display
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of rectangles to clear. 0 if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_overdraw(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                         const void_mapper_cost_t *cost, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                         const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Granularity of a display controller, e.g. 8 rows for the pages of an SSD1306, and
+ * the number of rectangles of each kind found by void_mapper_aligned(). A rectangle is
+ * aligned when all its edges are multiples of the granularity.
+ */
+typedef struct {
+    void_mapper_coord_t x;                  /* Granularity of the columns, 1 for any */
+    void_mapper_coord_t y;                  /* Granularity of the rows, 1 for any */
+    void_mapper_count_t n_aligned;          /* Set to the number of aligned rectangles */
+    void_mapper_count_t n_unaligned;        /* Set to the number of the other rectangles */
+} void_mapper_alignment_t;
+
+/**
+ * @brief Same as void_mapper_grouped(), but each void is split so that as much of it as
+ * possible is aligned. A void is cut into its largest aligned rectangle and at most four
+ * unaligned remainders: the rows above and below it across the whole void, and the columns
+ * left and right of it. A void too small to hold an aligned rectangle is kept whole.
+ *
+ * The result covers exactly the same void as void_mapper() does. The pieces of each void
+ * follow each other, the aligned rectangle between the remainders.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param alignment Granularity of the controller, updated with the number of rectangles of each kind
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of rectangles. 0 if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_aligned(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                        void_mapper_alignment_t *alignment, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Budget of a call to void_mapper_anytime(). Refining stops at whichever limit comes
+ * first.
+ */
+typedef struct {
+    void_mapper_clock_t clock;          /* Clock of the deadline, NULL for no deadline */
+    uint32_t deadline;                  /* Reading of the clock to stop refining at */
+    uint32_t max_operations;            /* Operations allowed, 0 for no limit. Every call builds the
+                                           grid first, which costs VOID_MAPPER_WCET_GRID_STEPS() of
+                                           the input length, then a row of the grid costs its number
+                                           of columns plus the input length */
+} void_mapper_budget_t;
+
+/**
+ * @brief Progress of void_mapper_anytime() across calls. Clear it to start a new mapping.
+ */
+typedef struct {
+    void_mapper_coord_t refined;        /* Set to the row down to which the voids are exact */
+    void_mapper_count_t n_exact;        /* Set to the number of exact voids at the start of the buffer */
+    bool exact;                         /* Set when the whole area is refined */
+} void_mapper_progress_t;
+
+/**
+ * @brief Map the void within a budget of time or operations. The rows down to
+ * progress->refined are mapped exactly, into the same voids as void_mapper_grouped() gives,
+ * and the rows left are covered by the band across the area minus the columns of the input
+ * rectangles crossing it. No rectangle of the result covers input, so the whole result can be
+ * cleared at any time, while the void left under those columns waits for the refinement. The
+ * rows are refined from the top for as long as the budget allows.
+ *
+ * The budget is checked before the grid is built, so a budget spent on entry costs only the
+ * cover of the rows left, O(n log n) in the input length.
+ *
+ * To refine further, e.g. in the next idle slice, call again with the same input, progress
+ * and buffer: the exact voids are kept and the refinement carries on from the next row. Once
+ * progress->exact is set the result is the one of void_mapper_grouped().
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param budget Budget of this call, NULL for none
+ * @param progress Progress, updated by the call
+ * @param buffer For storage of the result, kept between the calls
+ * @param buffer_length Number of the elements in the buffer. Refining stops when it is full,
+ *        keeping room for the cover of the rows left, at most input_length + 1 rectangles.
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of rectangles, the exact voids then the cover of the rows left. 0 if the
+ *         workspace is too small, or if nothing is refined yet and the input crosses the area
+ *         through its width.
+ */
+void_mapper_count_t void_mapper_anytime(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                        const void_mapper_budget_t *budget, void_mapper_progress_t *progress,
+                                        void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Count the voids without storing them. This is the exact buffer length needed
+ * by void_mapper() for the same input. The count saturates at VOID_MAPPER_COUNT_MAX: the
+ * voids of such an input may not fit in any buffer.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of voids, at most VOID_MAPPER_COUNT_MAX. 0 if the workspace is too small.
+ */
+void_mapper_count_t void_mapper_count(void_mapper_rectangle_t area, void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                      const void_mapper_workspace_t *workspace);
 
 /**
  * @brief Group rectangles using the "greedy grouping" by alignment strategy.
- * Basically merge rectangles horizontally if the share the same side, and then
- * group rectangles vertically if they share the same side.
+ * Each rectangle is merged with every later rectangle it shares a whole side with, in the
+ * order of the input, and this is repeated until no more rectangles can be merged.
+ *
+ * Every pass tests all pairs of rectangles in place, without any workspace and with a
+ * constant amount of stack. The result keeps the order of the input. Rectangles without area
+ * are removed. void_mapper_group_with_workspace() finds the same result in about linear time.
  *
  * This method does not guarantee the best solution but it can optimize the result from
  * void mapper making the amount of voids a bit smaller.
  *
  * @param input
  * @param input_length
- * @return uint16_t
+ * @return void_mapper_count_t
+ */
+void_mapper_count_t void_mapper_group(void_mapper_rectangle_t input[], void_mapper_count_t input_length);
+
+/**
+ * @brief Get the number of bytes of workspace needed by void_mapper_group_with_workspace().
+ *
+ * @param input_length Number of rectangles to group
+ * @return size_t number of bytes, at most VOID_MAPPER_GROUP_WORKSPACE_SIZE(input_length)
+ */
+size_t void_mapper_group_workspace_size(void_mapper_count_t input_length);
+
+/**
+ * @brief Same as void_mapper_group(), but with a workspace supplied by the caller. The
+ * rectangles sharing a side are found through a hash table of their edges, so a pass only
+ * visits the rectangles that grew or have a neighbour that grew, and the grouping takes
+ * about linear time instead of a time quadratic in the number of rectangles.
+ *
+ * @param input Rectangles, grouped in place
+ * @param input_length Number of rectangles
+ * @param workspace Scratch memory of at least void_mapper_group_workspace_size(input_length) bytes
+ * @return void_mapper_count_t number of rectangles left, 0 if the workspace is too small
+ */
+void_mapper_count_t void_mapper_group_with_workspace(void_mapper_rectangle_t input[], void_mapper_count_t input_length,
+                                                     const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Normalize the input before mapping it, in place. The rectangles are clipped to the
+ * area, and the empty ones and those outside of the area are left out. Rectangles in line
+ * that overlap or touch are fused into one, e.g. a row of tiles, and rectangles lying within
+ * another one are left out, until nothing changes. Each rectangle left adds fewer lines to
+ * the grid of the mappers.
+ *
+ * The result covers the same pixels of the area as the input did, so every mapper finds the
+ * same void from it, in fewer steps. It is ordered by row and then by column.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas, rewritten
+ * @param input_length Number of elements of the input array
+ * @return void_mapper_count_t new number of rectangles
+ */
+void_mapper_count_t void_mapper_normalize(void_mapper_rectangle_t area, void_mapper_rectangle_t input[], void_mapper_count_t input_length);
+
+/**
+ * @brief Same as void_mapper() but passes each void to a callback as soon as it is found,
+ * instead of storing it in a buffer. The voids come row by row from the top, and from the
+ * left within each row, i.e. in the same order as void_mapper() returns them. Only one row
+ * of the grid is held in memory, so the voids can be sent to the display while the rest are
+ * being found. The workspace still holds the grid lines, their scratch and the spans of the
+ * input, so it is linear in input_length: void_mapper_workspace_size(input_length) bytes,
+ * the same as for void_mapper(). Only the output buffer is saved.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param emit Callback receiving the voids
+ * @param context Passed to the callback
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of voids passed to the callback. 0 if the workspace is too small.
+ */
+uint32_t void_mapper_stream(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                            void_mapper_emit_t emit, void *context, const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Value written by a field of a command template.
+ */
+typedef enum {
+    VOID_MAPPER_FIELD_BYTE,         /* The byte given in the field, e.g. an opcode or a color */
+    VOID_MAPPER_FIELD_LEFT,         /* First column of the void */
+    VOID_MAPPER_FIELD_TOP,          /* First row of the void */
+    VOID_MAPPER_FIELD_RIGHT,        /* Last column of the void, inclusive as in CASET */
+    VOID_MAPPER_FIELD_BOTTOM,       /* Last row of the void, inclusive as in RASET */
+    VOID_MAPPER_FIELD_WIDTH,        /* Width of the void */
+    VOID_MAPPER_FIELD_HEIGHT,       /* Height of the void */
+    VOID_MAPPER_FIELD_PIXELS,       /* Number of pixels of the void */
+} void_mapper_field_kind_t;
+
+/**
+ * @brief One field of a command template. Values are written in size bytes, in the byte
+ * order of the encoder, and cut to the size if they do not fit.
+ */
+typedef struct {
+    uint8_t kind;                   /* One of void_mapper_field_kind_t */
+    uint8_t size;                   /* Number of bytes of the value, 1 to 4, ignored for bytes */
+    uint8_t value;                  /* The byte written by VOID_MAPPER_FIELD_BYTE */
+} void_mapper_field_t;
+
+/**
+ * @brief Template of the command bytes sent for each void, e.g. for an ILI9341: 0x2A, left
+ * and right on 2 bytes, 0x2B, top and bottom on 2 bytes, then the fill command.
+ */
+typedef struct {
+    const void_mapper_field_t *fields;
+    uint8_t n_fields;
+    bool big_endian;                /* Byte order of the values */
+} void_mapper_encoder_t;
+
+/**
+ * @brief Buffer receiving the encoded commands, e.g. a DMA buffer, and the progress of the
+ * encoding across calls.
+ */
+typedef struct {
+    uint8_t *buffer;                /* Receives the commands */
+    size_t size;                    /* Number of bytes of the buffer */
+    size_t length;                  /* Set to the number of bytes written by the last call */
+    uint32_t n_done;                /* Voids encoded by the calls so far, 0 to start a new encoding */
+    bool done;                      /* Set when every void is encoded */
+} void_mapper_dma_t;
+
+/**
+ * @brief Get the number of bytes of the command of one void.
+ *
+ * @param encoder Command template
+ * @return size_t number of bytes
+ */
+size_t void_mapper_encoded_size(const void_mapper_encoder_t *encoder);
+
+/**
+ * @brief Map the void and write the command of each void straight into a buffer, with no
+ * buffer of voids in between. The voids come in the order of void_mapper_stream(), and
+ * only whole commands are written.
+ *
+ * When the buffer is full, the call returns with done still false. Once the buffer is sent,
+ * call again with the same input and dma: the buffer is filled from its start with the
+ * commands that follow. The voids already encoded are mapped again but not written.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param encoder Command template
+ * @param dma Buffer and progress, n_done set to 0 before the first call
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of voids encoded by this call. 0 with done false if the buffer cannot hold
+ *         a command, or if the workspace is too small.
+ */
+uint32_t void_mapper_encode(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                            const void_mapper_encoder_t *encoder, void_mapper_dma_t *dma, const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Map the residue left behind when rectangles move, instead of all void in the area.
+ * The result covers the footprints of the previous frame and the dirty rectangles, minus the
+ * footprints of the current frame, within the area. Each returned rectangle is the longest
+ * horizontal run of void cells within a row of the grid.
+ *
+ * @param area Area to search
+ * @param previous Rectangles of the previous frame, may be NULL
+ * @param previous_length Number of elements of previous
+ * @param current Rectangles of the current frame, may be NULL
+ * @param current_length Number of elements of current
+ * @param dirty Other rectangles that need to be cleared, may be NULL
+ * @param dirty_length Number of elements of dirty
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(previous_length +
+ *                  current_length + dirty_length) bytes
+ * @return Number of rectangles to clear. 0 if there is nothing to clear, or if the buffer or
+ *         the workspace is too small.
+ */
+void_mapper_count_t void_mapper_residue(void_mapper_rectangle_t area,
+                                        const void_mapper_rectangle_t *previous, void_mapper_count_t previous_length,
+                                        const void_mapper_rectangle_t *current, void_mapper_count_t current_length,
+                                        const void_mapper_rectangle_t *dirty, void_mapper_count_t dirty_length,
+                                        void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Get the number of bytes of workspace needed by void_mapper_partition().
+ *
+ * @param input_length Number of elements of the input array
+ * @return size_t number of bytes
+ */
+size_t void_mapper_partition_workspace_size(void_mapper_count_t input_length);
+
+/**
+ * @brief Partition the void into the least number of non overlapping rectangles. The result
+ * covers exactly the same void as void_mapper() does, but each rectangle is as large as
+ * needed to keep the count minimal. This is usually far fewer rectangles than what
+ * void_mapper_group() gives, at the cost of a larger workspace and more time.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_partition_workspace_size(input_length) bytes
+ * @return Number of rectangles. 0 if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_partition(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                          void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                          const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Get the number of bytes of workspace needed by void_mapper_sweep().
+ *
+ * @param input_length Number of elements of the input array
+ * @return size_t number of bytes
  */
-uint16_t void_mapper_group(void_mapper_rectangle_t input[], uint16_t input_length);
+size_t void_mapper_sweep_workspace_size(void_mapper_count_t input_length);
+
+/**
+ * @brief Map the void with a sweep line instead of a grid. The line moves down the area,
+ * stopping at the top and bottom edges of the input, and keeps the input rectangles it
+ * crosses ordered from left to right. The void between them is output as strips as wide as
+ * possible, each one as tall as the void keeps the same width.
+ *
+ * The result covers exactly the same void as void_mapper() does, and is the same set of
+ * rectangles as void_mapper_grouped() gives, in another order. No grid is built, so the
+ * workspace is linear in the input and much smaller than the one of void_mapper(). The
+ * number of voids is linear in the number of bands rather than in the number of cells.
+ *
+ * The time is O(n log n + n * k) for n input rectangles, where k is the largest number of
+ * them crossed by one band: each of the 2n bands walks the k active rectangles, and each
+ * rectangle is inserted in the active list by shifting the ones right of it. Inputs with
+ * many rectangles side by side on one line, such as a row of glyphs, approach O(n^2).
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_sweep_workspace_size(input_length) bytes
+ * @return Number of voids found. 0 if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_sweep(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                      void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                      const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Number of bytes of memory needed by an index of b buckets holding r references to
+ * the input rectangles.
+ */
+#define VOID_MAPPER_INDEX_SIZE(b, r) (((size_t)(b) + 1) * sizeof(uint32_t) + (size_t)(r) * sizeof(void_mapper_count_t))
+
+/**
+ * @brief Uniform grid of buckets over the area, each listing the input rectangles that cross
+ * it, for inputs of thousands of rectangles. It is built by void_mapper_index_build() and
+ * can be kept for as long as the input does not change.
+ *
+ * All memory is supplied by the caller. The members are internal and should not be modified.
+ */
+typedef struct {
+    void_mapper_rectangle_t area;
+    void_mapper_coord_t bucket_size;
+    void_mapper_count_t columns;
+    void_mapper_count_t rows;
+    uint32_t *starts;
+    void_mapper_count_t *refs;
+    void_mapper_count_t max_bucket;
+} void_mapper_index_t;
+
+/**
+ * @brief Get the number of bytes of memory needed by an index.
+ *
+ * @param area Area to search
+ * @param bucket_size Width and height of the buckets
+ * @param max_refs Number of references to the input rectangles the index can hold, each
+ *                 rectangle taking one per bucket it crosses
+ * @return size_t number of bytes
+ */
+size_t void_mapper_index_size(void_mapper_rectangle_t area, void_mapper_coord_t bucket_size, uint32_t max_refs);
+
+/**
+ * @brief Build an index of the input rectangles. The area is cut into square buckets, and
+ * each bucket lists the rectangles that cross it. A bucket about the size of the typical
+ * rectangle keeps the lists short.
+ *
+ * @param index Index to build
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param bucket_size Width and height of the buckets
+ * @param memory Memory of at least void_mapper_index_size() bytes, aligned for uint32_t
+ * @param size Number of bytes of memory, the references are stored in the rest
+ * @return true on success
+ * @return false if the memory is too small
+ */
+bool void_mapper_index_build(void_mapper_index_t *index, void_mapper_rectangle_t area,
+                             const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                             void_mapper_coord_t bucket_size, void *memory, size_t size);
+
+/**
+ * @brief Find the input rectangles crossing a region, looking only at the buckets the region
+ * crosses. Each rectangle is found once.
+ *
+ * @param index Built index
+ * @param input The input the index was built from
+ * @param region Region to look in
+ * @param found For storage of the indices of the rectangles found, may be NULL to count them
+ * @param found_length Number of the elements of found
+ * @return uint32_t number of rectangles crossing the region, even if more than found holds
+ */
+uint32_t void_mapper_index_find(const void_mapper_index_t *index, const void_mapper_rectangle_t *input, void_mapper_rectangle_t region,
+                                void_mapper_count_t *found, void_mapper_count_t found_length);
+
+/**
+ * @brief Get the number of bytes of workspace needed by void_mapper_indexed(): the larger of
+ * the workspace of the largest bucket and the one of void_mapper_group_with_workspace() for
+ * the whole buffer.
+ *
+ * @param index Built index
+ * @param buffer_length Number of the elements in the buffer
+ * @return size_t number of bytes
+ */
+size_t void_mapper_indexed_workspace_size(const void_mapper_index_t *index, void_mapper_count_t buffer_length);
+
+/**
+ * @brief Map the void of a large input with an index. Each bucket is mapped on a grid of its
+ * own, built from the rectangles of its list only, so that the time grows with the number
+ * of rectangles and buckets rather than with its square. The voids of the buckets are then
+ * grouped with void_mapper_group_with_workspace() in the same workspace, which merges most of
+ * the voids cut by the edges of the buckets back together.
+ *
+ * The result covers exactly the same void as void_mapper() does.
+ *
+ * @param index Built index
+ * @param input The input the index was built from
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_indexed_workspace_size(index, buffer_length) bytes
+ * @return Number of voids found. 0 if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_indexed(const void_mapper_index_t *index, const void_mapper_rectangle_t *input,
+                                        void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Get the number of bytes of workspace needed by void_mapper_mask().
+ *
+ * @param width Width of the mask in pixels
+ * @return size_t number of bytes
+ */
+size_t void_mapper_mask_workspace_size(void_mapper_coord_t width);
+
+/**
+ * @brief Map the void of an occupancy mask instead of a list of rectangles. The mask has
+ * one bit per pixel, set where the pixel is covered. Each row starts on a byte and holds
+ * the pixels from the left in the lowest bit first, i.e. pixel x of row y is bit x % 8 of
+ * byte y * stride + x / 8.
+ *
+ * The rows are scanned 64 pixels at a time, jumping from one run of void to the next with
+ * a count of trailing zeros. A run extends the rectangle right above it when both span the
+ * same columns, as in void_mapper_grouped(). The time is linear in the size of the mask
+ * and in the number of runs. The voids are relative to the top left corner of the mask.
+ *
+ * @param pixels The mask, NULL if every pixel is void
+ * @param stride Number of bytes from the start of a row to the start of the next one
+ * @param width Width of the mask in pixels
+ * @param height Height of the mask in pixels
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_mask_workspace_size(width) bytes
+ * @return Number of voids found. 0 if there is no void, or if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_mask(const uint8_t *pixels, size_t stride, void_mapper_coord_t width, void_mapper_coord_t height,
+                                     void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                     const void_mapper_workspace_t *workspace);
+
+/**
+ * @brief Number of bytes of memory needed by a context holding up to x rectangles.
+ */
+#define VOID_MAPPER_CTX_SIZE(x) \
+    ((size_t)(x) * (sizeof(void_mapper_rectangle_t) + 1) + \
+     (2 * (size_t)(x) + 2) * 2 * (sizeof(void_mapper_coord_t) + sizeof(void_mapper_count_t)) + \
+     (2 * (size_t)(x) + 3) * (2 * (size_t)(x) + 1) * sizeof(void_mapper_count_t))
+
+/* Size of the internal representation of a cache entry */
+#define VOID_MAPPER_CACHE_ENTRY_SIZE \
+    ((sizeof(uint32_t) + 4 * sizeof(void_mapper_coord_t) + 2 * sizeof(void_mapper_count_t) + 1 + 3) / 4 * 4)
+
+/**
+ * @brief Number of bytes of memory needed by a cache of n entries, each holding up to x input
+ * rectangles and v voids.
+ */
+#define VOID_MAPPER_CACHE_SIZE(n, x, v) \
+    ((size_t)(n) * (VOID_MAPPER_CACHE_ENTRY_SIZE + ((size_t)(x) + (size_t)(v)) * sizeof(void_mapper_rectangle_t)))
+
+#define VOID_MAPPER_INVALID_HANDLE VOID_MAPPER_COUNT_MAX
+
+typedef void_mapper_count_t void_mapper_handle_t;
+
+/**
+ * @brief Number of changed regions a context keeps apart. Regions that overlap are merged, and
+ * when all are taken a new region is merged with the one that grows least by it.
+ */
+#ifndef VOID_MAPPER_CTX_DIRTY
+#define VOID_MAPPER_CTX_DIRTY 4
+#endif
+
+/**
+ * @brief Context of the incremental void mapper. The context keeps the grid and the
+ * occupancy of every cell between frames, so that adding, moving or removing a rectangle
+ * only updates the part of the grid that it touches.
+ *
+ * The columns and rows of the grid are kept in slots of the occupancy, in any order, and
+ * x_slots and y_slots give the slot of each column and row. A new grid line takes a free
+ * slot and a removed one frees its slot, so an edge that moves costs O(n) for n rectangles,
+ * its column or row of occupancy and the slots of its axis, plus the cells of the rectangle.
+ *
+ * The region changed since the last void_mapper_ctx_dirty_voids() is kept as up to
+ * VOID_MAPPER_CTX_DIRTY disjoint rectangles, so changes far apart do not dirty the cells
+ * between them. Beyond that many separate changes, the regions are merged into their
+ * bounding boxes, which may cover cells that did not change.
+ *
+ * All memory is supplied by the caller through void_mapper_ctx_init(). The members are
+ * internal and should not be modified.
+ */
+typedef struct {
+    void_mapper_rectangle_t area;
+    void_mapper_count_t capacity;
+    void_mapper_rectangle_t *rectangles;
+    uint8_t *used;
+    void_mapper_coord_t *x_vector;
+    void_mapper_count_t *x_refs;
+    void_mapper_count_t x_len;
+    void_mapper_coord_t *y_vector;
+    void_mapper_count_t *y_refs;
+    void_mapper_count_t y_len;
+    void_mapper_count_t *grid;
+    void_mapper_count_t *x_slots;
+    void_mapper_count_t *y_slots;
+    void_mapper_count_t stride;
+    void_mapper_rectangle_t dirty[VOID_MAPPER_CTX_DIRTY];
+    void_mapper_count_t n_dirty;
+} void_mapper_ctx_t;
+
+/**
+ * @brief Get the number of bytes of memory needed by a context.
+ *
+ * @param capacity Maximum number of rectangles in the context
+ * @return size_t number of bytes
+ */
+size_t void_mapper_ctx_size(void_mapper_count_t capacity);
+
+/**
+ * @brief Initialize a context without any rectangles.
+ *
+ * @param ctx Context to initialize
+ * @param area Area to search
+ * @param capacity Maximum number of rectangles in the context
+ * @param memory Memory of at least void_mapper_ctx_size(capacity) bytes, aligned for void_mapper_word_t
+ * @param size Number of bytes of memory
+ * @return true on success
+ * @return false if the memory is too small
+ */
+bool void_mapper_ctx_init(void_mapper_ctx_t *ctx, void_mapper_rectangle_t area, void_mapper_count_t capacity,
+                          void *memory, size_t size);
+
+/**
+ * @brief Add a non void rectangle to the context.
+ *
+ * @param ctx Context
+ * @param rectangle Rectangle to add
+ * @return void_mapper_handle_t handle of the rectangle, VOID_MAPPER_INVALID_HANDLE if the context is full
+ */
+void_mapper_handle_t void_mapper_ctx_add(void_mapper_ctx_t *ctx, void_mapper_rectangle_t rectangle);
+
+/**
+ * @brief Move or resize a rectangle of the context.
+ *
+ * @param ctx Context
+ * @param handle Handle of the rectangle
+ * @param rectangle New position and size of the rectangle
+ * @return true on success
+ * @return false if the handle is not valid
+ */
+bool void_mapper_ctx_move(void_mapper_ctx_t *ctx, void_mapper_handle_t handle, void_mapper_rectangle_t rectangle);
+
+/**
+ * @brief Remove a rectangle from the context.
+ *
+ * @param ctx Context
+ * @param handle Handle of the rectangle
+ * @return true on success
+ * @return false if the handle is not valid
+ */
+bool void_mapper_ctx_remove(void_mapper_ctx_t *ctx, void_mapper_handle_t handle);
+
+/**
+ * @brief Get all voids of the context. The result is the same as void_mapper() returns for
+ * the rectangles of the context, but no sorting or culling is done.
+ *
+ * @param ctx Context
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @return Number of voids found. 0 if the buffer is too small.
+ */
+void_mapper_count_t void_mapper_ctx_voids(const void_mapper_ctx_t *ctx, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length);
+
+/**
+ * @brief Get the voids within the region changed since the last call. Only the cells of the
+ * changed region are visited and the voids are clipped to it, each of its disjoint rectangles
+ * in turn. The changed region is reset when the voids fit in the buffer.
+ *
+ * @param ctx Context
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @return Number of voids found. 0 if nothing changed or if the buffer is too small.
+ */
+void_mapper_count_t void_mapper_ctx_dirty_voids(void_mapper_ctx_t *ctx, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length);
+
+/**
+ * @brief Cache of the voids of recent inputs, for frames that repeat a few layouts such as
+ * menus and idle screens. Each entry keeps a copy of an input and its voids, and is found
+ * by a hash of the area and the input. When the cache is full, an entry is replaced with
+ * the clock algorithm: entries that were hit since the hand last passed them are skipped.
+ *
+ * All memory is supplied by the caller through void_mapper_cache_init(). The counters may be
+ * read and cleared, the other members are internal and should not be modified.
+ */
+typedef struct {
+    void *entries;
+    void_mapper_rectangle_t *inputs;
+    void_mapper_rectangle_t *voids;
+    void_mapper_count_t n_entries;
+    void_mapper_count_t max_input;
+    void_mapper_count_t max_voids;
+    void_mapper_count_t hand;
+    uint32_t hits;                              /* Calls answered from the cache */
+    uint32_t misses;                            /* Calls that mapped the input */
+    uint32_t evictions;                         /* Entries replaced by another input */
+} void_mapper_cache_t;
+
+/**
+ * @brief Get the number of bytes of memory needed by a cache.
+ *
+ * @param n_entries Number of entries
+ * @param max_input Largest input kept by an entry
+ * @param max_voids Most voids kept by an entry
+ * @return size_t number of bytes
+ */
+size_t void_mapper_cache_size(void_mapper_count_t n_entries, void_mapper_count_t max_input, void_mapper_count_t max_voids);
+
+/**
+ * @brief Initialize an empty cache.
+ *
+ * @param cache Cache to initialize
+ * @param n_entries Number of entries
+ * @param max_input Largest input kept by an entry, larger inputs are mapped every time
+ * @param max_voids Most voids kept by an entry, inputs with more voids are mapped every time
+ * @param memory Memory of at least void_mapper_cache_size() bytes, aligned for void_mapper_word_t
+ * @param size Number of bytes of memory
+ * @return true on success
+ * @return false if the memory is too small
+ */
+bool void_mapper_cache_init(void_mapper_cache_t *cache, void_mapper_count_t n_entries, void_mapper_count_t max_input,
+                            void_mapper_count_t max_voids, void *memory, size_t size);
+
+/**
+ * @brief Drop every entry of the cache. The counters are kept.
+ *
+ * @param cache Cache
+ */
+void void_mapper_cache_clear(void_mapper_cache_t *cache);
+
+/**
+ * @brief Same as void_mapper_with_workspace(), but the voids of an input already in the cache
+ * are copied from it instead of being mapped. Inputs that leave no void are not cached.
+ *
+ * @param cache Cache
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(input_length) bytes
+ * @return Number of voids found. 0 if the buffer or the workspace is too small.
+ */
+void_mapper_count_t void_mapper_cached(void_mapper_cache_t *cache, void_mapper_rectangle_t area,
+                                       const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                       void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                       const void_mapper_workspace_t *workspace);
+
+#ifdef VOID_MAPPER_STATS
+
+/**
+ * @brief Phases of a call timed by the statistics.
+ */
+typedef enum {
+    VOID_MAPPER_PHASE_SORT,     /* Sorting and culling the grid lines */
+    VOID_MAPPER_PHASE_GRID,     /* Mapping the input on the grid */
+    VOID_MAPPER_PHASE_CULL,     /* Finding the void cells, row by row, and outputting them */
+    VOID_MAPPER_PHASE_GROUP,    /* void_mapper_group() */
+    VOID_MAPPER_PHASE_COUNT
+} void_mapper_phase_t;
+
+/**
+ * @brief Statistics of the calls to void mapper, only available when the library and its
+ * users are compiled with VOID_MAPPER_STATS defined. The grid dimensions are those of the
+ * last call, all other fields add up over the calls. Clear the structure to start over.
+ */
+typedef struct {
+    void_mapper_count_t x_len;                  /* Vertical grid lines of the last call */
+    void_mapper_count_t y_len;                  /* Horizontal grid lines of the last call */
+    uint32_t cells;                             /* Cells of the grids, void or not */
+    uint32_t culled;                            /* Cells found to be covered by the input */
+    uint32_t span_tests;                        /* Tests of an input span against a grid row */
+    uint32_t duplicates;                        /* Grid lines removed as duplicates or outside the area */
+    uint32_t merge_passes;                      /* Passes of void_mapper_group() that merged something */
+    uint32_t merges;                            /* Rectangles merged by void_mapper_group() */
+    uint32_t ticks[VOID_MAPPER_PHASE_COUNT];    /* Clock ticks spent in each phase */
+} void_mapper_stats_t;
+
+/**
+ * @brief Collect statistics of the following calls into a structure. The statistics are
+ * kept in a global of the library, so they should only be collected from one thread.
+ *
+ * @param stats Statistics to add to, NULL to stop collecting
+ * @param clock Clock timing the phases, NULL to leave ticks untouched
+ */
+void void_mapper_stats_hook(void_mapper_stats_t *stats, void_mapper_clock_t clock);
+
+#endif /* VOID_MAPPER_STATS */
 
 #endif /* __VOID_MAPPER_H__ */
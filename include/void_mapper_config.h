@@ -0,0 +1,51 @@
+#ifndef __VOID_MAPPER_CONFIG_H__
+#define __VOID_MAPPER_CONFIG_H__
+
+#include <stdint.h>
+
+/**
+ * @brief Width in bits of the coordinates and sizes of the rectangles, 16 or 32. Define it
+ * when compiling the library and its users, e.g. -DVOID_MAPPER_COORD_BITS=32 for areas
+ * larger than 65535 pixels.
+ */
+#ifndef VOID_MAPPER_COORD_BITS
+#define VOID_MAPPER_COORD_BITS 16
+#endif
+
+/**
+ * @brief Width in bits of the counts and indices, 16 or 32: the number of input rectangles,
+ * the length of the buffers, the number of voids and the grid lines. With 16 bits, the
+ * input is limited to 32766 rectangles and the result to 65535 voids.
+ */
+#ifndef VOID_MAPPER_COUNT_BITS
+#define VOID_MAPPER_COUNT_BITS 16
+#endif
+
+#if VOID_MAPPER_COORD_BITS == 16
+typedef uint16_t void_mapper_coord_t;
+#define VOID_MAPPER_COORD_MAX UINT16_MAX
+#elif VOID_MAPPER_COORD_BITS == 32
+typedef uint32_t void_mapper_coord_t;
+#define VOID_MAPPER_COORD_MAX UINT32_MAX
+#else
+#error "VOID_MAPPER_COORD_BITS must be 16 or 32"
+#endif
+
+#if VOID_MAPPER_COUNT_BITS == 16
+typedef uint16_t void_mapper_count_t;
+typedef uint32_t void_mapper_word_t;
+#define VOID_MAPPER_COUNT_MAX UINT16_MAX
+#elif VOID_MAPPER_COUNT_BITS == 32
+typedef uint32_t void_mapper_count_t;
+typedef uint64_t void_mapper_word_t;
+#define VOID_MAPPER_COUNT_MAX UINT32_MAX
+#else
+#error "VOID_MAPPER_COUNT_BITS must be 16 or 32"
+#endif
+
+/*
+ * void_mapper_word_t is twice as wide as a count. Workspaces must be aligned for it, so
+ * declare static workspaces as arrays of void_mapper_word_t.
+ */
+
+#endif /* __VOID_MAPPER_CONFIG_H__ */
@@ -0,0 +1,47 @@
+#ifndef __VOID_MAPPER_PARALLEL_H__
+#define __VOID_MAPPER_PARALLEL_H__
+
+#include "void_mapper.h"
+
+/*
+ * Parallel front end for large areas on a host. Unlike the rest of the library it uses
+ * POSIX threads and allocates its memory from the heap, so it is built separately, see
+ * "make parallel", and linked with -pthread.
+ *
+ * The statistics of VOID_MAPPER_STATS are plain counters for one thread. The front end
+ * unhooks them while its threads run and hooks them again before returning, so the work of
+ * the threads is not counted. Do not call it while another thread maps with the statistics
+ * hooked.
+ */
+
+/**
+ * @brief Same result as void_mapper_grouped(), computed on several threads. The area is cut
+ * into horizontal bands, several per thread so that busy bands do not hold the others up.
+ * Each input rectangle is given to the bands it crosses, and the threads take the bands one
+ * at a time. The voids of the bands are then stitched: a void on the top edge of a band is
+ * merged with the one right above it when they span the same columns.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param n_threads Number of threads, 0 for one per online processor
+ * @return Number of voids found. 0 if the buffer is too small or memory is short.
+ */
+void_mapper_count_t void_mapper_parallel(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                         void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                         unsigned int n_threads);
+
+/**
+ * @brief Same as void_mapper_batch(), with the jobs spread over several threads. Each thread
+ * has a workspace of its own, allocated from the heap.
+ *
+ * @param jobs Array of jobs
+ * @param n_jobs Number of jobs
+ * @param n_threads Number of threads, 0 for one per online processor
+ * @return size_t number of jobs that failed, because of a buffer too small or memory short
+ */
+size_t void_mapper_batch_parallel(void_mapper_job_t *jobs, size_t n_jobs, unsigned int n_threads);
+
+#endif /* __VOID_MAPPER_PARALLEL_H__ */
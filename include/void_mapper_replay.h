@@ -0,0 +1,181 @@
+#ifndef __VOID_MAPPER_REPLAY_H__
+#define __VOID_MAPPER_REPLAY_H__
+
+#include <stdio.h>
+#include "void_mapper.h"
+
+/*
+ * Binary files of recorded frames, for replaying scenes captured on devices on a host. Like
+ * the parallel front end, this part is kept in host/, it maps files with mmap() and writes
+ * them with stdio.
+ *
+ * A file is a header followed by its frames, one after the other. A frame is a frame header
+ * followed by its rectangles. All fields are in the byte order of the device and laid out
+ * as the structures below, with rectangles of VOID_MAPPER_COORD_BITS bit coordinates, so a
+ * mapped file is used as is: the rectangles of a frame are passed to the mappers straight
+ * from the mapping. Every part is a multiple of 8 bytes long, which keeps them all aligned.
+ */
+
+/* Magic of a file of recorded scenes, the rectangles of a frame being the input */
+#define VOID_MAPPER_REPLAY_SCENES "VMSC"
+
+/* Magic of a file of results, the rectangles of a frame being the voids found */
+#define VOID_MAPPER_REPLAY_VOIDS "VMVO"
+
+#define VOID_MAPPER_REPLAY_VERSION 1
+
+/**
+ * @brief Header of a file.
+ */
+typedef struct {
+    char magic[4];          /* VOID_MAPPER_REPLAY_SCENES or VOID_MAPPER_REPLAY_VOIDS */
+    uint16_t version;       /* VOID_MAPPER_REPLAY_VERSION */
+    uint8_t coord_bits;     /* VOID_MAPPER_COORD_BITS of the rectangles */
+    uint8_t reserved;
+    uint64_t n_frames;      /* Number of frames following the header */
+} void_mapper_replay_header_t;
+
+/**
+ * @brief Header of a frame, followed by its rectangles.
+ */
+typedef struct {
+    void_mapper_rectangle_t area;
+    uint32_t length;        /* Number of rectangles following the header */
+    uint32_t reserved;
+} void_mapper_replay_frame_t;
+
+_Static_assert(sizeof(void_mapper_replay_header_t) % 8 == 0, "void_mapper_replay_header_t must keep the frames aligned");
+_Static_assert(sizeof(void_mapper_replay_frame_t) % 8 == 0, "void_mapper_replay_frame_t must keep the rectangles aligned");
+_Static_assert(sizeof(void_mapper_rectangle_t) % 8 == 0, "void_mapper_rectangle_t must keep the frames aligned");
+
+/**
+ * @brief File mapped for reading.
+ */
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    const uint8_t *end;     /* End of the last frame */
+    uint64_t n_frames;
+    uint32_t max_length;    /* Most rectangles in a frame */
+    uint64_t n_rectangles;  /* Rectangles of all frames */
+} void_mapper_replay_t;
+
+/**
+ * @brief File being written.
+ */
+typedef struct {
+    FILE *file;
+    uint64_t n_frames;
+} void_mapper_replay_writer_t;
+
+/**
+ * @brief Check a file held in memory and get its frame counts. Every frame is checked to
+ * lie within the memory once, so that the frames can then be walked without any check.
+ *
+ * @param replay For storage of the file
+ * @param data Content of the file, aligned to 8 bytes
+ * @param size Number of bytes of the file
+ * @param magic Expected magic
+ * @return true on success
+ * @return false if the file is not of the kind expected, of another version or coordinate
+ * size, or cut short
+ */
+bool void_mapper_replay_load(void_mapper_replay_t *replay, const void *data, size_t size, const char *magic);
+
+/**
+ * @brief Map a file and check it with void_mapper_replay_load().
+ *
+ * @param replay For storage of the file
+ * @param path Path of the file
+ * @param magic Expected magic
+ * @return true on success
+ * @return false if the file cannot be mapped or is not valid
+ */
+bool void_mapper_replay_open(void_mapper_replay_t *replay, const char *path, const char *magic);
+
+/**
+ * @brief Unmap a file opened by void_mapper_replay_open().
+ *
+ * @param replay File
+ */
+void void_mapper_replay_close(void_mapper_replay_t *replay);
+
+/**
+ * @brief Get the first frame of a file.
+ *
+ * @param replay Loaded file
+ * @return const void_mapper_replay_frame_t* the frame, NULL if there is none
+ */
+const void_mapper_replay_frame_t *void_mapper_replay_first(const void_mapper_replay_t *replay);
+
+/**
+ * @brief Get the frame after another one.
+ *
+ * @param replay Loaded file
+ * @param frame Frame of the file
+ * @return const void_mapper_replay_frame_t* the next frame, NULL after the last one
+ */
+const void_mapper_replay_frame_t *void_mapper_replay_next(const void_mapper_replay_t *replay, const void_mapper_replay_frame_t *frame);
+
+/**
+ * @brief Get the rectangles of a frame.
+ *
+ * @param frame Frame
+ * @return const void_mapper_rectangle_t* frame->length rectangles
+ */
+static inline const void_mapper_rectangle_t *void_mapper_replay_rectangles(const void_mapper_replay_frame_t *frame)
+{
+    return (const void_mapper_rectangle_t *) (frame + 1);
+}
+
+/**
+ * @brief Map the rectangles of a frame into a buffer, and group the voids found when a
+ * workspace for the grouping is given. Both workspaces come from the caller, so a replay of
+ * any number of frames allocates them once, for the largest frame and the buffer.
+ *
+ * @param frame Frame, read in place
+ * @param buffer Buffer for the voids
+ * @param buffer_length Length of the buffer
+ * @param workspace Scratch memory of at least void_mapper_workspace_size(frame->length) bytes
+ * @param group_workspace Scratch memory of at least void_mapper_group_workspace_size(buffer_length)
+ * bytes, NULL to keep the voids as found
+ * @return void_mapper_count_t number of voids, 0 if the buffer or a workspace is too small
+ */
+void_mapper_count_t void_mapper_replay_map(const void_mapper_replay_frame_t *frame, void_mapper_rectangle_t *buffer,
+                                           void_mapper_count_t buffer_length, const void_mapper_workspace_t *workspace,
+                                           const void_mapper_workspace_t *group_workspace);
+
+/**
+ * @brief Create a file to write frames to.
+ *
+ * @param writer For storage of the file
+ * @param path Path of the file, replaced if it exists
+ * @param magic Magic of the file
+ * @return true on success
+ * @return false if the file cannot be created
+ */
+bool void_mapper_replay_create(void_mapper_replay_writer_t *writer, const char *path, const char *magic);
+
+/**
+ * @brief Append a frame.
+ *
+ * @param writer File
+ * @param area Area of the frame
+ * @param rectangles Rectangles of the frame
+ * @param length Number of rectangles
+ * @return true on success
+ * @return false on a write error
+ */
+bool void_mapper_replay_write(void_mapper_replay_writer_t *writer, void_mapper_rectangle_t area,
+                              const void_mapper_rectangle_t *rectangles, uint32_t length);
+
+/**
+ * @brief Write the number of frames in the header and close the file.
+ *
+ * @param writer File
+ * @return true on success
+ * @return false on a write error
+ */
+bool void_mapper_replay_finish(void_mapper_replay_writer_t *writer);
+
+#endif /* __VOID_MAPPER_REPLAY_H__ */
@@ -1,9 +1,329 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
 #include "void_mapper.h"
+#include "void_mapper_replay.h"
+
+/*
+ * Replay of recorded scenes. The scene file is mapped and its frames are passed to
+ * void_mapper() straight from the mapping, and optionally grouped, with the workspaces and
+ * the buffer allocated up front for the largest frame. The report has the
+ * throughput, a histogram of the time per frame and a histogram of the voids per frame.
+ */
+
+/* Histogram buckets: each power of two is split in 2^HISTOGRAM_SPLIT buckets */
+#define HISTOGRAM_SPLIT 3
+#define HISTOGRAM_BUCKETS (64 << HISTOGRAM_SPLIT)
+
+/* Most voids kept of a frame, a frame with more is counted as failed */
+#define MAX_VOIDS (1u << 22)
+
+typedef struct {
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t n;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+} histogram_t;
+
+typedef struct {
+    const char *scenes;
+    const char *output;
+    uint32_t repeat;
+    bool group;
+    bool json;
+} options_t;
+
+static histogram_t latency;
+static histogram_t voids;
+
+/**
+ * @brief Get the bucket of a value, exact below 2^HISTOGRAM_SPLIT and within 1 / 2^HISTOGRAM_SPLIT
+ * of the value above.
+ *
+ * @param value Value
+ * @return unsigned int bucket
+ */
+static unsigned int histogram_bucket(uint64_t value);
+
+/**
+ * @brief Get the smallest value of a bucket.
+ *
+ * @param bucket Bucket
+ * @return uint64_t first value
+ */
+static uint64_t histogram_floor(unsigned int bucket);
+
+/**
+ * @brief Add a value to a histogram.
+ *
+ * @param histogram Histogram
+ * @param value Value
+ */
+static void histogram_add(histogram_t *histogram, uint64_t value);
+
+/**
+ * @brief Get a percentile of a histogram, as the first value of its bucket.
+ *
+ * @param histogram Histogram
+ * @param percent Percentile, from 0 to 100
+ * @return uint64_t value
+ */
+static uint64_t histogram_percentile(const histogram_t *histogram, double percent);
+
+/**
+ * @brief Print the statistics and the buckets in use of a histogram.
+ *
+ * @param histogram Histogram
+ * @param name Name of the histogram
+ * @param json true to print a JSON member, false for text
+ */
+static void histogram_print(const histogram_t *histogram, const char *name, bool json);
+
+/**
+ * @brief Read the monotonic clock.
+ *
+ * @return uint64_t nanoseconds
+ */
+static uint64_t now_ns(void);
+
+/**
+ * @brief Replay every frame of the scenes, repeat times, and print the report.
+ *
+ * @param replay Loaded scenes
+ * @param options Options
+ * @return int exit status
+ */
+static int replay_scenes(const void_mapper_replay_t *replay, const options_t *options);
+
+static unsigned int histogram_bucket(uint64_t value)
+{
+    if (value < (1u << HISTOGRAM_SPLIT)) {
+        return value;
+    }
+
+    unsigned int msb = 63 - __builtin_clzll(value);
+    unsigned int fraction = (value >> (msb - HISTOGRAM_SPLIT)) & ((1u << HISTOGRAM_SPLIT) - 1);
+    return ((msb - HISTOGRAM_SPLIT + 1) << HISTOGRAM_SPLIT) | fraction;
+}
+
+static uint64_t histogram_floor(unsigned int bucket)
+{
+    if (bucket < (1u << HISTOGRAM_SPLIT)) {
+        return bucket;
+    }
+
+    unsigned int msb = (bucket >> HISTOGRAM_SPLIT) + HISTOGRAM_SPLIT - 1;
+    uint64_t fraction = bucket & ((1u << HISTOGRAM_SPLIT) - 1);
+    return ((uint64_t) 1 << msb) | fraction << (msb - HISTOGRAM_SPLIT);
+}
+
+static void histogram_add(histogram_t *histogram, uint64_t value)
+{
+    histogram->counts[histogram_bucket(value)]++;
+    histogram->min = histogram->n == 0 || value < histogram->min ? value : histogram->min;
+    histogram->max = value > histogram->max ? value : histogram->max;
+    histogram->sum += value;
+    histogram->n++;
+}
+
+static uint64_t histogram_percentile(const histogram_t *histogram, double percent)
+{
+    uint64_t rank = (uint64_t) (percent / 100.0 * (histogram->n - 1));
+    uint64_t seen = 0;
+    for (unsigned int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        seen += histogram->counts[b];
+        if (seen > rank) {
+            return histogram_floor(b);
+        }
+    }
+
+    return histogram->max;
+}
+
+static void histogram_print(const histogram_t *histogram, const char *name, bool json)
+{
+    double mean = histogram->n > 0 ? (double) histogram->sum / histogram->n : 0.0;
+    if (json) {
+        printf("  \"%s\": {\"min\": %llu, \"mean\": %.1f, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu, \"buckets\": [",
+               name, (unsigned long long) histogram->min, mean,
+               (unsigned long long) histogram_percentile(histogram, 50), (unsigned long long) histogram_percentile(histogram, 90),
+               (unsigned long long) histogram_percentile(histogram, 99), (unsigned long long) histogram->max);
+    } else {
+        printf("%s: min %llu mean %.1f p50 %llu p90 %llu p99 %llu max %llu\n",
+               name, (unsigned long long) histogram->min, mean,
+               (unsigned long long) histogram_percentile(histogram, 50), (unsigned long long) histogram_percentile(histogram, 90),
+               (unsigned long long) histogram_percentile(histogram, 99), (unsigned long long) histogram->max);
+    }
+
+    bool first = true;
+    for (unsigned int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        if (histogram->counts[b] == 0) {
+            continue;
+        }
+
+        unsigned long long from = histogram_floor(b);
+        unsigned long long to = b + 1 < HISTOGRAM_BUCKETS ? histogram_floor(b + 1) : UINT64_MAX;
+        if (json) {
+            printf("%s{\"from\": %llu, \"to\": %llu, \"count\": %llu}", first ? "" : ", ", from, to, (unsigned long long) histogram->counts[b]);
+        } else {
+            printf("  [%llu, %llu) %llu\n", from, to, (unsigned long long) histogram->counts[b]);
+        }
+        first = false;
+    }
+
+    if (json) {
+        printf("]}");
+    }
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static int replay_scenes(const void_mapper_replay_t *replay, const options_t *options)
+{
+    if (replay->max_length > VOID_MAPPER_COUNT_MAX) {
+        fprintf(stderr, "void-mapper: frames of up to %u rectangles, rebuild with BITS=32 for more\n", (unsigned) VOID_MAPPER_COUNT_MAX);
+        return EXIT_FAILURE;
+    }
+
+    /* Everything is allocated once, for the largest frame */
+    size_t buffer_length = VOID_MAPPER_MIN_BUFFER_LENGTH(replay->max_length);
+    buffer_length = buffer_length < VOID_MAPPER_COUNT_MAX ? buffer_length : VOID_MAPPER_COUNT_MAX;
+    buffer_length = buffer_length < MAX_VOIDS ? buffer_length : MAX_VOIDS;
+    void_mapper_workspace_t workspace = { .size = void_mapper_workspace_size(replay->max_length) };
+    workspace.memory = malloc(workspace.size);
+    void_mapper_workspace_t group_workspace = { .size = options->group ? void_mapper_group_workspace_size(buffer_length) : 0 };
+    group_workspace.memory = options->group ? malloc(group_workspace.size) : NULL;
+    void_mapper_rectangle_t *buffer = malloc(buffer_length * sizeof(buffer[0]));
+    if (workspace.memory == NULL || (options->group && group_workspace.memory == NULL) || buffer == NULL) {
+        fprintf(stderr, "void-mapper: out of memory\n");
+        free(workspace.memory);
+        free(group_workspace.memory);
+        free(buffer);
+        return EXIT_FAILURE;
+    }
+
+    void_mapper_replay_writer_t writer = { 0 };
+    if (options->output != NULL && !void_mapper_replay_create(&writer, options->output, VOID_MAPPER_REPLAY_VOIDS)) {
+        fprintf(stderr, "void-mapper: cannot create %s\n", options->output);
+        free(workspace.memory);
+        free(group_workspace.memory);
+        free(buffer);
+        return EXIT_FAILURE;
+    }
+
+    uint64_t n_failed = 0;
+    bool written = true;
+    uint64_t start = now_ns();
+    for (uint32_t pass = 0; pass < options->repeat; pass++) {
+        for (const void_mapper_replay_frame_t *frame = void_mapper_replay_first(replay); frame != NULL;
+             frame = void_mapper_replay_next(replay, frame)) {
+            uint64_t frame_start = now_ns();
+
+            void_mapper_count_t n_voids = void_mapper_replay_map(frame, buffer, buffer_length, &workspace,
+                                                                 options->group ? &group_workspace : NULL);
+            histogram_add(&latency, now_ns() - frame_start);
+            histogram_add(&voids, n_voids);
+
+            /* The buffer holds every void of the largest frame unless capped, the workspace always fits */
+            n_failed += n_voids == 0 && buffer_length < VOID_MAPPER_MIN_BUFFER_LENGTH(frame->length);
+            if (pass == 0 && writer.file != NULL) {
+                written = void_mapper_replay_write(&writer, frame->area, buffer, n_voids) && written;
+            }
+        }
+    }
+    double seconds = (now_ns() - start) / 1e9;
+
+    if (writer.file != NULL) {
+        written = void_mapper_replay_finish(&writer) && written;
+    }
+    free(workspace.memory);
+    free(group_workspace.memory);
+    free(buffer);
+
+    uint64_t n_frames = latency.n;
+    uint64_t n_rectangles = replay->n_rectangles * options->repeat;
+    if (options->json) {
+        printf("{\n  \"frames\": %llu,\n  \"failed\": %llu,\n  \"rectangles\": %llu,\n  \"seconds\": %.6f,\n"
+               "  \"frames_per_second\": %.1f,\n  \"rectangles_per_second\": %.1f,\n",
+               (unsigned long long) n_frames, (unsigned long long) n_failed, (unsigned long long) n_rectangles, seconds,
+               n_frames / seconds, n_rectangles / seconds);
+        histogram_print(&latency, "latency_ns", true);
+        printf(",\n");
+        histogram_print(&voids, "voids", true);
+        printf("\n}\n");
+    } else {
+        printf("frames: %llu, failed %llu, input rectangles %llu\n",
+               (unsigned long long) n_frames, (unsigned long long) n_failed, (unsigned long long) n_rectangles);
+        printf("time: %.3f s, %.1f frames/s, %.1f rectangles/s\n", seconds, n_frames / seconds, n_rectangles / seconds);
+        histogram_print(&latency, "latency ns", false);
+        histogram_print(&voids, "voids", false);
+    }
+
+    if (!written) {
+        fprintf(stderr, "void-mapper: cannot write %s\n", options->output);
+        return EXIT_FAILURE;
+    }
+
+    return n_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: void-mapper [--group] [--repeat N] [--json] [--output VOIDS] SCENES\n");
+}
 
 int main(int argc, char *argv[])
 {
-    (void) argc;
-    (void) argv;
-    return EXIT_SUCCESS;
+    options_t options = { .repeat = 1 };
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--group") == 0) {
+            options.group = true;
+        } else if (strcmp(argv[i], "--repeat") == 0 && has_value) {
+            long n = strtol(argv[++i], NULL, 10);
+            if (n < 1) {
+                usage();
+                return EXIT_FAILURE;
+            }
+            options.repeat = n;
+        } else if (strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        } else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            options.output = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0) {
+            usage();
+            return EXIT_SUCCESS;
+        } else if (argv[i][0] != '-' && options.scenes == NULL) {
+            options.scenes = argv[i];
+        } else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (options.scenes == NULL) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    void_mapper_replay_t replay;
+    if (!void_mapper_replay_open(&replay, options.scenes, VOID_MAPPER_REPLAY_SCENES)) {
+        fprintf(stderr, "void-mapper: %s is not a scene file of %d bit coordinates\n", options.scenes, VOID_MAPPER_COORD_BITS);
+        return EXIT_FAILURE;
+    }
+
+    int status = replay_scenes(&replay, &options);
+    void_mapper_replay_close(&replay);
+
+    return status;
 }
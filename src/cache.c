@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "void_mapper.h"
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+/* Entry state bits */
+#define ENTRY_USED          (1 << 0)
+#define ENTRY_REFERENCED    (1 << 1)
+
+typedef struct {
+    uint32_t hash;
+    void_mapper_rectangle_t area;
+    void_mapper_count_t input_length;
+    void_mapper_count_t n_voids;
+    uint8_t state;
+} entry_t;
+
+_Static_assert(sizeof(entry_t) == VOID_MAPPER_CACHE_ENTRY_SIZE, "VOID_MAPPER_CACHE_SIZE is out of date");
+
+/**
+ * @brief FNV-1a hash of the area and the input, one coordinate at a time.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @return uint32_t the hash
+ */
+static uint32_t hash_input(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length);
+
+/**
+ * @brief Find the entry of an input.
+ *
+ * @param cache Cache
+ * @param hash Hash of the input
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @return entry_t* the entry, NULL if the input is not in the cache
+ */
+static entry_t *find_entry(const void_mapper_cache_t *cache, uint32_t hash, void_mapper_rectangle_t area,
+                           const void_mapper_rectangle_t *input, void_mapper_count_t input_length);
+
+/**
+ * @brief Pick the entry to store a new input in: a free one, or else the first one the hand
+ * finds without a hit since it last passed.
+ *
+ * @param cache Cache
+ * @return void_mapper_count_t index of the entry
+ */
+static void_mapper_count_t pick_entry(void_mapper_cache_t *cache);
+
+static uint32_t hash_input(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length)
+{
+    uint32_t hash = FNV_OFFSET;
+    hash = (hash ^ area.position.x) * FNV_PRIME;
+    hash = (hash ^ area.position.y) * FNV_PRIME;
+    hash = (hash ^ area.size.x) * FNV_PRIME;
+    hash = (hash ^ area.size.y) * FNV_PRIME;
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        hash = (hash ^ input[i].position.x) * FNV_PRIME;
+        hash = (hash ^ input[i].position.y) * FNV_PRIME;
+        hash = (hash ^ input[i].size.x) * FNV_PRIME;
+        hash = (hash ^ input[i].size.y) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static entry_t *find_entry(const void_mapper_cache_t *cache, uint32_t hash, void_mapper_rectangle_t area,
+                           const void_mapper_rectangle_t *input, void_mapper_count_t input_length)
+{
+    entry_t *entries = cache->entries;
+    for (void_mapper_count_t e = 0; e < cache->n_entries; e++) {
+        entry_t *entry = &entries[e];
+        if (!(entry->state & ENTRY_USED) || entry->hash != hash || entry->input_length != input_length ||
+            memcmp(&entry->area, &area, sizeof(area)) != 0) {
+            continue;
+        }
+
+        /* The hash only narrows the search down, the input itself decides */
+        const void_mapper_rectangle_t *kept = &cache->inputs[(size_t) e * cache->max_input];
+        if (input_length == 0 || memcmp(kept, input, input_length * sizeof(input[0])) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void_mapper_count_t pick_entry(void_mapper_cache_t *cache)
+{
+    entry_t *entries = cache->entries;
+    while (true) {
+        void_mapper_count_t e = cache->hand;
+        cache->hand = e + 1 < cache->n_entries ? e + 1 : 0;
+
+        if (!(entries[e].state & ENTRY_USED)) {
+            return e;
+        }
+
+        if (entries[e].state & ENTRY_REFERENCED) {
+            entries[e].state &= ~ENTRY_REFERENCED;
+            continue;
+        }
+
+        cache->evictions++;
+        return e;
+    }
+}
+
+size_t void_mapper_cache_size(void_mapper_count_t n_entries, void_mapper_count_t max_input, void_mapper_count_t max_voids)
+{
+    return VOID_MAPPER_CACHE_SIZE(n_entries, max_input, max_voids);
+}
+
+bool void_mapper_cache_init(void_mapper_cache_t *cache, void_mapper_count_t n_entries, void_mapper_count_t max_input,
+                            void_mapper_count_t max_voids, void *memory, size_t size)
+{
+    if (cache == NULL || memory == NULL || n_entries == 0 ||
+        size < void_mapper_cache_size(n_entries, max_input, max_voids) ||
+        (uintptr_t) memory % sizeof(void_mapper_word_t) != 0) {
+        return false;
+    }
+
+    uint8_t *bytes = memory;
+    cache->entries = bytes;
+    bytes += (size_t) n_entries * sizeof(entry_t);
+    cache->inputs = (void_mapper_rectangle_t *) bytes;
+    bytes += (size_t) n_entries * max_input * sizeof(void_mapper_rectangle_t);
+    cache->voids = (void_mapper_rectangle_t *) bytes;
+
+    cache->n_entries = n_entries;
+    cache->max_input = max_input;
+    cache->max_voids = max_voids;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+    void_mapper_cache_clear(cache);
+
+    return true;
+}
+
+void void_mapper_cache_clear(void_mapper_cache_t *cache)
+{
+    memset(cache->entries, 0, (size_t) cache->n_entries * sizeof(entry_t));
+    cache->hand = 0;
+}
+
+void_mapper_count_t void_mapper_cached(void_mapper_cache_t *cache, void_mapper_rectangle_t area,
+                                       const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                       void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                       const void_mapper_workspace_t *workspace)
+{
+    if (buffer == NULL || buffer_length == 0) {
+        return 0;
+    }
+
+    input_length = input == NULL ? 0 : input_length;
+    uint32_t hash = hash_input(area, input, input_length);
+    entry_t *entry = find_entry(cache, hash, area, input, input_length);
+    if (entry != NULL) {
+        cache->hits++;
+        entry->state |= ENTRY_REFERENCED;
+        if (entry->n_voids > buffer_length) {
+            return 0;
+        }
+
+        size_t e = entry - (entry_t *) cache->entries;
+        memcpy(buffer, &cache->voids[e * cache->max_voids], entry->n_voids * sizeof(buffer[0]));
+        return entry->n_voids;
+    }
+
+    /* The input is only read, the cast matches the older signature */
+    cache->misses++;
+    void_mapper_count_t n_voids = void_mapper_with_workspace(area, (void_mapper_rectangle_t *) input, input_length,
+                                                             buffer, buffer_length, workspace);
+    if (n_voids == 0 || n_voids > cache->max_voids || input_length > cache->max_input) {
+        return n_voids;
+    }
+
+    void_mapper_count_t e = pick_entry(cache);
+    entry = &((entry_t *) cache->entries)[e];
+    *entry = (entry_t) {
+        .hash = hash,
+        .area = area,
+        .input_length = input_length,
+        .n_voids = n_voids,
+        .state = ENTRY_USED,
+    };
+    if (input_length > 0) {
+        memcpy(&cache->inputs[(size_t) e * cache->max_input], input, input_length * sizeof(input[0]));
+    }
+    memcpy(&cache->voids[(size_t) e * cache->max_voids], buffer, n_voids * sizeof(buffer[0]));
+
+    return n_voids;
+}
@@ -0,0 +1,515 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "coordinates.h"
+
+/**
+ * @brief Add a reference to a coordinate of a grid vector. A coordinate that is new to the
+ * vector splits a column (or row) of the grid in two, where both halves keep the occupancy
+ * of the original. The new half takes a free slot of the grid, so only its cells are written
+ * and only the slots of the one axis move: O(n) for n rectangles.
+ *
+ * @param ctx Context
+ * @param horizontal true for the x vector, false for the y vector
+ * @param value Coordinate to add
+ */
+static void acquire_coordinate(void_mapper_ctx_t *ctx, bool horizontal, void_mapper_coord_t value);
+
+/**
+ * @brief Remove a reference to a coordinate of a grid vector. When no references remain,
+ * the coordinate is removed and the two columns (or rows) on each side of it are merged, by
+ * freeing the slot of the second one: O(n) for n rectangles.
+ *
+ * @param ctx Context
+ * @param horizontal true for the x vector, false for the y vector
+ * @param value Coordinate to remove
+ */
+static void release_coordinate(void_mapper_ctx_t *ctx, bool horizontal, void_mapper_coord_t value);
+
+/**
+ * @brief Add or remove the occupancy of a rectangle to all cells it covers.
+ *
+ * @param ctx Context
+ * @param rectangle Rectangle, all its edges within the area must be part of the grid
+ * @param delta 1 to add the rectangle, -1 to remove it
+ */
+static void apply_rectangle(void_mapper_ctx_t *ctx, void_mapper_rectangle_t rectangle, int delta);
+
+/**
+ * @brief Extend the changed region with the part of a rectangle within the area. The
+ * rectangles of the region that overlap it are merged into it, until none overlaps. When the
+ * region has no room left, it is merged with the rectangle it grows least.
+ *
+ * @param ctx Context
+ * @param rectangle Rectangle that changed
+ */
+static void mark_dirty(void_mapper_ctx_t *ctx, void_mapper_rectangle_t rectangle);
+
+/**
+ * @brief Test whether two rectangles share at least one pixel.
+ *
+ * @param a First rectangle
+ * @param b Second rectangle
+ * @return true if they overlap
+ */
+static bool rectangles_overlap(void_mapper_rectangle_t a, void_mapper_rectangle_t b);
+
+/**
+ * @brief Get the bounding box of two rectangles.
+ *
+ * @param a First rectangle
+ * @param b Second rectangle
+ * @return void_mapper_rectangle_t bounding box
+ */
+static void_mapper_rectangle_t bounding_box(void_mapper_rectangle_t a, void_mapper_rectangle_t b);
+
+/**
+ * @brief Get the voids of the cells within one rectangle of the changed region, clipped to it.
+ *
+ * @param ctx Context
+ * @param dirty Rectangle of the changed region
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param n_found Number of voids already in the buffer, updated
+ * @return true on success
+ * @return false if the buffer is too small
+ */
+static bool dirty_rectangle_voids(const void_mapper_ctx_t *ctx, void_mapper_rectangle_t dirty,
+                                  void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                  void_mapper_count_t *n_found);
+
+static void split_grid(void_mapper_ctx_t *ctx, bool horizontal, void_mapper_count_t index)
+{
+    void_mapper_count_t *slots = horizontal ? ctx->x_slots : ctx->y_slots;
+    void_mapper_count_t cells = (horizontal ? ctx->x_len : ctx->y_len) - 1;
+
+    /* The first free slot follows the slots in use, it becomes cell index */
+    void_mapper_count_t slot = slots[cells];
+    void_mapper_count_t from = slots[index - 1];
+    memmove(&slots[index + 1], &slots[index], (cells - index) * sizeof(slots[0]));
+    slots[index] = slot;
+
+    /* Cell index - 1 is split, the new cell is a copy of it */
+    if (horizontal) {
+        for (void_mapper_count_t j = 0; j + 1 < ctx->y_len; j++) {
+            void_mapper_count_t *row = &ctx->grid[(size_t) ctx->y_slots[j] * ctx->stride];
+            row[slot] = row[from];
+        }
+    } else {
+        memcpy(&ctx->grid[(size_t) slot * ctx->stride], &ctx->grid[(size_t) from * ctx->stride], ctx->stride * sizeof(ctx->grid[0]));
+    }
+}
+
+static void merge_grid(void_mapper_ctx_t *ctx, bool horizontal, void_mapper_count_t index)
+{
+    void_mapper_count_t *slots = horizontal ? ctx->x_slots : ctx->y_slots;
+    void_mapper_count_t cells = (horizontal ? ctx->x_len : ctx->y_len) - 1;
+
+    /* No rectangle has an edge at the coordinate, so both sides have the same occupancy and cell index is freed */
+    void_mapper_count_t slot = slots[index];
+    memmove(&slots[index], &slots[index + 1], (cells - index - 1) * sizeof(slots[0]));
+    slots[cells - 1] = slot;
+}
+
+static void acquire_coordinate(void_mapper_ctx_t *ctx, bool horizontal, void_mapper_coord_t value)
+{
+    void_mapper_coord_t *vector = horizontal ? ctx->x_vector : ctx->y_vector;
+    void_mapper_count_t *refs = horizontal ? ctx->x_refs : ctx->y_refs;
+    void_mapper_count_t *len = horizontal ? &ctx->x_len : &ctx->y_len;
+
+    /* Coordinates outside the area are not part of the grid */
+    if (value < vector[0] || value > vector[*len - 1]) {
+        return;
+    }
+
+    void_mapper_count_t index = coordinates_lower_bound(vector, *len, value);
+    if (vector[index] == value) {
+        refs[index]++;
+        return;
+    }
+
+    split_grid(ctx, horizontal, index);
+
+    memmove(&vector[index + 1], &vector[index], (*len - index) * sizeof(vector[0]));
+    memmove(&refs[index + 1], &refs[index], (*len - index) * sizeof(refs[0]));
+    vector[index] = value;
+    refs[index] = 1;
+    (*len)++;
+}
+
+static void release_coordinate(void_mapper_ctx_t *ctx, bool horizontal, void_mapper_coord_t value)
+{
+    void_mapper_coord_t *vector = horizontal ? ctx->x_vector : ctx->y_vector;
+    void_mapper_count_t *refs = horizontal ? ctx->x_refs : ctx->y_refs;
+    void_mapper_count_t *len = horizontal ? &ctx->x_len : &ctx->y_len;
+
+    if (value < vector[0] || value > vector[*len - 1]) {
+        return;
+    }
+
+    void_mapper_count_t index = coordinates_lower_bound(vector, *len, value);
+    if (--refs[index] > 0) {
+        return;
+    }
+
+    /* The edges of the area always hold a reference, so index is never the first or last */
+    merge_grid(ctx, horizontal, index);
+
+    memmove(&vector[index], &vector[index + 1], (*len - index - 1) * sizeof(vector[0]));
+    memmove(&refs[index], &refs[index + 1], (*len - index - 1) * sizeof(refs[0]));
+    (*len)--;
+}
+
+static void acquire_rectangle(void_mapper_ctx_t *ctx, void_mapper_rectangle_t rectangle)
+{
+    acquire_coordinate(ctx, true, rectangle.position.x);
+    acquire_coordinate(ctx, true, coordinates_end(rectangle.position.x, rectangle.size.x));
+    acquire_coordinate(ctx, false, rectangle.position.y);
+    acquire_coordinate(ctx, false, coordinates_end(rectangle.position.y, rectangle.size.y));
+}
+
+static void release_rectangle(void_mapper_ctx_t *ctx, void_mapper_rectangle_t rectangle)
+{
+    release_coordinate(ctx, true, rectangle.position.x);
+    release_coordinate(ctx, true, coordinates_end(rectangle.position.x, rectangle.size.x));
+    release_coordinate(ctx, false, rectangle.position.y);
+    release_coordinate(ctx, false, coordinates_end(rectangle.position.y, rectangle.size.y));
+}
+
+static void apply_rectangle(void_mapper_ctx_t *ctx, void_mapper_rectangle_t rectangle, int delta)
+{
+    void_mapper_count_t x0, x1, y0, y1;
+    if (!coordinates_cells(ctx->x_vector, ctx->x_len, rectangle.position.x, coordinates_end(rectangle.position.x, rectangle.size.x), &x0, &x1) ||
+        !coordinates_cells(ctx->y_vector, ctx->y_len, rectangle.position.y, coordinates_end(rectangle.position.y, rectangle.size.y), &y0, &y1)) {
+        return;
+    }
+
+    for (void_mapper_count_t j = y0; j < y1; j++) {
+        void_mapper_count_t *row = &ctx->grid[(size_t) ctx->y_slots[j] * ctx->stride];
+        for (void_mapper_count_t i = x0; i < x1; i++) {
+            row[ctx->x_slots[i]] += delta;
+        }
+    }
+}
+
+static void mark_dirty(void_mapper_ctx_t *ctx, void_mapper_rectangle_t rectangle)
+{
+    void_mapper_coord_t x0 = rectangle.position.x;
+    void_mapper_coord_t y0 = rectangle.position.y;
+    void_mapper_coord_t x1 = coordinates_end(x0, rectangle.size.x);
+    void_mapper_coord_t y1 = coordinates_end(y0, rectangle.size.y);
+
+    /* Clip to the area */
+    void_mapper_coord_t ax0 = ctx->area.position.x;
+    void_mapper_coord_t ay0 = ctx->area.position.y;
+    void_mapper_coord_t ax1 = coordinates_end(ax0, ctx->area.size.x);
+    void_mapper_coord_t ay1 = coordinates_end(ay0, ctx->area.size.y);
+    x0 = x0 < ax0 ? ax0 : x0;
+    y0 = y0 < ay0 ? ay0 : y0;
+    x1 = x1 > ax1 ? ax1 : x1;
+    y1 = y1 > ay1 ? ay1 : y1;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    void_mapper_rectangle_t region = {
+        .position.x = x0,
+        .position.y = y0,
+        .size.x = x1 - x0,
+        .size.y = y1 - y0
+    };
+
+    /* Every merge takes a rectangle out of the list, so this ends */
+    for (;;) {
+        void_mapper_count_t i = 0;
+        while (i < ctx->n_dirty) {
+            if (!rectangles_overlap(region, ctx->dirty[i])) {
+                i++;
+                continue;
+            }
+
+            /* The merged region may overlap rectangles already passed */
+            region = bounding_box(region, ctx->dirty[i]);
+            ctx->dirty[i] = ctx->dirty[--ctx->n_dirty];
+            i = 0;
+        }
+
+        if (ctx->n_dirty < VOID_MAPPER_CTX_DIRTY) {
+            ctx->dirty[ctx->n_dirty++] = region;
+            return;
+        }
+
+        /* No room: merge with the rectangle that grows least, then with what the result overlaps */
+        void_mapper_count_t best = 0;
+        uint64_t best_growth = UINT64_MAX;
+        for (i = 0; i < ctx->n_dirty; i++) {
+            void_mapper_rectangle_t merged = bounding_box(region, ctx->dirty[i]);
+            uint64_t growth = (uint64_t) merged.size.x * merged.size.y -
+                              (uint64_t) ctx->dirty[i].size.x * ctx->dirty[i].size.y;
+            if (growth < best_growth) {
+                best = i;
+                best_growth = growth;
+            }
+        }
+
+        region = bounding_box(region, ctx->dirty[best]);
+        ctx->dirty[best] = ctx->dirty[--ctx->n_dirty];
+    }
+}
+
+static bool rectangles_overlap(void_mapper_rectangle_t a, void_mapper_rectangle_t b)
+{
+    return a.position.x < coordinates_end(b.position.x, b.size.x) &&
+           b.position.x < coordinates_end(a.position.x, a.size.x) &&
+           a.position.y < coordinates_end(b.position.y, b.size.y) &&
+           b.position.y < coordinates_end(a.position.y, a.size.y);
+}
+
+static void_mapper_rectangle_t bounding_box(void_mapper_rectangle_t a, void_mapper_rectangle_t b)
+{
+    void_mapper_coord_t x0 = a.position.x < b.position.x ? a.position.x : b.position.x;
+    void_mapper_coord_t y0 = a.position.y < b.position.y ? a.position.y : b.position.y;
+    void_mapper_coord_t ax1 = coordinates_end(a.position.x, a.size.x);
+    void_mapper_coord_t ay1 = coordinates_end(a.position.y, a.size.y);
+    void_mapper_coord_t bx1 = coordinates_end(b.position.x, b.size.x);
+    void_mapper_coord_t by1 = coordinates_end(b.position.y, b.size.y);
+    void_mapper_coord_t x1 = ax1 > bx1 ? ax1 : bx1;
+    void_mapper_coord_t y1 = ay1 > by1 ? ay1 : by1;
+
+    return (void_mapper_rectangle_t) {
+        .position.x = x0,
+        .position.y = y0,
+        .size.x = x1 - x0,
+        .size.y = y1 - y0
+    };
+}
+
+static bool valid_handle(const void_mapper_ctx_t *ctx, void_mapper_handle_t handle)
+{
+    return handle < ctx->capacity && ctx->used[handle];
+}
+
+size_t void_mapper_ctx_size(void_mapper_count_t capacity)
+{
+    return VOID_MAPPER_CTX_SIZE(capacity);
+}
+
+bool void_mapper_ctx_init(void_mapper_ctx_t *ctx, void_mapper_rectangle_t area, void_mapper_count_t capacity,
+                          void *memory, size_t size)
+{
+#ifdef VOID_MAPPER_DETERMINISTIC
+    if (capacity > VOID_MAPPER_MAX_SPRITES) {
+        return false;
+    }
+#endif
+
+    if (ctx == NULL || memory == NULL || capacity > (VOID_MAPPER_COUNT_MAX - 2) / 2 ||
+        size < void_mapper_ctx_size(capacity) ||
+        (uintptr_t) memory % sizeof(void_mapper_word_t) != 0) {
+        return false;
+    }
+
+    size_t vec_len = (size_t) capacity * 2 + 2;
+    size_t grid_len = (vec_len - 1) * (vec_len - 1);
+    uint8_t *bytes = memory;
+
+    ctx->area = area;
+    ctx->capacity = capacity;
+    ctx->rectangles = (void_mapper_rectangle_t *) bytes;
+    bytes += capacity * sizeof(void_mapper_rectangle_t);
+    ctx->x_vector = (void_mapper_coord_t *) bytes;
+    bytes += vec_len * sizeof(void_mapper_coord_t);
+    ctx->x_refs = (void_mapper_count_t *) bytes;
+    bytes += vec_len * sizeof(void_mapper_count_t);
+    ctx->y_vector = (void_mapper_coord_t *) bytes;
+    bytes += vec_len * sizeof(void_mapper_coord_t);
+    ctx->y_refs = (void_mapper_count_t *) bytes;
+    bytes += vec_len * sizeof(void_mapper_count_t);
+    ctx->grid = (void_mapper_count_t *) bytes;
+    bytes += grid_len * sizeof(void_mapper_count_t);
+    ctx->x_slots = (void_mapper_count_t *) bytes;
+    bytes += (vec_len - 1) * sizeof(void_mapper_count_t);
+    ctx->y_slots = (void_mapper_count_t *) bytes;
+    bytes += (vec_len - 1) * sizeof(void_mapper_count_t);
+    ctx->used = bytes;
+    ctx->stride = vec_len - 1;
+    ctx->n_dirty = 0;
+
+    memset(ctx->used, 0, capacity);
+    memset(ctx->grid, 0, grid_len * sizeof(ctx->grid[0]));
+    for (void_mapper_count_t i = 0; i < ctx->stride; i++) {
+        ctx->x_slots[i] = i;
+        ctx->y_slots[i] = i;
+    }
+
+    /* The edges of the area are always part of the grid */
+    void_mapper_coord_t x_end = coordinates_end(area.position.x, area.size.x);
+    void_mapper_coord_t y_end = coordinates_end(area.position.y, area.size.y);
+    ctx->x_vector[0] = area.position.x;
+    ctx->x_refs[0] = 1;
+    ctx->x_len = 1;
+    ctx->y_vector[0] = area.position.y;
+    ctx->y_refs[0] = 1;
+    ctx->y_len = 1;
+    if (x_end == area.position.x) {
+        ctx->x_refs[0]++;
+    } else {
+        ctx->x_vector[ctx->x_len] = x_end;
+        ctx->x_refs[ctx->x_len++] = 1;
+    }
+    if (y_end == area.position.y) {
+        ctx->y_refs[0]++;
+    } else {
+        ctx->y_vector[ctx->y_len] = y_end;
+        ctx->y_refs[ctx->y_len++] = 1;
+    }
+
+    return true;
+}
+
+void_mapper_handle_t void_mapper_ctx_add(void_mapper_ctx_t *ctx, void_mapper_rectangle_t rectangle)
+{
+    for (void_mapper_count_t handle = 0; handle < ctx->capacity; handle++) {
+        if (ctx->used[handle]) {
+            continue;
+        }
+
+        acquire_rectangle(ctx, rectangle);
+        apply_rectangle(ctx, rectangle, 1);
+        mark_dirty(ctx, rectangle);
+
+        ctx->rectangles[handle] = rectangle;
+        ctx->used[handle] = 1;
+        return handle;
+    }
+
+    return VOID_MAPPER_INVALID_HANDLE;
+}
+
+bool void_mapper_ctx_move(void_mapper_ctx_t *ctx, void_mapper_handle_t handle, void_mapper_rectangle_t rectangle)
+{
+    if (!valid_handle(ctx, handle)) {
+        return false;
+    }
+
+    void_mapper_rectangle_t previous = ctx->rectangles[handle];
+    apply_rectangle(ctx, previous, -1);
+
+    /* Acquire before release, so that edges shared by both are not removed and added again */
+    acquire_rectangle(ctx, rectangle);
+    release_rectangle(ctx, previous);
+    apply_rectangle(ctx, rectangle, 1);
+
+    mark_dirty(ctx, previous);
+    mark_dirty(ctx, rectangle);
+    ctx->rectangles[handle] = rectangle;
+
+    return true;
+}
+
+bool void_mapper_ctx_remove(void_mapper_ctx_t *ctx, void_mapper_handle_t handle)
+{
+    if (!valid_handle(ctx, handle)) {
+        return false;
+    }
+
+    void_mapper_rectangle_t previous = ctx->rectangles[handle];
+    apply_rectangle(ctx, previous, -1);
+    release_rectangle(ctx, previous);
+    mark_dirty(ctx, previous);
+
+    ctx->used[handle] = 0;
+
+    return true;
+}
+
+void_mapper_count_t void_mapper_ctx_voids(const void_mapper_ctx_t *ctx, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length)
+{
+    if (buffer == NULL || buffer_length == 0) {
+        return 0;
+    }
+
+    void_mapper_count_t n_found = 0;
+    for (void_mapper_count_t j = 0; j + 1 < ctx->y_len; j++) {
+        const void_mapper_count_t *row = &ctx->grid[(size_t) ctx->y_slots[j] * ctx->stride];
+        for (void_mapper_count_t i = 0; i + 1 < ctx->x_len; i++) {
+            if (row[ctx->x_slots[i]] != 0) {
+                continue;
+            }
+
+            if (n_found == buffer_length) {
+                return 0;
+            }
+
+            buffer[n_found++] = (void_mapper_rectangle_t) {
+                .position.x = ctx->x_vector[i],
+                .position.y = ctx->y_vector[j],
+                .size.x = ctx->x_vector[i + 1] - ctx->x_vector[i],
+                .size.y = ctx->y_vector[j + 1] - ctx->y_vector[j]
+            };
+        }
+    }
+
+    return n_found;
+}
+
+void_mapper_count_t void_mapper_ctx_dirty_voids(void_mapper_ctx_t *ctx, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length)
+{
+    if (buffer == NULL || buffer_length == 0 || ctx->n_dirty == 0) {
+        return 0;
+    }
+
+    /* The rectangles of the changed region are disjoint, so are their voids */
+    void_mapper_count_t n_found = 0;
+    for (void_mapper_count_t k = 0; k < ctx->n_dirty; k++) {
+        if (!dirty_rectangle_voids(ctx, ctx->dirty[k], buffer, buffer_length, &n_found)) {
+            return 0;
+        }
+    }
+
+    ctx->n_dirty = 0;
+
+    return n_found;
+}
+
+static bool dirty_rectangle_voids(const void_mapper_ctx_t *ctx, void_mapper_rectangle_t dirty,
+                                  void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                  void_mapper_count_t *n_found)
+{
+    void_mapper_coord_t dx1 = coordinates_end(dirty.position.x, dirty.size.x);
+    void_mapper_coord_t dy1 = coordinates_end(dirty.position.y, dirty.size.y);
+
+    /* The edges of the changed region are not always grid lines, so start at the cell containing them */
+    void_mapper_count_t i0 = coordinates_lower_bound(ctx->x_vector, ctx->x_len, dirty.position.x + 1) - 1;
+    void_mapper_count_t i1 = coordinates_lower_bound(ctx->x_vector, ctx->x_len, dx1);
+    void_mapper_count_t j0 = coordinates_lower_bound(ctx->y_vector, ctx->y_len, dirty.position.y + 1) - 1;
+    void_mapper_count_t j1 = coordinates_lower_bound(ctx->y_vector, ctx->y_len, dy1);
+
+    for (void_mapper_count_t j = j0; j < j1; j++) {
+        const void_mapper_count_t *row = &ctx->grid[(size_t) ctx->y_slots[j] * ctx->stride];
+        void_mapper_coord_t y0 = ctx->y_vector[j] < dirty.position.y ? dirty.position.y : ctx->y_vector[j];
+        void_mapper_coord_t y1 = ctx->y_vector[j + 1] > dy1 ? dy1 : ctx->y_vector[j + 1];
+
+        for (void_mapper_count_t i = i0; i < i1; i++) {
+            if (row[ctx->x_slots[i]] != 0) {
+                continue;
+            }
+
+            if (*n_found == buffer_length) {
+                return false;
+            }
+
+            void_mapper_coord_t x0 = ctx->x_vector[i] < dirty.position.x ? dirty.position.x : ctx->x_vector[i];
+            void_mapper_coord_t x1 = ctx->x_vector[i + 1] > dx1 ? dx1 : ctx->x_vector[i + 1];
+            buffer[(*n_found)++] = (void_mapper_rectangle_t) {
+                .position.x = x0,
+                .position.y = y0,
+                .size.x = x1 - x0,
+                .size.y = y1 - y0
+            };
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,128 @@
+#include <string.h>
+#include "coordinates.h"
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+/**
+ * @brief Stable counting sort of the vector on one byte of the coordinates.
+ *
+ * @param from Coordinates to sort
+ * @param to Destination of the sorted coordinates
+ * @param len Number of elements
+ * @param shift Position of the byte to sort on
+ * @return true if the coordinates were moved to the destination
+ * @return false if all coordinates share the same byte, nothing is moved
+ */
+static bool radix_pass(const void_mapper_coord_t *from, void_mapper_coord_t *to, void_mapper_count_t len, uint8_t shift);
+
+static bool radix_pass(const void_mapper_coord_t *from, void_mapper_coord_t *to, void_mapper_count_t len, uint8_t shift)
+{
+    void_mapper_count_t count[RADIX_SIZE];
+    memset(count, 0, sizeof(count));
+
+    for (void_mapper_count_t i = 0; i < len; i++) {
+        count[(from[i] >> shift) & (RADIX_SIZE - 1)]++;
+    }
+
+    /* All elements in the same bucket means that this pass would not change the order */
+    if (count[(from[0] >> shift) & (RADIX_SIZE - 1)] == len) {
+        return false;
+    }
+
+    /* Turn the counts into the start offset of each bucket */
+    void_mapper_count_t offset = 0;
+    for (uint16_t i = 0; i < RADIX_SIZE; i++) {
+        void_mapper_count_t n = count[i];
+        count[i] = offset;
+        offset += n;
+    }
+
+    for (void_mapper_count_t i = 0; i < len; i++) {
+        to[count[(from[i] >> shift) & (RADIX_SIZE - 1)]++] = from[i];
+    }
+
+    return true;
+}
+
+void coordinates_sort(void_mapper_coord_t *vector, void_mapper_coord_t *scratch, void_mapper_count_t len)
+{
+    if (len < 2) {
+        return;
+    }
+
+    /* Each pass that moves anything swaps the roles of the vector and the scratch */
+    void_mapper_coord_t *from = vector;
+    void_mapper_coord_t *to = scratch;
+    for (uint8_t shift = 0; shift < VOID_MAPPER_COORD_BITS; shift += RADIX_BITS) {
+        if (radix_pass(from, to, len, shift)) {
+            void_mapper_coord_t *swap = from;
+            from = to;
+            to = swap;
+        }
+    }
+
+    if (from != vector) {
+        memcpy(vector, from, len * sizeof(vector[0]));
+    }
+}
+
+void_mapper_count_t coordinates_unique_clamp(void_mapper_coord_t *vector, void_mapper_count_t len, void_mapper_coord_t min, void_mapper_coord_t max)
+{
+    void_mapper_count_t new_length = 0;
+
+    for (void_mapper_count_t i = 0; i < len; i++) {
+        void_mapper_coord_t value = vector[i];
+        if (value < min) {
+            continue;
+        }
+
+        /* The vector is sorted, nothing more to keep */
+        if (value > max) {
+            break;
+        }
+
+        if (new_length > 0 && vector[new_length - 1] == value) {
+            continue;
+        }
+
+        vector[new_length++] = value;
+    }
+
+    return new_length;
+}
+
+void_mapper_count_t coordinates_prepare(void_mapper_coord_t *vector, void_mapper_coord_t *scratch, void_mapper_count_t len,
+                                        void_mapper_coord_t min, void_mapper_coord_t max)
+{
+    coordinates_sort(vector, scratch, len);
+    return coordinates_unique_clamp(vector, len, min, max);
+}
+
+void_mapper_count_t coordinates_lower_bound(const void_mapper_coord_t *vector, void_mapper_count_t len, void_mapper_coord_t value)
+{
+    void_mapper_count_t low = 0;
+    void_mapper_count_t high = len;
+    while (low < high) {
+        void_mapper_count_t middle = low + (high - low) / 2;
+        if (vector[middle] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+bool coordinates_cells(const void_mapper_coord_t *vector, void_mapper_count_t len, void_mapper_coord_t start, void_mapper_coord_t end,
+                       void_mapper_count_t *first, void_mapper_count_t *last)
+{
+    void_mapper_count_t cells = len > 0 ? len - 1 : 0;
+
+    *first = coordinates_lower_bound(vector, len, start);
+    *last = coordinates_lower_bound(vector, len, end);
+    *last = *last > cells ? cells : *last;
+
+    return *first < *last;
+}
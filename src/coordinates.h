@@ -0,0 +1,93 @@
+#ifndef __COORDINATES_H__
+#define __COORDINATES_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "void_mapper_config.h"
+
+/**
+ * @brief Internal coordinate preparation stage of void mapper.
+ *
+ * The grid used by void mapper is built from the edges of the input rectangles. Before
+ * the grid can be used, the edges need to be sorted, made unique and limited to the area.
+ * None of the functions recurse or allocate memory, the caller provides all storage.
+ */
+
+/**
+ * @brief Sort a vector of coordinates in ascending order.
+ * The sort is a non-recursive LSD radix sort doing at most one pass per byte of the
+ * coordinates, i.e. it runs in linear time.
+ *
+ * @param vector Coordinates to sort, sorted in place
+ * @param scratch Temporary storage of at least len elements
+ * @param len Number of elements in the vector
+ */
+void coordinates_sort(void_mapper_coord_t *vector, void_mapper_coord_t *scratch, void_mapper_count_t len);
+
+/**
+ * @brief Remove duplicates and all elements less than min or greater than max from
+ * a sorted vector. This is done in one linear sweep.
+ *
+ * @param vector Sorted coordinates, compacted in place
+ * @param len Number of elements in the vector
+ * @param min Smallest value to keep
+ * @param max Greatest value to keep
+ * @return void_mapper_count_t new length of the vector
+ */
+void_mapper_count_t coordinates_unique_clamp(void_mapper_coord_t *vector, void_mapper_count_t len, void_mapper_coord_t min, void_mapper_coord_t max);
+
+/**
+ * @brief Sort, remove duplicates and limit the coordinates to [min, max].
+ *
+ * @param vector Coordinates to prepare, modified in place
+ * @param scratch Temporary storage of at least len elements
+ * @param len Number of elements in the vector
+ * @param min Smallest value to keep
+ * @param max Greatest value to keep
+ * @return void_mapper_count_t new length of the vector
+ */
+void_mapper_count_t coordinates_prepare(void_mapper_coord_t *vector, void_mapper_coord_t *scratch, void_mapper_count_t len,
+                                        void_mapper_coord_t min, void_mapper_coord_t max);
+
+/**
+ * @brief Find the index of the first element in a sorted vector that is not
+ * less than value. If all elements are less than value, len is returned.
+ *
+ * @param vector Sorted coordinates
+ * @param len Number of elements in the vector
+ * @param value Value to search for
+ * @return void_mapper_count_t index of the first element >= value
+ */
+void_mapper_count_t coordinates_lower_bound(const void_mapper_coord_t *vector, void_mapper_count_t len, void_mapper_coord_t value);
+
+/**
+ * @brief Find the cells of a grid covered by the range [start, end). The cell i of the grid
+ * is [vector[i], vector[i + 1]). All coordinates of the range within the grid must be
+ * part of the vector, so that the range maps exactly on the grid lines.
+ *
+ * @param vector Sorted and unique coordinates of the grid
+ * @param len Number of elements in the vector
+ * @param start Start of the range
+ * @param end End of the range, not included
+ * @param first First cell covered
+ * @param last Cell after the last one covered
+ * @return true if at least one cell is covered
+ * @return false if no cell is covered
+ */
+bool coordinates_cells(const void_mapper_coord_t *vector, void_mapper_count_t len, void_mapper_coord_t start, void_mapper_coord_t end,
+                       void_mapper_count_t *first, void_mapper_count_t *last);
+
+/**
+ * @brief Right or bottom edge of a rectangle. The edge saturates at the largest coordinate
+ * instead of wrapping around when the rectangle reaches past it.
+ *
+ * @param position Left or top edge
+ * @param size Width or height
+ * @return void_mapper_coord_t the edge
+ */
+static inline void_mapper_coord_t coordinates_end(void_mapper_coord_t position, void_mapper_coord_t size)
+{
+    return size > VOID_MAPPER_COORD_MAX - position ? VOID_MAPPER_COORD_MAX : position + size;
+}
+
+#endif /* __COORDINATES_H__ */
@@ -0,0 +1,132 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "grid.h"
+
+typedef struct {
+    const void_mapper_encoder_t *encoder;
+    void_mapper_dma_t *dma;
+    size_t command_size;
+    uint32_t n_skip;
+    uint32_t n_encoded;
+    bool full;
+} encode_t;
+
+/**
+ * @brief Get the value of a field for a void.
+ *
+ * @param field Field
+ * @param rectangle Void
+ * @return uint32_t the value
+ */
+static uint32_t field_value(const void_mapper_field_t *field, const void_mapper_rectangle_t *rectangle);
+
+/**
+ * @brief Write the command of a void at the end of the buffer. Passed to void_mapper_stream().
+ *
+ * @param context The encoding
+ * @param rectangle Void
+ * @return true to continue
+ * @return false if the buffer is full
+ */
+static bool encode_void(void *context, const void_mapper_rectangle_t *rectangle);
+
+static uint32_t field_value(const void_mapper_field_t *field, const void_mapper_rectangle_t *rectangle)
+{
+    switch (field->kind) {
+    case VOID_MAPPER_FIELD_LEFT:
+        return rectangle->position.x;
+    case VOID_MAPPER_FIELD_TOP:
+        return rectangle->position.y;
+    case VOID_MAPPER_FIELD_RIGHT:
+        return (uint32_t) rectangle->position.x + rectangle->size.x - 1;
+    case VOID_MAPPER_FIELD_BOTTOM:
+        return (uint32_t) rectangle->position.y + rectangle->size.y - 1;
+    case VOID_MAPPER_FIELD_WIDTH:
+        return rectangle->size.x;
+    case VOID_MAPPER_FIELD_HEIGHT:
+        return rectangle->size.y;
+    case VOID_MAPPER_FIELD_PIXELS:
+        return (uint32_t) rectangle->size.x * rectangle->size.y;
+    default:
+        return field->value;
+    }
+}
+
+static bool encode_void(void *context, const void_mapper_rectangle_t *rectangle)
+{
+    encode_t *encode = context;
+    if (encode->n_skip > 0) {
+        encode->n_skip--;
+        return true;
+    }
+
+    void_mapper_dma_t *dma = encode->dma;
+    if (dma->size - dma->length < encode->command_size) {
+        encode->full = true;
+        return false;
+    }
+
+    const void_mapper_encoder_t *encoder = encode->encoder;
+    uint8_t *bytes = dma->buffer + dma->length;
+    for (uint8_t f = 0; f < encoder->n_fields; f++) {
+        const void_mapper_field_t *field = &encoder->fields[f];
+        if (field->kind == VOID_MAPPER_FIELD_BYTE) {
+            *bytes++ = field->value;
+            continue;
+        }
+
+        uint32_t value = field_value(field, rectangle);
+        for (uint8_t b = 0; b < field->size; b++) {
+            uint8_t shift = 8 * (encoder->big_endian ? field->size - 1 - b : b);
+            *bytes++ = (uint8_t) (value >> shift);
+        }
+    }
+
+    dma->length += encode->command_size;
+    encode->n_encoded++;
+    return true;
+}
+
+size_t void_mapper_encoded_size(const void_mapper_encoder_t *encoder)
+{
+    size_t size = 0;
+    for (uint8_t f = 0; f < encoder->n_fields; f++) {
+        size += encoder->fields[f].kind == VOID_MAPPER_FIELD_BYTE ? 1 : encoder->fields[f].size;
+    }
+
+    return size;
+}
+
+uint32_t void_mapper_encode(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                            const void_mapper_encoder_t *encoder, void_mapper_dma_t *dma, const void_mapper_workspace_t *workspace)
+{
+    dma->length = 0;
+    dma->done = false;
+
+    for (uint8_t f = 0; f < encoder->n_fields; f++) {
+        if (encoder->fields[f].kind != VOID_MAPPER_FIELD_BYTE && (encoder->fields[f].size == 0 || encoder->fields[f].size > 4)) {
+            return 0;
+        }
+    }
+
+    size_t command_size = void_mapper_encoded_size(encoder);
+    if (dma->buffer == NULL || dma->size < command_size) {
+        return 0;
+    }
+
+    /* The stream finds no void either when everything is covered or when the workspace is too small */
+    grid_t grid;
+    if (input != NULL && input_length > 0 && !grid_init(&grid, workspace, input_length)) {
+        return 0;
+    }
+
+    encode_t encode = { .encoder = encoder, .dma = dma, .command_size = command_size, .n_skip = dma->n_done };
+    void_mapper_stream(area, input, input_length, encode_void, &encode, workspace);
+
+    dma->n_done += encode.n_encoded;
+    dma->done = !encode.full;
+
+    return encode.n_encoded;
+}
@@ -0,0 +1,253 @@
+#include <stdlib.h>
+#include <string.h>
+#include "grid.h"
+#if defined(GRID_AVX2) || defined(GRID_SSE2)
+#include <immintrin.h>
+#endif
+#include "coordinates.h"
+#include "stats.h"
+
+_Static_assert(4 * sizeof(void_mapper_count_t) == VOID_MAPPER_SPAN_SIZE, "VOID_MAPPER_WORKSPACE_SIZE is out of date");
+
+/**
+ * @brief Put the edges of the area and all layers in the vectors. The first and last
+ * element of each vector are the edges of the area.
+ *
+ * @param grid Grid holding the vectors
+ * @param area Area to search
+ * @param layers Layers of input rectangles
+ * @param n_layers Number of layers
+ * @return void_mapper_count_t number of elements in each vector
+ */
+static void_mapper_count_t build_vectors(grid_t *grid, void_mapper_rectangle_t area, const grid_layer_t *layers, uint8_t n_layers);
+
+/**
+ * @brief Translate the rectangles of a layer into spans of cells on the grid. A span covers
+ * the columns [x0, x1) and the rows [y0, y1). Rectangles that do not cover any cell within
+ * the grid are left out.
+ *
+ * @param grid Grid with the vectors prepared
+ * @param layer Layer to translate
+ */
+static void build_spans(grid_t *grid, const grid_layer_t *layer);
+
+/**
+ * @brief Add the weight of the spans [from, to) that cross a row to the difference array of
+ * the row. The spans are tested 16 or 8 at a time with AVX2 or SSE2 when available, and one
+ * at a time otherwise.
+ *
+ * @param grid Built grid
+ * @param from First span
+ * @param to Span after the last one
+ * @param weight Weight of the spans
+ * @param row Row
+ */
+static void add_spans(grid_t *grid, void_mapper_count_t from, void_mapper_count_t to, void_mapper_word_t weight, void_mapper_count_t row);
+
+static void_mapper_count_t build_vectors(grid_t *grid, void_mapper_rectangle_t area, const grid_layer_t *layers, uint8_t n_layers)
+{
+    void_mapper_coord_t *x_vector = grid->x_vector;
+    void_mapper_coord_t *y_vector = grid->y_vector;
+    void_mapper_count_t len = 0;
+
+    x_vector[len] = area.position.x;
+    y_vector[len++] = area.position.y;
+
+    for (uint8_t l = 0; l < n_layers; l++) {
+        const grid_layer_t *layer = &layers[l];
+        if (layer->rectangles == NULL) {
+            /* Separate arrays, the edges are found with plain loops the compiler can vectorize */
+            for (void_mapper_count_t i = 0; i < layer->length; i++) {
+                x_vector[len + 2 * i] = layer->x[i];
+                x_vector[len + 2 * i + 1] = coordinates_end(layer->x[i], layer->width[i]);
+            }
+            for (void_mapper_count_t i = 0; i < layer->length; i++) {
+                y_vector[len + 2 * i] = layer->y[i];
+                y_vector[len + 2 * i + 1] = coordinates_end(layer->y[i], layer->height[i]);
+            }
+            len += 2 * layer->length;
+            continue;
+        }
+
+        const void_mapper_rectangle_t *input = layer->rectangles;
+        for (void_mapper_count_t i = 0; i < layer->length; i++) {
+            x_vector[len] = input[i].position.x;
+            y_vector[len++] = input[i].position.y;
+            x_vector[len] = coordinates_end(input[i].position.x, input[i].size.x);
+            y_vector[len++] = coordinates_end(input[i].position.y, input[i].size.y);
+        }
+    }
+
+    x_vector[len] = coordinates_end(area.position.x, area.size.x);
+    y_vector[len++] = coordinates_end(area.position.y, area.size.y);
+
+    return len;
+}
+
+static void build_spans(grid_t *grid, const grid_layer_t *layer)
+{
+    for (void_mapper_count_t i = 0; i < layer->length; i++) {
+        /* All edges within the area are part of the vectors, so the edges map exactly on grid lines */
+        void_mapper_rectangle_t input = grid_layer_rectangle(layer, i);
+        void_mapper_count_t k = grid->n_spans;
+        if (!coordinates_cells(grid->x_vector, grid->x_len, input.position.x, coordinates_end(input.position.x, input.size.x), &grid->span_x0[k], &grid->span_x1[k]) ||
+            !coordinates_cells(grid->y_vector, grid->y_len, input.position.y, coordinates_end(input.position.y, input.size.y), &grid->span_y0[k], &grid->span_y1[k])) {
+            continue;
+        }
+
+        grid->n_spans++;
+    }
+}
+
+bool grid_init(grid_t *grid, const void_mapper_workspace_t *workspace, void_mapper_count_t capacity)
+{
+#ifdef VOID_MAPPER_DETERMINISTIC
+    if (capacity > VOID_MAPPER_MAX_SPRITES) {
+        return false;
+    }
+#endif
+
+    /* Every edge and the two of the area must be countable */
+    if (capacity > (VOID_MAPPER_COUNT_MAX - 2) / 2 ||
+        workspace == NULL || workspace->memory == NULL ||
+        workspace->size < void_mapper_workspace_size(capacity) ||
+        (uintptr_t) workspace->memory % sizeof(void_mapper_word_t) != 0) {
+        return false;
+    }
+
+    size_t vec_len = (size_t) capacity * 2 + 2;
+    uint8_t *memory = workspace->memory;
+
+    /* Widest types first, keeping every part aligned */
+    grid->coverage = (void_mapper_word_t *) memory;
+    memory += vec_len * sizeof(void_mapper_word_t);
+    grid->scratch = memory;
+    memory += vec_len * VOID_MAPPER_SCRATCH_SIZE;
+    grid->span_x0 = (void_mapper_count_t *) memory;
+    memory += capacity * sizeof(void_mapper_count_t);
+    grid->span_x1 = (void_mapper_count_t *) memory;
+    memory += capacity * sizeof(void_mapper_count_t);
+    grid->span_y0 = (void_mapper_count_t *) memory;
+    memory += capacity * sizeof(void_mapper_count_t);
+    grid->span_y1 = (void_mapper_count_t *) memory;
+    memory += capacity * sizeof(void_mapper_count_t);
+    grid->x_vector = (void_mapper_coord_t *) memory;
+    memory += vec_len * sizeof(void_mapper_coord_t);
+    grid->y_vector = (void_mapper_coord_t *) memory;
+    grid->capacity = capacity;
+
+    return true;
+}
+
+void grid_build(grid_t *grid, void_mapper_rectangle_t area, const grid_layer_t *layers, uint8_t n_layers)
+{
+    // Create, sort and cull vectors
+    STATS_START(sort_start);
+    void_mapper_count_t vec_len = build_vectors(grid, area, layers, n_layers);
+
+    grid->x_len = coordinates_prepare(grid->x_vector, grid->scratch, vec_len, area.position.x, coordinates_end(area.position.x, area.size.x));
+    grid->y_len = coordinates_prepare(grid->y_vector, grid->scratch, vec_len, area.position.y, coordinates_end(area.position.y, area.size.y));
+    STATS_STOP(SORT, sort_start);
+    STATS_SET(x_len, grid->x_len);
+    STATS_SET(y_len, grid->y_len);
+    STATS_ADD(cells, (uint32_t) grid_columns(grid) * grid_rows(grid));
+    STATS_ADD(duplicates, 2 * (uint32_t) vec_len - grid->x_len - grid->y_len);
+
+    // Map the input on the grid, layer by layer
+    STATS_START(grid_start);
+    grid->n_spans = 0;
+    grid->n_layers = n_layers;
+    grid->targeted = false;
+    for (uint8_t l = 0; l < n_layers; l++) {
+        build_spans(grid, &layers[l]);
+        grid->layer_end[l] = grid->n_spans;
+        grid->weight[l] = layers[l].weight;
+        grid->targeted |= layers[l].weight == GRID_TARGET;
+    }
+    STATS_STOP(GRID, grid_start);
+}
+
+static void add_spans(grid_t *grid, void_mapper_count_t from, void_mapper_count_t to, void_mapper_word_t weight, void_mapper_count_t row)
+{
+    void_mapper_word_t *coverage = grid->coverage;
+    size_t k = from;
+
+    /*
+     * A span crosses the row when y0 <= row < y1. Without unsigned comparisons, this is
+     * tested as y0 - row == 0 and row + 1 - y1 == 0 with saturating subtractions. The
+     * mask holds two bits per span that crosses the row.
+     */
+#ifdef GRID_AVX2
+    const __m256i zero_16 = _mm256_setzero_si256();
+    const __m256i row_16 = _mm256_set1_epi16((short) row);
+    const __m256i next_16 = _mm256_set1_epi16((short) (row + 1));
+    for (; k + 16 <= to; k += 16) {
+        __m256i y0 = _mm256_loadu_si256((const __m256i *) &grid->span_y0[k]);
+        __m256i y1 = _mm256_loadu_si256((const __m256i *) &grid->span_y1[k]);
+        __m256i crossing = _mm256_and_si256(_mm256_cmpeq_epi16(_mm256_subs_epu16(y0, row_16), zero_16),
+                                            _mm256_cmpeq_epi16(_mm256_subs_epu16(next_16, y1), zero_16));
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(crossing);
+        while (mask != 0) {
+            size_t s = k + __builtin_ctz(mask) / 2;
+            coverage[grid->span_x0[s]] += weight;
+            coverage[grid->span_x1[s]] -= weight;
+            mask &= mask - 1;
+            mask &= mask - 1;
+        }
+    }
+#endif
+#ifdef GRID_SSE2
+    const __m128i zero_8 = _mm_setzero_si128();
+    const __m128i row_8 = _mm_set1_epi16((short) row);
+    const __m128i next_8 = _mm_set1_epi16((short) (row + 1));
+    for (; k + 8 <= to; k += 8) {
+        __m128i y0 = _mm_loadu_si128((const __m128i *) &grid->span_y0[k]);
+        __m128i y1 = _mm_loadu_si128((const __m128i *) &grid->span_y1[k]);
+        __m128i crossing = _mm_and_si128(_mm_cmpeq_epi16(_mm_subs_epu16(y0, row_8), zero_8),
+                                         _mm_cmpeq_epi16(_mm_subs_epu16(next_8, y1), zero_8));
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(crossing);
+        while (mask != 0) {
+            size_t s = k + __builtin_ctz(mask) / 2;
+            coverage[grid->span_x0[s]] += weight;
+            coverage[grid->span_x1[s]] -= weight;
+            mask &= mask - 1;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; k < to; k++) {
+        if (grid->span_y0[k] <= row && row < grid->span_y1[k]) {
+            coverage[grid->span_x0[k]] += weight;
+            coverage[grid->span_x1[k]] -= weight;
+        }
+    }
+}
+
+void grid_row(grid_t *grid, void_mapper_count_t row)
+{
+    void_mapper_count_t columns = grid_columns(grid);
+    void_mapper_word_t *coverage = grid->coverage;
+
+    // Difference array of the spans crossing the row
+    memset(coverage, 0, (columns + 1) * sizeof(coverage[0]));
+    void_mapper_count_t from = 0;
+    for (uint8_t l = 0; l < grid->n_layers; l++) {
+        add_spans(grid, from, grid->layer_end[l], grid->weight[l], row);
+        from = grid->layer_end[l];
+    }
+
+    // Turn it into the coverage of each cell, unsigned arithmetic wraps back to the right count
+    void_mapper_word_t covered = 0;
+    for (void_mapper_count_t i = 0; i < columns; i++) {
+        covered += coverage[i];
+        coverage[i] = covered;
+    }
+
+#ifdef VOID_MAPPER_STATS
+    STATS_ADD(span_tests, grid->n_spans);
+    for (void_mapper_count_t i = 0; i < columns; i++) {
+        STATS_ADD(culled, !grid_void(grid, i));
+    }
+#endif
+}
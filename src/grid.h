@@ -0,0 +1,170 @@
+#ifndef __GRID_H__
+#define __GRID_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "void_mapper.h"
+
+/**
+ * @brief Internal compressed grid of void mapper.
+ *
+ * The grid lines are the edges of all input rectangles within the area. Each input
+ * rectangle covers a span of whole cells on the grid. The occupancy of the cells is
+ * found one row at a time, so only one row of the grid is held in memory.
+ *
+ * Each input rectangle covers the columns [x0, x1) and the rows [y0, y1) of the grid. The
+ * spans are kept as separate arrays of each edge, so that the test of many spans against
+ * a row maps on vector instructions.
+ *
+ * The input is given as layers of rectangles. Each layer adds its weight to the coverage
+ * of the cells it covers. Blockers are counted in the low half of the coverage and
+ * targets in the high half, each half as wide as a count. A cell is void if no blocker covers it, and, when there
+ * are target layers, if at least one target covers it.
+ */
+
+#define GRID_BLOCKER ((void_mapper_word_t) 1)
+#define GRID_TARGET ((void_mapper_word_t) 1 << VOID_MAPPER_COUNT_BITS)
+#define GRID_MAX_LAYERS 3
+
+/* The row kernel uses the widest vector instructions the target has for 16 bit spans, unless disabled */
+#if !defined(VOID_MAPPER_NO_SIMD) && VOID_MAPPER_COUNT_BITS == 16 && defined(__AVX2__)
+#define GRID_AVX2
+#endif
+#if !defined(VOID_MAPPER_NO_SIMD) && VOID_MAPPER_COUNT_BITS == 16 && defined(__SSE2__)
+#define GRID_SSE2
+#endif
+
+/**
+ * @brief Input rectangles of a layer, either as an array of rectangles, or when rectangles
+ * is NULL, as separate arrays of coordinates and sizes.
+ */
+typedef struct {
+    const void_mapper_rectangle_t *rectangles;
+    const void_mapper_coord_t *x;
+    const void_mapper_coord_t *y;
+    const void_mapper_coord_t *width;
+    const void_mapper_coord_t *height;
+    void_mapper_count_t length;
+    void_mapper_word_t weight;
+} grid_layer_t;
+
+typedef struct {
+    /* Memory, carved from the workspace */
+    void_mapper_word_t *coverage;
+    void_mapper_count_t *span_x0;
+    void_mapper_count_t *span_x1;
+    void_mapper_count_t *span_y0;
+    void_mapper_count_t *span_y1;
+    void_mapper_coord_t *x_vector;
+    void_mapper_coord_t *y_vector;
+    void *scratch;              /* Room for 2 * capacity + 2 coordinates or indices */
+    void_mapper_count_t capacity;
+
+    /* Built grid */
+    void_mapper_count_t x_len;
+    void_mapper_count_t y_len;
+    void_mapper_count_t n_spans;
+    uint8_t n_layers;
+    void_mapper_count_t layer_end[GRID_MAX_LAYERS];
+    void_mapper_word_t weight[GRID_MAX_LAYERS];
+    bool targeted;
+} grid_t;
+
+/**
+ * @brief Split the workspace into the parts used by the grid.
+ *
+ * @param grid Grid to initialize
+ * @param workspace Workspace supplied by the caller
+ * @param capacity Total number of input rectangles the grid is used for
+ * @return true if the workspace is large enough and aligned
+ * @return false if it is not
+ */
+bool grid_init(grid_t *grid, const void_mapper_workspace_t *workspace, void_mapper_count_t capacity);
+
+/**
+ * @brief Build the grid lines and map the input rectangles on the grid.
+ *
+ * @param grid Initialized grid
+ * @param area Area to search
+ * @param layers Layers of input rectangles, at most GRID_MAX_LAYERS
+ * @param n_layers Number of layers, the total number of rectangles must not exceed the capacity
+ */
+void grid_build(grid_t *grid, void_mapper_rectangle_t area, const grid_layer_t *layers, uint8_t n_layers);
+
+/**
+ * @brief Get an input rectangle of a layer, whichever way the layer holds its rectangles.
+ *
+ * @param layer Layer
+ * @param i Index of the rectangle
+ * @return void_mapper_rectangle_t the rectangle
+ */
+static inline void_mapper_rectangle_t grid_layer_rectangle(const grid_layer_t *layer, void_mapper_count_t i)
+{
+    if (layer->rectangles != NULL) {
+        return layer->rectangles[i];
+    }
+
+    return (void_mapper_rectangle_t) {
+        .position = { .x = layer->x[i], .y = layer->y[i] },
+        .size = { .x = layer->width[i], .y = layer->height[i] },
+    };
+}
+
+/**
+ * @brief Number of columns of the built grid.
+ */
+static inline void_mapper_count_t grid_columns(const grid_t *grid)
+{
+    return grid->x_len > 0 ? grid->x_len - 1 : 0;
+}
+
+/**
+ * @brief Number of rows of the built grid.
+ */
+static inline void_mapper_count_t grid_rows(const grid_t *grid)
+{
+    return grid->y_len > 0 ? grid->y_len - 1 : 0;
+}
+
+/**
+ * @brief Find the coverage of every cell of a row. After the call, grid->coverage[i] holds
+ * the coverage of the cell in column i.
+ *
+ * @param grid Built grid
+ * @param row Row to compute
+ */
+void grid_row(grid_t *grid, void_mapper_count_t row);
+
+/**
+ * @brief Check if a cell of the last computed row is void.
+ *
+ * @param grid Built grid
+ * @param column Column of the cell
+ * @return true if the cell is void
+ */
+static inline bool grid_void(const grid_t *grid, void_mapper_count_t column)
+{
+    void_mapper_word_t coverage = grid->coverage[column];
+    return (coverage & (GRID_TARGET - 1)) == 0 && (!grid->targeted || coverage >= GRID_TARGET);
+}
+
+/**
+ * @brief Get the rectangle of the columns [x0, x1) of a row.
+ *
+ * @param grid Built grid
+ * @param x0 First column
+ * @param x1 Column after the last one
+ * @param row Row
+ * @return void_mapper_rectangle_t the rectangle
+ */
+static inline void_mapper_rectangle_t grid_rectangle(const grid_t *grid, void_mapper_count_t x0, void_mapper_count_t x1, void_mapper_count_t row)
+{
+    return (void_mapper_rectangle_t) {
+        .position.x = grid->x_vector[x0],
+        .position.y = grid->y_vector[row],
+        .size.x = grid->x_vector[x1] - grid->x_vector[x0],
+        .size.y = grid->y_vector[row + 1] - grid->y_vector[row]
+    };
+}
+
+#endif /* __GRID_H__ */
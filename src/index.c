@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "coordinates.h"
+
+/**
+ * The buckets are square and laid out row by row over the area. The references of a bucket
+ * are stored together, from starts[b] to starts[b + 1], in the order of the input, so that
+ * the lists are built with one pass to count and one to fill.
+ */
+
+typedef struct {
+    void_mapper_count_t x0;
+    void_mapper_count_t y0;
+    void_mapper_count_t x1;
+    void_mapper_count_t y1;
+} bucket_range_t;
+
+/**
+ * @brief Count the buckets across and down an area.
+ *
+ * @param area Area to search
+ * @param bucket_size Width and height of the buckets, not 0
+ * @param columns For storage of the number of buckets across
+ * @param rows For storage of the number of buckets down
+ * @return true on success
+ * @return false if the number of buckets is not countable
+ */
+static bool count_buckets(void_mapper_rectangle_t area, void_mapper_coord_t bucket_size,
+                          void_mapper_count_t *columns, void_mapper_count_t *rows);
+
+/**
+ * @brief Get the buckets a rectangle crosses.
+ *
+ * @param index Index, with its area and buckets set
+ * @param rectangle Rectangle
+ * @param range For storage of the first and last buckets crossed, both included
+ * @return true if the rectangle crosses the area
+ * @return false if it lies outside of it or is empty
+ */
+static bool bucket_range(const void_mapper_index_t *index, void_mapper_rectangle_t rectangle, bucket_range_t *range);
+
+static bool count_buckets(void_mapper_rectangle_t area, void_mapper_coord_t bucket_size,
+                          void_mapper_count_t *columns, void_mapper_count_t *rows)
+{
+    uint64_t across = ((uint64_t) area.size.x + bucket_size - 1) / bucket_size;
+    uint64_t down = ((uint64_t) area.size.y + bucket_size - 1) / bucket_size;
+    if (across == 0 || down == 0 || across * down > VOID_MAPPER_COUNT_MAX) {
+        return false;
+    }
+
+    *columns = across;
+    *rows = down;
+    return true;
+}
+
+static bool bucket_range(const void_mapper_index_t *index, void_mapper_rectangle_t rectangle, bucket_range_t *range)
+{
+    uint64_t ax = index->area.position.x;
+    uint64_t ay = index->area.position.y;
+    uint64_t x0 = rectangle.position.x > ax ? rectangle.position.x : ax;
+    uint64_t y0 = rectangle.position.y > ay ? rectangle.position.y : ay;
+    uint64_t x1 = (uint64_t) rectangle.position.x + rectangle.size.x;
+    uint64_t y1 = (uint64_t) rectangle.position.y + rectangle.size.y;
+    x1 = x1 < ax + index->area.size.x ? x1 : ax + index->area.size.x;
+    y1 = y1 < ay + index->area.size.y ? y1 : ay + index->area.size.y;
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+
+    range->x0 = (x0 - ax) / index->bucket_size;
+    range->y0 = (y0 - ay) / index->bucket_size;
+    range->x1 = (x1 - 1 - ax) / index->bucket_size;
+    range->y1 = (y1 - 1 - ay) / index->bucket_size;
+    return true;
+}
+
+size_t void_mapper_index_size(void_mapper_rectangle_t area, void_mapper_coord_t bucket_size, uint32_t max_refs)
+{
+    void_mapper_count_t columns;
+    void_mapper_count_t rows;
+    if (bucket_size == 0 || !count_buckets(area, bucket_size, &columns, &rows)) {
+        return 0;
+    }
+
+    return VOID_MAPPER_INDEX_SIZE((size_t) columns * rows, max_refs);
+}
+
+bool void_mapper_index_build(void_mapper_index_t *index, void_mapper_rectangle_t area,
+                             const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                             void_mapper_coord_t bucket_size, void *memory, size_t size)
+{
+    void_mapper_count_t columns;
+    void_mapper_count_t rows;
+    if (index == NULL || memory == NULL || bucket_size == 0 || !count_buckets(area, bucket_size, &columns, &rows) ||
+        size < VOID_MAPPER_INDEX_SIZE((size_t) columns * rows, 0) || (uintptr_t) memory % sizeof(uint32_t) != 0) {
+        return false;
+    }
+
+    size_t n_buckets = (size_t) columns * rows;
+    size_t max_refs = (size - VOID_MAPPER_INDEX_SIZE(n_buckets, 0)) / sizeof(void_mapper_count_t);
+    *index = (void_mapper_index_t) {
+        .area = area,
+        .bucket_size = bucket_size,
+        .columns = columns,
+        .rows = rows,
+        .starts = memory,
+        .refs = (void_mapper_count_t *) ((uint32_t *) memory + n_buckets + 1),
+    };
+
+    uint32_t *starts = index->starts;
+    memset(starts, 0, (n_buckets + 1) * sizeof(uint32_t));
+    input_length = input == NULL ? 0 : input_length;
+
+    /* Count the references of each bucket, then turn the counts into the first slot of each list */
+    uint64_t n_refs = 0;
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        bucket_range_t range;
+        if (!bucket_range(index, input[i], &range)) {
+            continue;
+        }
+
+        for (void_mapper_count_t by = range.y0; by <= range.y1; by++) {
+            for (void_mapper_count_t bx = range.x0; bx <= range.x1; bx++) {
+                starts[(size_t) by * columns + bx]++;
+            }
+        }
+        n_refs += (uint64_t) (range.x1 - range.x0 + 1) * (range.y1 - range.y0 + 1);
+        if (n_refs > max_refs) {
+            return false;
+        }
+    }
+
+    uint32_t first = 0;
+    for (size_t b = 0; b < n_buckets; b++) {
+        uint32_t count = starts[b];
+        index->max_bucket = count > index->max_bucket ? count : index->max_bucket;
+        starts[b] = first;
+        first += count;
+    }
+
+    /* Fill the lists, each start moves on to the end of its list, which is the start of the next */
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        bucket_range_t range;
+        if (!bucket_range(index, input[i], &range)) {
+            continue;
+        }
+
+        for (void_mapper_count_t by = range.y0; by <= range.y1; by++) {
+            for (void_mapper_count_t bx = range.x0; bx <= range.x1; bx++) {
+                index->refs[starts[(size_t) by * columns + bx]++] = i;
+            }
+        }
+    }
+
+    memmove(starts + 1, starts, n_buckets * sizeof(uint32_t));
+    starts[0] = 0;
+
+    return true;
+}
+
+uint32_t void_mapper_index_find(const void_mapper_index_t *index, const void_mapper_rectangle_t *input, void_mapper_rectangle_t region,
+                                void_mapper_count_t *found, void_mapper_count_t found_length)
+{
+    bucket_range_t query;
+    if (index == NULL || input == NULL || !bucket_range(index, region, &query)) {
+        return 0;
+    }
+
+    uint64_t qx1 = (uint64_t) region.position.x + region.size.x;
+    uint64_t qy1 = (uint64_t) region.position.y + region.size.y;
+
+    uint32_t n_found = 0;
+    for (void_mapper_count_t by = query.y0; by <= query.y1; by++) {
+        for (void_mapper_count_t bx = query.x0; bx <= query.x1; bx++) {
+            size_t b = (size_t) by * index->columns + bx;
+            for (uint32_t r = index->starts[b]; r < index->starts[b + 1]; r++) {
+                void_mapper_count_t i = index->refs[r];
+                const void_mapper_rectangle_t *rectangle = &input[i];
+                if (rectangle->position.x >= qx1 || rectangle->position.y >= qy1 ||
+                    coordinates_end(rectangle->position.x, rectangle->size.x) <= region.position.x ||
+                    coordinates_end(rectangle->position.y, rectangle->size.y) <= region.position.y) {
+                    continue;
+                }
+
+                /* A rectangle is listed in every bucket it crosses, only the first one shared with the region reports it */
+                bucket_range_t range;
+                bucket_range(index, *rectangle, &range);
+                if (bx != (range.x0 > query.x0 ? range.x0 : query.x0) || by != (range.y0 > query.y0 ? range.y0 : query.y0)) {
+                    continue;
+                }
+
+                if (found != NULL && n_found < found_length) {
+                    found[n_found] = i;
+                }
+                n_found++;
+            }
+        }
+    }
+
+    return n_found;
+}
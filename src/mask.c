@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "stats.h"
+
+/**
+ * The mask is scanned one row at a time, 64 pixels at a time. The void pixels of a word
+ * are its clear bits, and the runs of void are found by jumping from one change to the
+ * next with a count of trailing zeros, so a word costs one step per run rather than one
+ * per pixel. As in void_mapper_grouped(), a run extends the rectangle right above it when
+ * both span the same columns, and the rectangles of the row above are tracked by index.
+ */
+
+#define WORD_BITS 64
+
+typedef struct {
+    void_mapper_rectangle_t *buffer;
+    void_mapper_count_t buffer_length;
+    void_mapper_count_t n_found;
+
+    /* Memory, carved from the workspace */
+    void_mapper_count_t *above;
+    void_mapper_count_t *current;
+
+    void_mapper_count_t n_above;
+    void_mapper_count_t n_current;
+    void_mapper_count_t k;
+} mask_t;
+
+/**
+ * @brief Count the trailing zeros of a word that is not 0.
+ *
+ * @param word Word
+ * @return unsigned int index of the lowest set bit
+ */
+static inline unsigned int trailing_zeros(uint64_t word);
+
+/**
+ * @brief Get the void pixels of up to 64 pixels of a row, one bit per pixel with the first
+ * one in the lowest bit. Bytes past the width are not read, and their pixels are not void.
+ *
+ * @param row First byte of the row
+ * @param x First pixel, a multiple of 64
+ * @param width Width of the mask
+ * @return uint64_t the void pixels
+ */
+static uint64_t void_bits(const uint8_t *row, size_t x, void_mapper_coord_t width);
+
+/**
+ * @brief Add a run of void of the current row: extend the rectangle right above it if it
+ * spans the same columns, or else start a new rectangle.
+ *
+ * @param mask Scan
+ * @param x0 First pixel of the run
+ * @param x1 Pixel after the last one
+ * @param y Row
+ * @return true on success
+ * @return false if the buffer is full
+ */
+static bool add_run(mask_t *mask, size_t x0, size_t x1, void_mapper_coord_t y);
+
+static inline unsigned int trailing_zeros(uint64_t word)
+{
+#if defined(__GNUC__)
+    return (unsigned int) __builtin_ctzll(word);
+#else
+    unsigned int n = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static uint64_t void_bits(const uint8_t *row, size_t x, void_mapper_coord_t width)
+{
+    size_t n_bits = width - x < WORD_BITS ? width - x : WORD_BITS;
+    size_t n_bytes = (n_bits + 7) / 8;
+    const uint8_t *bytes = row + x / 8;
+
+    uint64_t word = 0;
+    if (n_bytes == 8) {
+        /* Written out, compilers turn this into a single load on little endian targets */
+        word = (uint64_t) bytes[0] | (uint64_t) bytes[1] << 8 | (uint64_t) bytes[2] << 16 | (uint64_t) bytes[3] << 24 |
+               (uint64_t) bytes[4] << 32 | (uint64_t) bytes[5] << 40 | (uint64_t) bytes[6] << 48 | (uint64_t) bytes[7] << 56;
+    } else {
+        for (size_t b = 0; b < n_bytes; b++) {
+            word |= (uint64_t) bytes[b] << (8 * b);
+        }
+    }
+
+    uint64_t valid = n_bits == WORD_BITS ? UINT64_MAX : ((uint64_t) 1 << n_bits) - 1;
+    return ~word & valid;
+}
+
+static bool add_run(mask_t *mask, size_t x0, size_t x1, void_mapper_coord_t y)
+{
+    /* Both rows are ordered from left to right, skip the rectangles above that end before this run */
+    while (mask->k < mask->n_above && mask->buffer[mask->above[mask->k]].position.x < x0) {
+        mask->k++;
+    }
+
+    if (mask->k < mask->n_above) {
+        void_mapper_rectangle_t *match = &mask->buffer[mask->above[mask->k]];
+        if (match->position.x == x0 && match->size.x == x1 - x0) {
+            match->size.y++;
+            mask->current[mask->n_current++] = mask->above[mask->k++];
+            return true;
+        }
+    }
+
+    if (mask->n_found == mask->buffer_length) {
+        return false;
+    }
+
+    mask->buffer[mask->n_found] = (void_mapper_rectangle_t) {
+        .position = { .x = x0, .y = y },
+        .size = { .x = x1 - x0, .y = 1 },
+    };
+    mask->current[mask->n_current++] = mask->n_found++;
+    return true;
+}
+
+size_t void_mapper_mask_workspace_size(void_mapper_coord_t width)
+{
+    return VOID_MAPPER_MASK_WORKSPACE_SIZE(width);
+}
+
+void_mapper_count_t void_mapper_mask(const uint8_t *pixels, size_t stride, void_mapper_coord_t width, void_mapper_coord_t height,
+                                     void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                     const void_mapper_workspace_t *workspace)
+{
+    if (buffer == NULL || buffer_length == 0 || width == 0 || height == 0) {
+        return 0;
+    }
+
+    if (pixels == NULL) {
+        buffer[0] = (void_mapper_rectangle_t) { .size = { .x = width, .y = height } };
+        return 1;
+    }
+
+    if (stride < ((size_t) width + 7) / 8 || (size_t) width / 2 + 1 > VOID_MAPPER_COUNT_MAX ||
+        workspace == NULL || workspace->memory == NULL || workspace->size < void_mapper_mask_workspace_size(width) ||
+        (uintptr_t) workspace->memory % sizeof(void_mapper_word_t) != 0) {
+        return 0;
+    }
+
+    /* A row has at most one run of void every other pixel */
+    mask_t mask = { .buffer = buffer, .buffer_length = buffer_length };
+    mask.above = workspace->memory;
+    mask.current = mask.above + width / 2 + 1;
+
+    STATS_START(cull_start);
+    for (void_mapper_coord_t y = 0; y < height; y++) {
+        const uint8_t *row = pixels + (size_t) y * stride;
+        mask.n_current = 0;
+        mask.k = 0;
+
+        bool in_run = false;
+        size_t start = 0;
+        for (size_t x = 0; x < width; x += WORD_BITS) {
+            uint64_t bits = void_bits(row, x, width);
+
+            /* Jump from one change to the next: the next void pixel, or the next covered one */
+            unsigned int bit = 0;
+            while (bit < WORD_BITS) {
+                uint64_t changes = (in_run ? ~bits : bits) >> bit;
+                if (changes == 0) {
+                    break;
+                }
+
+                bit += trailing_zeros(changes);
+                if (in_run && !add_run(&mask, start, x + bit, y)) {
+                    return 0;
+                }
+                start = x + bit;
+                in_run = !in_run;
+            }
+        }
+
+        if (in_run && !add_run(&mask, start, width, y)) {
+            return 0;
+        }
+
+        void_mapper_count_t *swap = mask.above;
+        mask.above = mask.current;
+        mask.current = swap;
+        mask.n_above = mask.n_current;
+    }
+    STATS_STOP(CULL, cull_start);
+
+    return mask.n_found;
+}
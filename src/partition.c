@@ -0,0 +1,541 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "grid.h"
+#include "stats.h"
+
+/**
+ * The void is partitioned on the compressed grid using the classic construction for a
+ * minimum partition of a rectilinear polygon into rectangles:
+ *
+ * 1. Find the concave corners of the void. A corner is concave when three of the four
+ *    cells around a grid vertex are void.
+ * 2. Find the "good" chords, i.e. straight lines through the void joining two concave
+ *    corners. Horizontal and vertical good chords form a bipartite graph where the edges
+ *    are the chords that intersect.
+ * 3. Cut along a maximum set of non-intersecting good chords. The set is the complement of
+ *    a minimum vertex cover, found from a maximum matching (König's theorem).
+ * 4. Cut from each remaining concave corner until the cut meets the boundary or another cut.
+ *
+ * Each cut resolves the concave corners at its ends, so the result holds the least
+ * number of rectangles possible. There are at most 4 concave corners per input rectangle,
+ * hence at most 2 good chords of each orientation per input rectangle.
+ */
+
+#define NONE VOID_MAPPER_COUNT_MAX
+
+/* Cell state bits */
+#define CELL_VOID       (1 << 0)
+#define CELL_CUT_LEFT   (1 << 1)
+#define CELL_CUT_TOP    (1 << 2)
+#define CELL_DONE       (1 << 3)
+
+typedef struct {
+    void_mapper_count_t i;
+    void_mapper_count_t j;
+    int8_t dx;
+    int8_t dy;
+    uint8_t resolved;
+    uint8_t reserved;
+} corner_t;
+
+typedef struct {
+    void_mapper_count_t line;
+    void_mapper_count_t from;
+    void_mapper_count_t to;
+    void_mapper_count_t a;
+    void_mapper_count_t b;
+    void_mapper_count_t reserved;
+} chord_t;
+
+_Static_assert(sizeof(corner_t) == VOID_MAPPER_CORNER_SIZE, "VOID_MAPPER_PARTITION_WORKSPACE_SIZE is out of date");
+_Static_assert(sizeof(chord_t) == VOID_MAPPER_CHORD_SIZE, "VOID_MAPPER_PARTITION_WORKSPACE_SIZE is out of date");
+
+typedef struct {
+    grid_t grid;
+    void_mapper_count_t max_corners;
+    void_mapper_count_t columns;
+    void_mapper_count_t rows;
+    uint8_t *cells;
+    corner_t *corners;
+    void_mapper_count_t n_corners;
+    chord_t *horizontal;
+    void_mapper_count_t n_horizontal;
+    chord_t *vertical;
+    void_mapper_count_t n_vertical;
+    void_mapper_count_t *match_h;
+    void_mapper_count_t *match_v;
+    void_mapper_count_t *queue;
+    void_mapper_count_t *parent;
+    uint8_t *visited_h;
+    uint8_t *visited_v;
+} partition_t;
+
+/**
+ * @brief Split the workspace into the parts used by the partition.
+ *
+ * @param partition Partition to initialize
+ * @param workspace Workspace supplied by the caller
+ * @param input_length Number of input rectangles
+ * @return true if the workspace is large enough and aligned
+ * @return false if it is not
+ */
+static bool partition_init(partition_t *partition, const void_mapper_workspace_t *workspace, void_mapper_count_t input_length);
+
+/**
+ * @brief Follow a grid line from a vertex through the void, until the line meets the
+ * boundary of the void or a cut.
+ *
+ * @param p Partition
+ * @param i Column of the start vertex
+ * @param j Row of the start vertex
+ * @param dx Horizontal direction, -1, 0 or 1
+ * @param dy Vertical direction, -1, 0 or 1
+ * @return void_mapper_count_t the coordinate along the line of the vertex where it stops
+ */
+static void_mapper_count_t trace(const partition_t *p, void_mapper_count_t i, void_mapper_count_t j, int8_t dx, int8_t dy);
+
+/**
+ * @brief Find a maximum matching between the horizontal and vertical good chords.
+ *
+ * @param p Partition with the good chords found
+ */
+static void match_chords(partition_t *p);
+
+/**
+ * @brief Find a maximum set of non-intersecting good chords and cut along them. The set
+ * is made of the chords reachable by alternating paths from unmatched horizontal chords,
+ * and the vertical chords that are not.
+ *
+ * @param p Partition with the chords matched
+ */
+static void cut_independent_chords(partition_t *p);
+
+static inline bool cell_void(const partition_t *p, int32_t i, int32_t j)
+{
+    if (i < 0 || j < 0 || (uint32_t) i >= p->columns || (uint32_t) j >= p->rows) {
+        return false;
+    }
+
+    return p->cells[(size_t) j * p->columns + i] & CELL_VOID;
+}
+
+static inline uint8_t *cell(const partition_t *p, void_mapper_count_t i, void_mapper_count_t j)
+{
+    return &p->cells[(size_t) j * p->columns + i];
+}
+
+/* The vertical edge on grid line i within row j is inside the void and not cut */
+static bool open_vertical(const partition_t *p, int32_t i, int32_t j)
+{
+    return cell_void(p, i - 1, j) && cell_void(p, i, j) && !(*cell(p, i, j) & CELL_CUT_LEFT);
+}
+
+/* The horizontal edge on grid line j within column i is inside the void and not cut */
+static bool open_horizontal(const partition_t *p, int32_t i, int32_t j)
+{
+    return cell_void(p, i, j - 1) && cell_void(p, i, j) && !(*cell(p, i, j) & CELL_CUT_TOP);
+}
+
+static bool intersect(const chord_t *horizontal, const chord_t *vertical)
+{
+    return horizontal->from <= vertical->line && vertical->line <= horizontal->to &&
+           vertical->from <= horizontal->line && horizontal->line <= vertical->to;
+}
+
+static bool partition_init(partition_t *p, const void_mapper_workspace_t *workspace, void_mapper_count_t input_length)
+{
+    if (workspace == NULL || workspace->memory == NULL ||
+        workspace->size < void_mapper_partition_workspace_size(input_length) ||
+        (uintptr_t) workspace->memory % sizeof(void_mapper_word_t) != 0) {
+        return false;
+    }
+
+    size_t grid_size = void_mapper_workspace_size(input_length);
+    size_t n_corners = (size_t) input_length * 4;
+    size_t n_chords = (size_t) input_length * 2;
+    uint8_t *memory = workspace->memory;
+
+    void_mapper_workspace_t grid_workspace = { .memory = memory, .size = grid_size };
+    if (!grid_init(&p->grid, &grid_workspace, input_length)) {
+        return false;
+    }
+    memory += grid_size;
+
+    p->corners = (corner_t *) memory;
+    p->max_corners = n_corners > VOID_MAPPER_COUNT_MAX ? VOID_MAPPER_COUNT_MAX : n_corners;
+    memory += n_corners * sizeof(corner_t);
+    p->horizontal = (chord_t *) memory;
+    memory += n_chords * sizeof(chord_t);
+    p->vertical = (chord_t *) memory;
+    memory += n_chords * sizeof(chord_t);
+    p->match_h = (void_mapper_count_t *) memory;
+    memory += n_chords * sizeof(void_mapper_count_t);
+    p->match_v = (void_mapper_count_t *) memory;
+    memory += n_chords * sizeof(void_mapper_count_t);
+    p->queue = (void_mapper_count_t *) memory;
+    memory += n_chords * sizeof(void_mapper_count_t);
+    p->parent = (void_mapper_count_t *) memory;
+    memory += n_chords * sizeof(void_mapper_count_t);
+    p->visited_h = memory;
+    memory += n_chords;
+    p->visited_v = memory;
+    memory += n_chords;
+    p->cells = memory;
+
+    return true;
+}
+
+static void find_cells(partition_t *p)
+{
+    grid_t *grid = &p->grid;
+    p->columns = grid_columns(grid);
+    p->rows = grid_rows(grid);
+
+    for (void_mapper_count_t j = 0; j < p->rows; j++) {
+        grid_row(grid, j);
+        for (void_mapper_count_t i = 0; i < p->columns; i++) {
+            *cell(p, i, j) = grid_void(grid, i) ? CELL_VOID : 0;
+        }
+    }
+}
+
+static void find_corners(partition_t *p)
+{
+    p->n_corners = 0;
+
+    /* Vertices on the edge of the area have outside cells around them, so they are never concave */
+    for (void_mapper_count_t j = 1; j < p->rows; j++) {
+        for (void_mapper_count_t i = 1; i < p->columns; i++) {
+            bool nw = cell_void(p, i - 1, j - 1);
+            bool ne = cell_void(p, i, j - 1);
+            bool sw = cell_void(p, i - 1, j);
+            bool se = cell_void(p, i, j);
+            if (nw + ne + sw + se != 3) {
+                continue;
+            }
+
+            /* Can only happen with invalid input, the rest of the corners are left uncut */
+            if (p->n_corners == p->max_corners) {
+                return;
+            }
+
+            /* The chords go away from the cell that is not void */
+            p->corners[p->n_corners++] = (corner_t) {
+                .i = i,
+                .j = j,
+                .dx = (!ne || !se) ? -1 : 1,
+                .dy = (!nw || !ne) ? 1 : -1,
+            };
+        }
+    }
+}
+
+static void_mapper_count_t find_corner(const partition_t *p, void_mapper_count_t i, void_mapper_count_t j)
+{
+    /* The corners are found in raster order */
+    void_mapper_count_t low = 0;
+    void_mapper_count_t high = p->n_corners;
+    void_mapper_word_t key = ((void_mapper_word_t) j << VOID_MAPPER_COUNT_BITS) | i;
+    while (low < high) {
+        void_mapper_count_t middle = low + (high - low) / 2;
+        void_mapper_word_t current = ((void_mapper_word_t) p->corners[middle].j << VOID_MAPPER_COUNT_BITS) | p->corners[middle].i;
+        if (current < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low < p->n_corners && p->corners[low].i == i && p->corners[low].j == j) {
+        return low;
+    }
+
+    return NONE;
+}
+
+static void_mapper_count_t trace(const partition_t *p, void_mapper_count_t i, void_mapper_count_t j, int8_t dx, int8_t dy)
+{
+    int32_t x = i;
+    int32_t y = j;
+
+    while (true) {
+        /* Step along the edge, if it is open */
+        if (dx != 0) {
+            int32_t column = dx > 0 ? x : x - 1;
+            if (!open_horizontal(p, column, y)) {
+                break;
+            }
+            x += dx;
+
+            /* Stop at a vertex where any vertical edge is closed */
+            if (!open_vertical(p, x, y - 1) || !open_vertical(p, x, y)) {
+                break;
+            }
+        } else {
+            int32_t row = dy > 0 ? y : y - 1;
+            if (!open_vertical(p, x, row)) {
+                break;
+            }
+            y += dy;
+
+            if (!open_horizontal(p, x - 1, y) || !open_horizontal(p, x, y)) {
+                break;
+            }
+        }
+    }
+
+    return dx != 0 ? x : y;
+}
+
+static void find_chords(partition_t *p)
+{
+    p->n_horizontal = 0;
+    p->n_vertical = 0;
+
+    for (void_mapper_count_t k = 0; k < p->n_corners; k++) {
+        const corner_t *corner = &p->corners[k];
+
+        /* Only look to the right and down, each chord is found once */
+        if (corner->dx > 0) {
+            void_mapper_count_t end = trace(p, corner->i, corner->j, 1, 0);
+            void_mapper_count_t other = find_corner(p, end, corner->j);
+            if (other != NONE && p->corners[other].dx < 0) {
+                p->horizontal[p->n_horizontal++] = (chord_t) {
+                    .line = corner->j, .from = corner->i, .to = end, .a = k, .b = other
+                };
+            }
+        }
+
+        if (corner->dy > 0) {
+            void_mapper_count_t end = trace(p, corner->i, corner->j, 0, 1);
+            void_mapper_count_t other = find_corner(p, corner->i, end);
+            if (other != NONE && p->corners[other].dy < 0) {
+                p->vertical[p->n_vertical++] = (chord_t) {
+                    .line = corner->i, .from = corner->j, .to = end, .a = k, .b = other
+                };
+            }
+        }
+    }
+}
+
+static bool augment(partition_t *p, void_mapper_count_t root)
+{
+    /* Breadth first search for an augmenting path, without recursion */
+    memset(p->visited_v, 0, p->n_vertical);
+    void_mapper_count_t head = 0;
+    void_mapper_count_t tail = 0;
+    p->queue[tail++] = root;
+
+    while (head < tail) {
+        void_mapper_count_t h = p->queue[head++];
+        for (void_mapper_count_t v = 0; v < p->n_vertical; v++) {
+            if (p->visited_v[v] || !intersect(&p->horizontal[h], &p->vertical[v])) {
+                continue;
+            }
+
+            p->visited_v[v] = 1;
+            p->parent[v] = h;
+
+            if (p->match_v[v] != NONE) {
+                p->queue[tail++] = p->match_v[v];
+                continue;
+            }
+
+            /* Flip the matching along the path back to the root */
+            while (v != NONE) {
+                void_mapper_count_t u = p->parent[v];
+                void_mapper_count_t next = p->match_h[u];
+                p->match_h[u] = v;
+                p->match_v[v] = u;
+                v = next;
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void match_chords(partition_t *p)
+{
+    memset(p->match_h, 0xFF, p->n_horizontal * sizeof(p->match_h[0]));
+    memset(p->match_v, 0xFF, p->n_vertical * sizeof(p->match_v[0]));
+
+    for (void_mapper_count_t h = 0; h < p->n_horizontal; h++) {
+        augment(p, h);
+    }
+}
+
+static void cut(partition_t *p, const chord_t *chord, bool horizontal)
+{
+    for (void_mapper_count_t k = chord->from; k < chord->to; k++) {
+        if (horizontal) {
+            *cell(p, k, chord->line) |= CELL_CUT_TOP;
+        } else {
+            *cell(p, chord->line, k) |= CELL_CUT_LEFT;
+        }
+    }
+
+    p->corners[chord->a].resolved = 1;
+    p->corners[chord->b].resolved = 1;
+}
+
+static void cut_independent_chords(partition_t *p)
+{
+    memset(p->visited_h, 0, p->n_horizontal);
+    memset(p->visited_v, 0, p->n_vertical);
+
+    /* Alternating paths from the unmatched horizontal chords */
+    void_mapper_count_t head = 0;
+    void_mapper_count_t tail = 0;
+    for (void_mapper_count_t h = 0; h < p->n_horizontal; h++) {
+        if (p->match_h[h] == NONE) {
+            p->visited_h[h] = 1;
+            p->queue[tail++] = h;
+        }
+    }
+
+    while (head < tail) {
+        void_mapper_count_t h = p->queue[head++];
+        for (void_mapper_count_t v = 0; v < p->n_vertical; v++) {
+            if (p->visited_v[v] || p->match_h[h] == v || !intersect(&p->horizontal[h], &p->vertical[v])) {
+                continue;
+            }
+
+            p->visited_v[v] = 1;
+            void_mapper_count_t next = p->match_v[v];
+            if (next != NONE && !p->visited_h[next]) {
+                p->visited_h[next] = 1;
+                p->queue[tail++] = next;
+            }
+        }
+    }
+
+    for (void_mapper_count_t h = 0; h < p->n_horizontal; h++) {
+        if (p->visited_h[h]) {
+            cut(p, &p->horizontal[h], true);
+        }
+    }
+
+    for (void_mapper_count_t v = 0; v < p->n_vertical; v++) {
+        if (!p->visited_v[v]) {
+            cut(p, &p->vertical[v], false);
+        }
+    }
+}
+
+static void cut_remaining_corners(partition_t *p)
+{
+    for (void_mapper_count_t k = 0; k < p->n_corners; k++) {
+        corner_t *corner = &p->corners[k];
+        if (corner->resolved) {
+            continue;
+        }
+
+        void_mapper_count_t end = trace(p, corner->i, corner->j, 0, corner->dy);
+        chord_t chord = {
+            .line = corner->i,
+            .from = corner->dy > 0 ? corner->j : end,
+            .to = corner->dy > 0 ? end : corner->j,
+            .a = k,
+            .b = k,
+        };
+        cut(p, &chord, false);
+    }
+}
+
+static bool collect_rectangles(partition_t *p, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length, void_mapper_count_t *n_found)
+{
+    *n_found = 0;
+
+    for (void_mapper_count_t j = 0; j < p->rows; j++) {
+        for (void_mapper_count_t i = 0; i < p->columns; i++) {
+            if (!(*cell(p, i, j) & CELL_VOID) || (*cell(p, i, j) & CELL_DONE)) {
+                continue;
+            }
+
+            /* Each piece is a rectangle, extend to the right and then down until a cut */
+            void_mapper_count_t x1 = i + 1;
+            while (x1 < p->columns && (*cell(p, x1, j) & (CELL_VOID | CELL_DONE | CELL_CUT_LEFT)) == CELL_VOID) {
+                x1++;
+            }
+
+            void_mapper_count_t y1 = j + 1;
+            while (y1 < p->rows) {
+                bool open = true;
+                for (void_mapper_count_t x = i; x < x1 && open; x++) {
+                    open = (*cell(p, x, y1) & (CELL_VOID | CELL_DONE | CELL_CUT_TOP)) == CELL_VOID;
+                }
+                if (!open) {
+                    break;
+                }
+                y1++;
+            }
+
+            for (void_mapper_count_t y = j; y < y1; y++) {
+                for (void_mapper_count_t x = i; x < x1; x++) {
+                    *cell(p, x, y) |= CELL_DONE;
+                }
+            }
+
+            if (*n_found == buffer_length) {
+                return false;
+            }
+
+            buffer[(*n_found)++] = (void_mapper_rectangle_t) {
+                .position.x = p->grid.x_vector[i],
+                .position.y = p->grid.y_vector[j],
+                .size.x = p->grid.x_vector[x1] - p->grid.x_vector[i],
+                .size.y = p->grid.y_vector[y1] - p->grid.y_vector[j]
+            };
+        }
+    }
+
+    return true;
+}
+
+size_t void_mapper_partition_workspace_size(void_mapper_count_t input_length)
+{
+    return VOID_MAPPER_PARTITION_WORKSPACE_SIZE(input_length);
+}
+
+void_mapper_count_t void_mapper_partition(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                          void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                          const void_mapper_workspace_t *workspace)
+{
+    if (buffer == NULL || buffer_length == 0) {
+        return 0;
+    }
+
+    if (input == NULL || input_length == 0) {
+        buffer[0] = area;
+        return 1;
+    }
+
+    partition_t p;
+    if (!partition_init(&p, workspace, input_length)) {
+        return 0;
+    }
+
+    grid_layer_t layer = { .rectangles = input, .length = input_length, .weight = GRID_BLOCKER };
+    grid_build(&p.grid, area, &layer, 1);
+
+    STATS_START(cull_start);
+    find_cells(&p);
+    STATS_STOP(CULL, cull_start);
+    find_corners(&p);
+    find_chords(&p);
+    match_chords(&p);
+    cut_independent_chords(&p);
+    cut_remaining_corners(&p);
+
+    void_mapper_count_t n_found;
+    if (!collect_rectangles(&p, buffer, buffer_length, &n_found)) {
+        return 0;
+    }
+
+    return n_found;
+}
@@ -0,0 +1,14 @@
+#include "stats.h"
+
+#ifdef VOID_MAPPER_STATS
+
+void_mapper_stats_t *stats_sink;
+void_mapper_clock_t stats_clock;
+
+void void_mapper_stats_hook(void_mapper_stats_t *stats, void_mapper_clock_t clock)
+{
+    stats_sink = stats;
+    stats_clock = clock;
+}
+
+#endif /* VOID_MAPPER_STATS */
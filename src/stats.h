@@ -0,0 +1,44 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <stdint.h>
+#include "void_mapper.h"
+
+/**
+ * @brief Internal statistics of void mapper. With VOID_MAPPER_STATS defined, the macros
+ * below update the structure given to void_mapper_stats_hook(). Without it, they compile
+ * to nothing and the library carries no trace of the statistics.
+ */
+
+#ifdef VOID_MAPPER_STATS
+
+extern void_mapper_stats_t *stats_sink;
+extern void_mapper_clock_t stats_clock;
+
+static inline uint32_t stats_now(void)
+{
+    return stats_clock != NULL ? stats_clock() : 0;
+}
+
+static inline void stats_elapsed(void_mapper_phase_t phase, uint32_t start)
+{
+    if (stats_sink != NULL && stats_clock != NULL) {
+        stats_sink->ticks[phase] += stats_clock() - start;
+    }
+}
+
+#define STATS_ADD(field, n) do { if (stats_sink != NULL) stats_sink->field += (n); } while (0)
+#define STATS_SET(field, value) do { if (stats_sink != NULL) stats_sink->field = (value); } while (0)
+#define STATS_START(name) uint32_t name = stats_now()
+#define STATS_STOP(phase, name) stats_elapsed(VOID_MAPPER_PHASE_##phase, name)
+
+#else
+
+#define STATS_ADD(field, n) ((void) 0)
+#define STATS_SET(field, value) ((void) 0)
+#define STATS_START(name) ((void) 0)
+#define STATS_STOP(phase, name) ((void) 0)
+
+#endif /* VOID_MAPPER_STATS */
+
+#endif /* __STATS_H__ */
@@ -0,0 +1,364 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "coordinates.h"
+#include "stats.h"
+
+/**
+ * The sweep moves a horizontal line down the area, stopping at the top and bottom edges
+ * of the input. Between two stops the set of input rectangles crossing the line does not
+ * change, so the void of the band between them is a list of x intervals: the gaps between
+ * the active rectangles. A strip of void stays open for as long as the same interval is
+ * void, and is output when its interval changes. No grid is built, the memory holds the
+ * active rectangles and the open strips only.
+ */
+
+typedef struct {
+    void_mapper_coord_t x0;
+    void_mapper_coord_t x1;
+    void_mapper_coord_t y0;
+} strip_t;
+
+_Static_assert(sizeof(strip_t) == VOID_MAPPER_STRIP_SIZE, "VOID_MAPPER_SWEEP_WORKSPACE_SIZE is out of date");
+
+typedef struct {
+    const void_mapper_rectangle_t *input;
+    void_mapper_count_t input_length;
+    void_mapper_rectangle_t area;
+
+    /* Memory, carved from the workspace */
+    void_mapper_count_t *order;
+    void_mapper_count_t *active;
+    strip_t *open;
+    strip_t *next;
+
+    void_mapper_count_t n_active;
+    void_mapper_count_t n_open;
+} sweep_t;
+
+/**
+ * @brief Split the workspace into the parts used by the sweep.
+ *
+ * @param sweep Sweep to initialize
+ * @param workspace Workspace supplied by the caller
+ * @param input_length Number of input rectangles
+ * @return true if the workspace is large enough and aligned
+ * @return false if it is not
+ */
+static bool sweep_init(sweep_t *sweep, const void_mapper_workspace_t *workspace, void_mapper_count_t input_length);
+
+/**
+ * @brief Edges of an input rectangle, clipped to the area. The right and bottom edges
+ * saturate so that rectangles reaching past the coordinate range do not wrap around.
+ *
+ * @param sweep Sweep
+ * @param i Index of the input rectangle
+ * @param x0 Left edge
+ * @param x1 Right edge
+ * @param y0 Top edge
+ * @param y1 Bottom edge
+ * @return true if the rectangle covers some of the area
+ * @return false if it does not
+ */
+static bool clip(const sweep_t *sweep, void_mapper_count_t i, void_mapper_coord_t *x0, void_mapper_coord_t *x1, void_mapper_coord_t *y0, void_mapper_coord_t *y1);
+
+/**
+ * @brief Sort the input rectangles within the area by their top edge, with an in-place heap
+ * sort of their indices.
+ *
+ * @param sweep Sweep
+ * @return void_mapper_count_t number of input rectangles covering some of the area
+ */
+static void_mapper_count_t sort_by_top(sweep_t *sweep);
+
+/**
+ * @brief Insert a rectangle in the active list, keeping the list ordered by left edge. The
+ * rectangles right of it are shifted, O(k) for k active rectangles, as much as the band
+ * walking the list costs anyway.
+ *
+ * @param sweep Sweep
+ * @param i Index of the input rectangle
+ */
+static void activate(sweep_t *sweep, void_mapper_count_t i);
+
+/**
+ * @brief Output an open strip ending at y.
+ *
+ * @param strip Open strip
+ * @param y Bottom of the strip
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param n_found Number of voids found so far
+ * @return true on success
+ * @return false if the buffer is full
+ */
+static bool close_strip(const strip_t *strip, void_mapper_coord_t y, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length, void_mapper_count_t *n_found);
+
+/**
+ * @brief Find the void intervals of the band starting at y, and output the open strips that
+ * do not go on in this band. The strips going on and the new ones become the open strips.
+ *
+ * @param sweep Sweep with the active list of the band
+ * @param y Top of the band
+ * @param buffer For storage of the result
+ * @param buffer_length Number of the elements in the buffer
+ * @param n_found Number of voids found so far
+ * @return true on success
+ * @return false if the buffer is too small
+ */
+static bool sweep_band(sweep_t *sweep, void_mapper_coord_t y, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length, void_mapper_count_t *n_found);
+
+static bool sweep_init(sweep_t *sweep, const void_mapper_workspace_t *workspace, void_mapper_count_t input_length)
+{
+#ifdef VOID_MAPPER_DETERMINISTIC
+    if (input_length > VOID_MAPPER_MAX_SPRITES) {
+        return false;
+    }
+#endif
+
+    if (workspace == NULL || workspace->memory == NULL ||
+        workspace->size < void_mapper_sweep_workspace_size(input_length) ||
+        (uintptr_t) workspace->memory % sizeof(void_mapper_word_t) != 0) {
+        return false;
+    }
+
+    uint8_t *memory = workspace->memory;
+    sweep->open = (strip_t *) memory;
+    memory += ((size_t) input_length + 1) * sizeof(strip_t);
+    sweep->next = (strip_t *) memory;
+    memory += ((size_t) input_length + 1) * sizeof(strip_t);
+    sweep->order = (void_mapper_count_t *) memory;
+    memory += (size_t) input_length * sizeof(void_mapper_count_t);
+    sweep->active = (void_mapper_count_t *) memory;
+
+    sweep->n_active = 0;
+    sweep->n_open = 0;
+
+    return true;
+}
+
+static bool clip(const sweep_t *sweep, void_mapper_count_t i, void_mapper_coord_t *x0, void_mapper_coord_t *x1, void_mapper_coord_t *y0, void_mapper_coord_t *y1)
+{
+    const void_mapper_rectangle_t *r = &sweep->input[i];
+    const void_mapper_rectangle_t *area = &sweep->area;
+    void_mapper_coord_t area_x1 = coordinates_end(area->position.x, area->size.x);
+    void_mapper_coord_t area_y1 = coordinates_end(area->position.y, area->size.y);
+
+    *x0 = r->position.x > area->position.x ? r->position.x : area->position.x;
+    *y0 = r->position.y > area->position.y ? r->position.y : area->position.y;
+    *x1 = coordinates_end(r->position.x, r->size.x);
+    *y1 = coordinates_end(r->position.y, r->size.y);
+    *x1 = *x1 < area_x1 ? *x1 : area_x1;
+    *y1 = *y1 < area_y1 ? *y1 : area_y1;
+
+    return *x0 < *x1 && *y0 < *y1;
+}
+
+static void_mapper_coord_t top(const sweep_t *sweep, void_mapper_count_t i)
+{
+    void_mapper_coord_t y = sweep->input[i].position.y;
+    return y > sweep->area.position.y ? y : sweep->area.position.y;
+}
+
+static void sift_down(sweep_t *sweep, void_mapper_count_t root, void_mapper_count_t len)
+{
+    void_mapper_count_t *order = sweep->order;
+    while (true) {
+        size_t child = 2 * (size_t) root + 1;
+        if (child >= len) {
+            return;
+        }
+
+        if (child + 1 < len && top(sweep, order[child]) < top(sweep, order[child + 1])) {
+            child++;
+        }
+
+        if (top(sweep, order[root]) >= top(sweep, order[child])) {
+            return;
+        }
+
+        void_mapper_count_t tmp = order[root];
+        order[root] = order[child];
+        order[child] = tmp;
+        root = child;
+    }
+}
+
+static void_mapper_count_t sort_by_top(sweep_t *sweep)
+{
+    void_mapper_count_t len = 0;
+    for (void_mapper_count_t i = 0; i < sweep->input_length; i++) {
+        void_mapper_coord_t x0, x1, y0, y1;
+        if (clip(sweep, i, &x0, &x1, &y0, &y1)) {
+            sweep->order[len++] = i;
+        }
+    }
+
+    if (len < 2) {
+        return len;
+    }
+
+    for (void_mapper_count_t i = len / 2; i-- > 0;) {
+        sift_down(sweep, i, len);
+    }
+
+    for (void_mapper_count_t end = len - 1; end > 0; end--) {
+        void_mapper_count_t tmp = sweep->order[0];
+        sweep->order[0] = sweep->order[end];
+        sweep->order[end] = tmp;
+        sift_down(sweep, 0, end);
+    }
+
+    return len;
+}
+
+static void activate(sweep_t *sweep, void_mapper_count_t i)
+{
+    void_mapper_coord_t x = sweep->input[i].position.x;
+    void_mapper_count_t k = sweep->n_active;
+    while (k > 0 && sweep->input[sweep->active[k - 1]].position.x > x) {
+        sweep->active[k] = sweep->active[k - 1];
+        k--;
+    }
+
+    sweep->active[k] = i;
+    sweep->n_active++;
+}
+
+static bool close_strip(const strip_t *strip, void_mapper_coord_t y, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length, void_mapper_count_t *n_found)
+{
+    if (*n_found >= buffer_length) {
+        return false;
+    }
+
+    buffer[(*n_found)++] = (void_mapper_rectangle_t) {
+        .position = { .x = strip->x0, .y = strip->y0 },
+        .size = { .x = strip->x1 - strip->x0, .y = y - strip->y0 },
+    };
+
+    return true;
+}
+
+static bool sweep_band(sweep_t *sweep, void_mapper_coord_t y, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length, void_mapper_count_t *n_found)
+{
+    void_mapper_coord_t area_x1 = coordinates_end(sweep->area.position.x, sweep->area.size.x);
+    void_mapper_coord_t reach = sweep->area.position.x;
+    void_mapper_count_t n_next = 0;
+    void_mapper_count_t k = 0;
+
+    for (void_mapper_count_t a = 0; a <= sweep->n_active; a++) {
+        void_mapper_coord_t x0 = area_x1;
+        void_mapper_coord_t x1 = area_x1;
+        if (a < sweep->n_active) {
+            void_mapper_coord_t y0, y1;
+            clip(sweep, sweep->active[a], &x0, &x1, &y0, &y1);
+        }
+
+        if (x0 > reach) {
+            strip_t gap = { .x0 = reach, .x1 = x0, .y0 = y };
+
+            /* Both lists are ordered from left to right, output the open strips left of the gap */
+            while (k < sweep->n_open && sweep->open[k].x0 < gap.x0) {
+                if (!close_strip(&sweep->open[k++], y, buffer, buffer_length, n_found)) {
+                    return false;
+                }
+            }
+
+            if (k < sweep->n_open && sweep->open[k].x0 == gap.x0 && sweep->open[k].x1 == gap.x1) {
+                gap.y0 = sweep->open[k++].y0;
+            }
+
+            sweep->next[n_next++] = gap;
+        }
+
+        reach = x1 > reach ? x1 : reach;
+    }
+
+    /* Open strips right of the last gap end here too */
+    while (k < sweep->n_open) {
+        if (!close_strip(&sweep->open[k++], y, buffer, buffer_length, n_found)) {
+            return false;
+        }
+    }
+
+    strip_t *swap = sweep->open;
+    sweep->open = sweep->next;
+    sweep->next = swap;
+    sweep->n_open = n_next;
+
+    return true;
+}
+
+size_t void_mapper_sweep_workspace_size(void_mapper_count_t input_length)
+{
+    return VOID_MAPPER_SWEEP_WORKSPACE_SIZE(input_length);
+}
+
+void_mapper_count_t void_mapper_sweep(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                      void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                      const void_mapper_workspace_t *workspace)
+{
+    if (buffer == NULL || buffer_length == 0) {
+        return 0;
+    }
+
+    if (input == NULL || input_length == 0) {
+        buffer[0] = area;
+        return 1;
+    }
+
+    sweep_t sweep = { .input = input, .input_length = input_length, .area = area };
+    if (!sweep_init(&sweep, workspace, input_length)) {
+        return 0;
+    }
+
+    STATS_START(sort_start);
+    void_mapper_count_t n_sorted = sort_by_top(&sweep);
+    STATS_STOP(SORT, sort_start);
+
+    STATS_START(cull_start);
+    void_mapper_coord_t bottom = coordinates_end(area.position.y, area.size.y);
+    void_mapper_coord_t y = area.position.y;
+    void_mapper_count_t next_top = 0;
+    void_mapper_count_t n_found = 0;
+    while (y < bottom) {
+        /* Drop the rectangles ending here and add the ones starting here */
+        void_mapper_count_t n_kept = 0;
+        for (void_mapper_count_t a = 0; a < sweep.n_active; a++) {
+            void_mapper_coord_t x0, x1, y0, y1;
+            clip(&sweep, sweep.active[a], &x0, &x1, &y0, &y1);
+            if (y1 > y) {
+                sweep.active[n_kept++] = sweep.active[a];
+            }
+        }
+        sweep.n_active = n_kept;
+
+        while (next_top < n_sorted && top(&sweep, sweep.order[next_top]) == y) {
+            activate(&sweep, sweep.order[next_top++]);
+        }
+
+        if (!sweep_band(&sweep, y, buffer, buffer_length, &n_found)) {
+            return 0;
+        }
+
+        /* The band ends at the next edge */
+        void_mapper_coord_t next_y = next_top < n_sorted ? top(&sweep, sweep.order[next_top]) : bottom;
+        for (void_mapper_count_t a = 0; a < sweep.n_active; a++) {
+            void_mapper_coord_t x0, x1, y0, y1;
+            clip(&sweep, sweep.active[a], &x0, &x1, &y0, &y1);
+            next_y = y1 < next_y ? y1 : next_y;
+        }
+        y = next_y;
+    }
+
+    /* Close the strips still open at the bottom of the area */
+    for (void_mapper_count_t k = 0; k < sweep.n_open; k++) {
+        if (!close_strip(&sweep.open[k], bottom, buffer, buffer_length, &n_found)) {
+            return 0;
+        }
+    }
+    STATS_STOP(CULL, cull_start);
+
+    return n_found;
+}
@@ -1,297 +1,1659 @@
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include "void_mapper.h"
+#include "grid.h"
+#include "coordinates.h"
+#include "stats.h"
+
+typedef int (*compare_t)(const void_mapper_rectangle_t *a, const void_mapper_rectangle_t *b);
+
+typedef struct {
+    void_mapper_rectangle_t *buffer;
+    void_mapper_count_t buffer_length;
+    void_mapper_emit_t emit;
+    void *context;
+    uint32_t n_found;
+} output_t;
+
+/* The deterministic build stops grouping after a fixed number of rounds, otherwise when nothing merges */
+#ifdef VOID_MAPPER_DETERMINISTIC
+#define GROUP_ROUNDS VOID_MAPPER_MAX_GROUP_PASSES
+#else
+#define GROUP_ROUNDS UINT32_MAX
+#endif
+
+/* Voids of the row above that the runs of the next row may extend, ordered from left to right */
+typedef struct {
+    void_mapper_count_t *above;
+    void_mapper_count_t *current;
+    void_mapper_count_t n_above;
+} grouping_t;
+
+/* Edges of a rectangle, a rectangle sharing a whole side has the opposite edge, edge ^ 1, with the same key */
+enum { EDGE_TOP, EDGE_BOTTOM, EDGE_LEFT, EDGE_RIGHT, EDGE_COUNT };
+
+/* An edge as the line it lies on, and where it starts and how long it is along that line */
+typedef struct {
+    uint64_t line;
+    uint64_t start;
+    uint64_t length;
+} edge_key_t;
+
+/* End of a chain of the edge table */
+#define NO_EDGE UINT32_MAX
+
+/* Flags of a rectangle being grouped */
+#define GROUP_PENDING 1     /* Has a side shared with a later rectangle, to visit in the next pass */
+#define GROUP_CHANGED 2     /* Grew in this pass */
+
+/*
+ * Rectangles being grouped, with a hash table of their edges. Edge e of rectangle i is node
+ * EDGE_COUNT * i + e, chained with the other edges of its bucket through next.
+ */
+typedef struct {
+    void_mapper_rectangle_t *rectangles;
+    void_mapper_count_t length;
+    uint32_t *heads;
+    uint32_t mask;
+    uint32_t *next;
+    void_mapper_count_t *pending;
+    void_mapper_count_t *changed;
+    uint8_t *flags;
+} edge_table_t;
+
+/**
+ * @brief Store a void in the output, or pass it to the emit callback if there is one. If the
+ * output has neither a buffer nor a callback, the void is only counted.
+ *
+ * @param output Output
+ * @param rectangle Void to store
+ * @return true on success
+ * @return false if the buffer is full or if the callback asked to stop
+ */
+static bool output_push(output_t *output, void_mapper_rectangle_t rectangle);
+
+/**
+ * @brief Output every void cell of the grid, row by row.
+ *
+ * @param grid Built grid
+ * @param output Output
+ * @return true on success
+ * @return false if the buffer is too small to hold all voids
+ */
+static bool map_cells(grid_t *grid, output_t *output);
+
+/**
+ * @brief Output the voids of the grid as the longest horizontal runs of void cells, row by row.
+ *
+ * @param grid Built grid
+ * @param output Output
+ * @return true on success
+ * @return false if the buffer is too small to hold all voids
+ */
+static bool map_runs(grid_t *grid, output_t *output);
+
+/**
+ * @brief Start a grouping without voids above. The runs of the row above are tracked in the
+ * scratch of the grid, which is free once the grid is built.
+ *
+ * @param grid Built grid
+ * @param grouping Grouping to start
+ */
+static void group_start(grid_t *grid, grouping_t *grouping);
+
+/**
+ * @brief Output the horizontal runs of void cells of a row, each merged with the void right
+ * above when both span the same columns.
+ *
+ * @param grid Built grid
+ * @param output Output with a buffer
+ * @param grouping Voids of the row above, updated to the ones of this row
+ * @param row Row
+ * @return true on success
+ * @return false if the buffer is too small to hold all voids
+ */
+static bool group_row(grid_t *grid, output_t *output, grouping_t *grouping, void_mapper_count_t row);
+
+/**
+ * @brief Output the voids of the grid as horizontal runs of void cells, merged with the run
+ * right above when both span the same columns.
+ *
+ * @param grid Built grid
+ * @param output Output with a buffer
+ * @return true on success
+ * @return false if the buffer is too small to hold all voids
+ */
+static bool map_grouped(grid_t *grid, output_t *output);
+
+/**
+ * @brief Check if the budget of a refinement is spent.
+ *
+ * @param budget Budget, NULL for none
+ * @param operations Operations done so far
+ * @return true if the refinement must stop
+ */
+static bool budget_spent(const void_mapper_budget_t *budget, uint32_t operations);
+
+/**
+ * @brief Cover the band of the area below a row without covering any input: the band minus
+ * the columns of the input rectangles crossing it. The columns are gathered in the buffer,
+ * sorted, and the gaps between them are written over them, which takes O(n log n).
+ *
+ * @param area Area to search
+ * @param top First row of the band
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param buffer For storage of the cover
+ * @param room Number of the elements of the buffer
+ * @return void_mapper_count_t number of rectangles of the cover, none if the columns do not fit
+ */
+static void_mapper_count_t cover_band(void_mapper_rectangle_t area, void_mapper_coord_t top, const void_mapper_rectangle_t *input,
+                                      void_mapper_count_t input_length, void_mapper_rectangle_t *buffer, uint32_t room);
+
+/**
+ * @brief Output the voids of each bucket of an index, row of buckets by row of buckets. A
+ * bucket is mapped on a grid built from the rectangles of its list only, and an empty
+ * bucket is a void of its own.
+ *
+ * @param index Built index
+ * @param input The input the index was built from
+ * @param workspace Workspace of at least void_mapper_indexed_workspace_size(index, output->buffer_length) bytes
+ * @param output Output
+ * @return true on success
+ * @return false if the buffer is too small to hold all voids
+ */
+static bool map_buckets(const void_mapper_index_t *index, const void_mapper_rectangle_t *input,
+                        const void_mapper_workspace_t *workspace, output_t *output);
+
+/**
+ * @brief Split a rectangle into its largest aligned rectangle and the unaligned remainders
+ * around it, from the top to the bottom. A rectangle without an aligned part is kept whole.
+ *
+ * @param rectangle Rectangle to split
+ * @param x Granularity of the columns, at least 1
+ * @param y Granularity of the rows, at least 1
+ * @param pieces Room for 5 pieces
+ * @param aligned Set to the index of the aligned piece, or to 5 if there is none
+ * @return uint8_t number of pieces
+ */
+static uint8_t split_aligned(void_mapper_rectangle_t rectangle, void_mapper_coord_t x, void_mapper_coord_t y,
+                             void_mapper_rectangle_t pieces[5], uint8_t *aligned);
+
+/**
+ * @brief Sort rectangles in place with a non-recursive heap sort.
+ *
+ * @param arr Rectangles to sort
+ * @param len Number of rectangles
+ * @param compare Order of the rectangles
+ */
+static void sort_rectangles(void_mapper_rectangle_t *arr, void_mapper_count_t len, compare_t compare);
+
+/**
+ * @brief Check if the gap between two rectangles is worth covering to save a command.
+ *
+ * @param cost Cost model, NULL to only close gaps without pixels
+ * @param pixels Number of pixels in the gap
+ * @return true if the pixels cost less than a command
+ */
+static bool worth_bridging(const void_mapper_cost_t *cost, uint64_t pixels);
+
+/**
+ * @brief Replace pairs of rectangles by the one rectangle spanning both, wherever this lowers
+ * the cost. Once sorted, each rectangle is tried with the ones starting below its top, down
+ * to where the rows in between would already cost more than a command.
+ *
+ * @param arr Rectangles, sorted and compacted in place
+ * @param len Number of rectangles
+ * @param cost Cost model
+ * @param merged Set to true if anything was merged
+ * @return void_mapper_count_t new number of rectangles
+ */
+static void_mapper_count_t absorb_pass(void_mapper_rectangle_t *arr, void_mapper_count_t len, const void_mapper_cost_t *cost, bool *merged);
+
+/**
+ * @brief Fuse every chain of blockers in line that overlap or touch, in one direction. Unlike
+ * voids, blockers may overlap, and the union of blockers in line is still a rectangle.
+ *
+ * @param arr Rectangles, sorted and compacted in place
+ * @param len Number of rectangles
+ * @param horizontal true to fuse side by side, false to fuse on top of each other
+ * @param fused Set to true if anything was fused
+ * @return void_mapper_count_t new number of rectangles
+ */
+static void_mapper_count_t fuse_pass(void_mapper_rectangle_t *arr, void_mapper_count_t len, bool horizontal, bool *fused);
+
+/**
+ * @brief Drop the blockers lying within another one. Of identical blockers, the first one is kept.
+ *
+ * @param arr Rectangles, compacted in place
+ * @param len Number of rectangles
+ * @param dropped Set to true if anything was dropped
+ * @return void_mapper_count_t new number of rectangles
+ */
+static void_mapper_count_t drop_covered(void_mapper_rectangle_t *arr, void_mapper_count_t len, bool *dropped);
+
+/**
+ * @brief Merge every chain of rectangles sharing a whole side, in one direction. With a cost
+ * model, rectangles in line with a gap between them are merged as well, when the gap is
+ * worth bridging.
+ *
+ * @param arr Rectangles, sorted and compacted in place
+ * @param len Number of rectangles
+ * @param horizontal true to merge side by side, false to merge on top of each other
+ * @param cost Cost model, NULL to only merge rectangles sharing a side
+ * @param merged Set to true if anything was merged
+ * @return void_mapper_count_t new number of rectangles
+ */
+static void_mapper_count_t merge_pass(void_mapper_rectangle_t *arr, void_mapper_count_t len, bool horizontal,
+                                      const void_mapper_cost_t *cost, bool *merged);
+
+/**
+ * @brief Number of buckets of the edge table, the smallest power of two of at least two per
+ * rectangle.
+ *
+ * @param length Number of rectangles
+ * @return uint64_t number of buckets
+ */
+static uint64_t edge_buckets(void_mapper_count_t length);
+
+/**
+ * @brief Get the key of an edge of a rectangle.
+ *
+ * @param rectangle Rectangle
+ * @param edge EDGE_TOP, EDGE_BOTTOM, EDGE_LEFT or EDGE_RIGHT
+ * @return edge_key_t key of the edge
+ */
+static edge_key_t edge_key(const void_mapper_rectangle_t *rectangle, uint8_t edge);
+
+/**
+ * @brief Get the bucket of the edge table holding the edges of a key.
+ *
+ * @param table Edge table
+ * @param edge Edge
+ * @param key Key of the edge
+ * @return uint32_t* head of the chain of the bucket
+ */
+static uint32_t *edge_bucket(const edge_table_t *table, uint8_t edge, edge_key_t key);
+
+/**
+ * @brief Add the four edges of a rectangle to the edge table, or remove them. Removing must
+ * happen before the rectangle changes, while its edges still have the keys they were added with.
+ * The edges of a merged rectangle are left in the table, they are skipped as it has no area.
+ *
+ * @param table Edge table
+ * @param i Rectangle
+ * @param add true to add the edges, false to remove them
+ */
+static void edge_update(edge_table_t *table, void_mapper_count_t i, bool add);
 
 /**
- * @brief Find if to ranges overlap.
- * The ranges are considered to intersect if they share the same
- * number. I.e. if the a range ends at 7 and the b range starts at 7, then
- * they overlap. This function assumes a0 < a1 and b0 < b1
+ * @brief Find the first rectangle from an index on that shares a whole side with another one,
+ * as the scan over all pairs of the greedy grouping would.
  *
- * @param a0 start of first range
- * @param a1 end of first range
- * @param b0 start of second range
- * @param b1 end of second range
- * @return true if they intersect
- * @return false if they don't
+ * @param table Edge table
+ * @param i Rectangle
+ * @param from First index to consider
+ * @return void_mapper_count_t the rectangle found, table->length if there is none
  */
-static bool ranges_intersect(int16_t a0, int16_t a1, int16_t b0, int16_t b1);
+static void_mapper_count_t edge_partner(const edge_table_t *table, void_mapper_count_t i, void_mapper_count_t from);
 
 /**
- * @brief Find if to rectangles intersect. This function returns true if any
- * "pixel" share the same coordinate.
+ * @brief Sort indices in place with a non-recursive heap sort.
  *
- * @param a First square
- * @param b Second square
- * @return true if the intersect
- * @return false if they don't
+ * @param arr Indices to sort
+ * @param len Number of indices
  */
-static bool rectangles_intersect(void_mapper_rectangle_t a, void_mapper_rectangle_t b);
+static void sort_indices(void_mapper_count_t *arr, void_mapper_count_t len);
 
 /**
- * @brief Remove elements less than min and greater than max.
+ * @brief Group rectangles in place with the greedy scan over all pairs, which needs no
+ * workspace and a constant amount of stack.
  *
- * @param arr
- * @param len
- * @param min
- * @param max
- * @return uint16_t new length of vector.
+ * @param input Rectangles with an area, grouped in place
+ * @param input_length Number of rectangles
+ * @return void_mapper_count_t number of rectangles left
  */
-static uint16_t saturate_vector(uint16_t *arr, uint16_t len, uint16_t min, uint16_t max);
+static void_mapper_count_t group_pairs(void_mapper_rectangle_t input[], void_mapper_count_t input_length);
 
-static bool ranges_intersect(int16_t a0, int16_t a1, int16_t b0, int16_t b1)
+static bool output_push(output_t *output, void_mapper_rectangle_t rectangle)
 {
-    return  a1 >= b0 && a0 <= b1;
+    if (output->emit != NULL) {
+        output->n_found++;
+        return output->emit(output->context, &rectangle);
+    }
+
+#ifdef VOID_MAPPER_DETERMINISTIC
+    if (output->n_found == VOID_MAPPER_MAX_VOIDS) {
+        return false;
+    }
+#endif
+
+    if (output->buffer == NULL) {
+        output->n_found++;
+        return true;
+    }
+
+    if (output->n_found == output->buffer_length) {
+        return false;
+    }
+
+    output->buffer[output->n_found++] = rectangle;
+    return true;
 }
 
-static bool rectangles_intersect(void_mapper_rectangle_t a, void_mapper_rectangle_t b)
+static bool map_cells(grid_t *grid, output_t *output)
 {
-    uint16_t ax0 = a.position.x;
-    uint16_t ax1 = a.position.x + a.size.x - 1;
-    uint16_t bx0 = b.position.x;
-    uint16_t bx1 = b.position.x + b.size.x - 1;
-    bool x_intersect = ranges_intersect(ax0, ax1, bx0, bx1);
+    // Cull out all cells covered by a box, one row at a time
+    for (void_mapper_count_t j = 0; j < grid_rows(grid); j++) {
+        grid_row(grid, j);
 
-    uint16_t ay0 = a.position.y;
-    uint16_t ay1 = a.position.y + a.size.y - 1;
-    uint16_t by0 = b.position.y;
-    uint16_t by1 = b.position.y + b.size.y - 1;
-    bool y_intersect = ranges_intersect(ay0, ay1, by0, by1);
+        for (void_mapper_count_t i = 0; i < grid_columns(grid); i++) {
+            if (grid_void(grid, i) && !output_push(output, grid_rectangle(grid, i, i + 1, j))) {
+                return false;
+            }
+        }
+    }
 
-    return x_intersect && y_intersect;
+    return true;
 }
 
-static void build_vectors(void_mapper_rectangle_t area, void_mapper_rectangle_t *input, uint16_t input_length,
-                          uint16_t *x_vector, uint16_t *y_vector, uint16_t len)
+static bool map_runs(grid_t *grid, output_t *output)
 {
-    x_vector[0] = area.position.x;
-    x_vector[len - 1] = area.position.x + area.size.x;
+    void_mapper_count_t columns = grid_columns(grid);
+
+    for (void_mapper_count_t j = 0; j < grid_rows(grid); j++) {
+        grid_row(grid, j);
+
+        void_mapper_count_t i = 0;
+        while (i < columns) {
+            if (!grid_void(grid, i)) {
+                i++;
+                continue;
+            }
 
-    y_vector[0] = area.position.y;
-    y_vector[len - 1] = area.position.y + area.size.y;
+            void_mapper_count_t start = i;
+            while (i < columns && grid_void(grid, i)) {
+                i++;
+            }
 
-    for (int i = 0;  i < input_length; i++)
-    {
-        x_vector[i * 2 + 1] = input[i].position.x;
-        x_vector[i * 2 + 2] = input[i].position.x + input[i].size.x;
-        y_vector[i * 2 + 1] = input[i].position.y;
-        y_vector[i * 2 + 2] = input[i].position.y + input[i].size.y;
+            if (!output_push(output, grid_rectangle(grid, start, i, j))) {
+                return false;
+            }
+        }
     }
+
+    return true;
 }
 
-void merge(uint16_t *arr, uint16_t start_a, uint16_t end_a, uint16_t start_b, uint16_t end_b)
+static int compare_columns(const void_mapper_rectangle_t *a, const void_mapper_rectangle_t *b)
 {
-    /* Since a and b are already sorted, take the shortcut if they are already sorted */
-    if (arr[end_a] <= arr[start_b])
-        return;
+    if (a->position.x != b->position.x) return a->position.x < b->position.x ? -1 : 1;
+    if (a->size.x != b->size.x) return a->size.x < b->size.x ? -1 : 1;
+    if (a->position.y != b->position.y) return a->position.y < b->position.y ? -1 : 1;
+    return 0;
+}
+
+static int compare_rows(const void_mapper_rectangle_t *a, const void_mapper_rectangle_t *b)
+{
+    if (a->position.y != b->position.y) return a->position.y < b->position.y ? -1 : 1;
+    if (a->size.y != b->size.y) return a->size.y < b->size.y ? -1 : 1;
+    if (a->position.x != b->position.x) return a->position.x < b->position.x ? -1 : 1;
+    return 0;
+}
 
-    /* Compare the two parts one by one, from start to end */
-    while (start_a <= end_a && start_b <= end_b) {
+static int compare_raster(const void_mapper_rectangle_t *a, const void_mapper_rectangle_t *b)
+{
+    if (a->position.y != b->position.y) return a->position.y < b->position.y ? -1 : 1;
+    if (a->position.x != b->position.x) return a->position.x < b->position.x ? -1 : 1;
+    return 0;
+}
 
-        /* If first element is on the correct spot, keep calm and carry on */
-        if (arr[start_a] <= arr[start_b]) {
-            start_a++;
-            continue;
+static void sift_down(void_mapper_rectangle_t *arr, void_mapper_count_t root, void_mapper_count_t len, compare_t compare)
+{
+    while (true) {
+        size_t child = 2 * (size_t) root + 1;
+        if (child >= len) {
+            return;
         }
 
-        /* Otherwise, "start_b" should be at the head */
-        uint16_t value = arr[start_b];
-        uint16_t index = start_b;
-
-        /* Overwrite "start_b" and shift each element to the right */
-        while (index != start_a) {
-            arr[index] = arr[index - 1];
-            index--;
+        if (child + 1 < len && compare(&arr[child], &arr[child + 1]) < 0) {
+            child++;
         }
 
-        /* Finally put the value of "start b" at the head */
-        arr[start_a] = value;
+        if (compare(&arr[root], &arr[child]) >= 0) {
+            return;
+        }
 
-        /* Step one step forward */
-        start_a++; end_a++; start_b++;
+        void_mapper_rectangle_t tmp = arr[root];
+        arr[root] = arr[child];
+        arr[child] = tmp;
+        root = child;
     }
 }
 
-void merge_sort(uint16_t *arr, uint16_t left, uint16_t right)
+static void sort_rectangles(void_mapper_rectangle_t *arr, void_mapper_count_t len, compare_t compare)
 {
-    /* Recursive divide and conquer, end is reached when left and right is the same*/
-    if (left == right)
+    if (len < 2) {
         return;
+    }
 
-    /* Divide the range in 2 */
-    uint16_t middle = (left + right) / 2;
-    merge_sort(arr, left, middle);
-    merge_sort(arr, middle + 1, right);
+    for (void_mapper_count_t i = len / 2; i-- > 0;) {
+        sift_down(arr, i, len, compare);
+    }
 
-    /* The two halves are sorted at this point, so just merge them knowing they are in numerical order */
-    merge(arr, left, middle, middle + 1, right);
+    for (void_mapper_count_t end = len - 1; end > 0; end--) {
+        void_mapper_rectangle_t tmp = arr[0];
+        arr[0] = arr[end];
+        arr[end] = tmp;
+        sift_down(arr, 0, end, compare);
+    }
 }
 
-static void sort_vector(uint16_t *vector, uint16_t len)
+static bool worth_bridging(const void_mapper_cost_t *cost, uint64_t pixels)
 {
-    merge_sort(vector, 0, len - 1);
+    if (pixels == 0) {
+        return true;
+    }
+
+    if (cost == NULL || cost->per_command == 0) {
+        return false;
+    }
+
+    /* pixels * per_pixel < per_command, without overflow */
+    return cost->per_pixel == 0 || pixels <= (cost->per_command - 1) / cost->per_pixel;
 }
 
-static uint16_t remove_duplicates(uint16_t *arr, uint16_t len)
+static void_mapper_count_t merge_pass(void_mapper_rectangle_t *arr, void_mapper_count_t len, bool horizontal,
+                                      const void_mapper_cost_t *cost, bool *merged)
 {
-    uint16_t head = 0;
-    while (head < len) {
-        if (arr[head] != arr[head + 1]) {
-            head++;
-            continue;
+    sort_rectangles(arr, len, horizontal ? compare_rows : compare_columns);
+
+    /* Rectangles in line are next to each other after sorting, chains merge in one sweep */
+    void_mapper_count_t n_kept = 0;
+    for (void_mapper_count_t i = 0; i < len; i++) {
+        void_mapper_rectangle_t *last = n_kept > 0 ? &arr[n_kept - 1] : NULL;
+        if (last != NULL && horizontal &&
+            last->position.y == arr[i].position.y && last->size.y == arr[i].size.y &&
+            last->position.x + last->size.x <= arr[i].position.x &&
+            worth_bridging(cost, (uint64_t) (arr[i].position.x - last->position.x - last->size.x) * last->size.y)) {
+            last->size.x = arr[i].position.x + arr[i].size.x - last->position.x;
+            *merged = true;
+            STATS_ADD(merges, 1);
+        } else if (last != NULL && !horizontal &&
+                   last->position.x == arr[i].position.x && last->size.x == arr[i].size.x &&
+                   last->position.y + last->size.y <= arr[i].position.y &&
+                   worth_bridging(cost, (uint64_t) (arr[i].position.y - last->position.y - last->size.y) * last->size.x)) {
+            last->size.y = arr[i].position.y + arr[i].size.y - last->position.y;
+            *merged = true;
+            STATS_ADD(merges, 1);
+        } else {
+            arr[n_kept++] = arr[i];
         }
+    }
+
+    return n_kept;
+}
+
+static void_mapper_count_t absorb_pass(void_mapper_rectangle_t *arr, void_mapper_count_t len, const void_mapper_cost_t *cost, bool *merged)
+{
+    sort_rectangles(arr, len, compare_raster);
+
+    for (void_mapper_count_t i = 0; i < len; i++) {
+        void_mapper_rectangle_t *a = &arr[i];
+        for (void_mapper_count_t j = i + 1; j < len && a->size.x != 0; j++) {
+            void_mapper_rectangle_t *b = &arr[j];
+            if (b->size.x == 0) {
+                continue;
+            }
+
+            /* Sorted from the top, the ones further down are even farther away */
+            uint64_t a_bottom = (uint64_t) a->position.y + a->size.y;
+            if (b->position.y > a_bottom && !worth_bridging(cost, b->position.y - a_bottom)) {
+                break;
+            }
+
+            uint64_t x0 = a->position.x < b->position.x ? a->position.x : b->position.x;
+            uint64_t x1 = (uint64_t) a->position.x + a->size.x;
+            x1 = x1 > (uint64_t) b->position.x + b->size.x ? x1 : (uint64_t) b->position.x + b->size.x;
+            uint64_t y1 = a_bottom > (uint64_t) b->position.y + b->size.y ? a_bottom : (uint64_t) b->position.y + b->size.y;
+
+            /* The pixels the spanning rectangle adds, in this order to stay within 64 bits */
+            uint64_t spanned = (x1 - x0) * (y1 - a->position.y);
+            uint64_t a_area = (uint64_t) a->size.x * a->size.y;
+            uint64_t b_area = (uint64_t) b->size.x * b->size.y;
+            uint64_t extra = spanned > a_area ? spanned - a_area : 0;
+            extra = extra > b_area ? extra - b_area : 0;
+            if (!worth_bridging(cost, extra)) {
+                continue;
+            }
 
-        /* Shift everything to the left, overwriting the duplicate */
-        uint16_t index = head;
-        while (index < len) {
-            arr[index] = arr[index + 1];
-            index++;
+            a->position.x = x0;
+            a->size.x = x1 - x0;
+            a->size.y = y1 - a->position.y;
+            b->size.x = 0;
+            *merged = true;
+            STATS_ADD(merges, 1);
         }
+    }
 
-        len--;
+    void_mapper_count_t n_kept = 0;
+    for (void_mapper_count_t i = 0; i < len; i++) {
+        if (arr[i].size.x != 0) {
+            arr[n_kept++] = arr[i];
+        }
     }
 
-    return len;
+    return n_kept;
 }
 
-static uint16_t saturate_vector(uint16_t *arr, uint16_t len, uint16_t min, uint16_t max)
+static void_mapper_count_t fuse_pass(void_mapper_rectangle_t *arr, void_mapper_count_t len, bool horizontal, bool *fused)
 {
-    size_t new_length = 0;
+    sort_rectangles(arr, len, horizontal ? compare_rows : compare_columns);
 
-    // Remove elements less than min
-    for (size_t i = 0; i < len; i++) {
-        if (arr[i] >= min) {
-            arr[new_length++] = arr[i];
+    void_mapper_count_t n_kept = 0;
+    for (void_mapper_count_t i = 0; i < len; i++) {
+        void_mapper_rectangle_t *last = n_kept > 0 ? &arr[n_kept - 1] : NULL;
+        if (last != NULL && horizontal &&
+            last->position.y == arr[i].position.y && last->size.y == arr[i].size.y &&
+            arr[i].position.x <= last->position.x + last->size.x) {
+            uint64_t end = (uint64_t) arr[i].position.x + arr[i].size.x;
+            if (end > (uint64_t) last->position.x + last->size.x) {
+                last->size.x = end - last->position.x;
+            }
+            *fused = true;
+        } else if (last != NULL && !horizontal &&
+                   last->position.x == arr[i].position.x && last->size.x == arr[i].size.x &&
+                   arr[i].position.y <= last->position.y + last->size.y) {
+            uint64_t end = (uint64_t) arr[i].position.y + arr[i].size.y;
+            if (end > (uint64_t) last->position.y + last->size.y) {
+                last->size.y = end - last->position.y;
+            }
+            *fused = true;
+        } else {
+            arr[n_kept++] = arr[i];
         }
     }
 
-    // Update length after removing elements less than min
-    len = new_length;
-    new_length = 0;
+    return n_kept;
+}
+
+static void_mapper_count_t drop_covered(void_mapper_rectangle_t *arr, void_mapper_count_t len, bool *dropped)
+{
+    /* Every pair is tested, which is still less than the cells of the grid the blockers would add */
+    for (void_mapper_count_t i = 0; i < len; i++) {
+        uint64_t x1 = (uint64_t) arr[i].position.x + arr[i].size.x;
+        uint64_t y1 = (uint64_t) arr[i].position.y + arr[i].size.y;
+        for (void_mapper_count_t j = 0; j < len && arr[i].size.x != 0; j++) {
+            if (j == i || arr[j].size.x == 0 ||
+                arr[j].position.x < arr[i].position.x || arr[j].position.y < arr[i].position.y ||
+                (uint64_t) arr[j].position.x + arr[j].size.x > x1 || (uint64_t) arr[j].position.y + arr[j].size.y > y1) {
+                continue;
+            }
 
-    // Remove elements greater than max
-    for (size_t i = 0; i < len; i++) {
-        if (arr[i] <= max) {
-            arr[new_length++] = arr[i];
+            /* j lies within i, of two identical blockers the later one goes */
+            if (j > i || memcmp(&arr[i], &arr[j], sizeof(arr[i])) != 0) {
+                arr[j].size.x = 0;
+                *dropped = true;
+            }
         }
     }
 
-    // Update length after removing elements greater than max
-    return new_length;
+    void_mapper_count_t n_kept = 0;
+    for (void_mapper_count_t i = 0; i < len; i++) {
+        if (arr[i].size.x != 0) {
+            arr[n_kept++] = arr[i];
+        }
+    }
+
+    return n_kept;
+}
+
+static uint64_t edge_buckets(void_mapper_count_t length)
+{
+    uint64_t buckets = 1;
+    while (buckets < 2 * (uint64_t) length) {
+        buckets <<= 1;
+    }
+
+    return buckets;
+}
+
+static edge_key_t edge_key(const void_mapper_rectangle_t *rectangle, uint8_t edge)
+{
+    switch (edge) {
+    case EDGE_TOP:
+        return (edge_key_t) { rectangle->position.y, rectangle->position.x, rectangle->size.x };
+    case EDGE_BOTTOM:
+        return (edge_key_t) { (uint64_t) rectangle->position.y + rectangle->size.y, rectangle->position.x, rectangle->size.x };
+    case EDGE_LEFT:
+        return (edge_key_t) { rectangle->position.x, rectangle->position.y, rectangle->size.y };
+    default:
+        return (edge_key_t) { (uint64_t) rectangle->position.x + rectangle->size.x, rectangle->position.y, rectangle->size.y };
+    }
 }
 
-static bool can_merge(void_mapper_rectangle_t *a, void_mapper_rectangle_t *b) {
-    return (a->position.x == b->position.x && a->size.x == b->size.x &&
-            (a->position.y + a->size.y == b->position.y || b->position.y + b->size.y == a->position.y)) ||
-           (a->position.y == b->position.y && a->size.y == b->size.y &&
-            (a->position.x + a->size.x == b->position.x || b->position.x + b->size.x == a->position.x));
+static uint32_t *edge_bucket(const edge_table_t *table, uint8_t edge, edge_key_t key)
+{
+    /* Horizontal and vertical edges on the same numbers must not collide, hence the edge */
+    uint64_t hash = (key.line * 0x9E3779B97F4A7C15u) ^ (key.start * 0xC2B2AE3D27D4EB4Fu) ^ (key.length * 0x165667B19E3779F9u) ^ (edge >> 1);
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDu;
+    hash ^= hash >> 33;
+
+    return &table->heads[hash & table->mask];
 }
 
-static void merge_rectangle(void_mapper_rectangle_t *a, void_mapper_rectangle_t *b) {
-    if (a->position.x == b->position.x && a->size.x == b->size.x) {
-        a->size.y += b->size.y;
-        if (b->position.y < a->position.y) {
-            a->position.y = b->position.y;
+static void edge_update(edge_table_t *table, void_mapper_count_t i, bool add)
+{
+    for (uint8_t edge = 0; edge < EDGE_COUNT; edge++) {
+        uint32_t node = EDGE_COUNT * (uint32_t) i + edge;
+        uint32_t *link = edge_bucket(table, edge, edge_key(&table->rectangles[i], edge));
+        if (add) {
+            table->next[node] = *link;
+            *link = node;
+            continue;
         }
-    } else if (a->position.y == b->position.y && a->size.y == b->size.y) {
-        a->size.x += b->size.x;
-        if (b->position.x < a->position.x) {
-            a->position.x = b->position.x;
+
+        while (*link != node) {
+            link = &table->next[*link];
         }
+        *link = table->next[node];
     }
 }
 
-uint16_t void_mapper_group(void_mapper_rectangle_t input[], uint16_t input_length) {
-    bool merged;
-    do {
-        merged = false;
-        for (int i = 0; i < input_length; i++) {
-            if (input[i].size.x == 0 && input[i].size.y == 0) continue;
-            for (int j = i + 1; j < input_length; j++) {
-                if (input[j].size.x == 0 && input[j].size.y == 0) continue;
-                if (can_merge(&input[i], &input[j])) {
-                    merge_rectangle(&input[i], &input[j]);
-                    input[j].size.x = 0;
-                    input[j].size.y = 0;
-                    merged = true;
-                }
+static void_mapper_count_t edge_partner(const edge_table_t *table, void_mapper_count_t i, void_mapper_count_t from)
+{
+    void_mapper_count_t found = table->length;
+    for (uint8_t edge = 0; edge < EDGE_COUNT; edge++) {
+        edge_key_t key = edge_key(&table->rectangles[i], edge);
+        uint8_t opposite = edge ^ 1;
+
+        /* Overlapping rectangles may share an edge, the chain is walked to its end */
+        for (uint32_t node = *edge_bucket(table, opposite, key); node != NO_EDGE; node = table->next[node]) {
+            void_mapper_count_t j = node / EDGE_COUNT;
+            if (node % EDGE_COUNT != opposite || j < from || j >= found || j == i || table->rectangles[j].size.x == 0) {
+                continue;
+            }
+
+            edge_key_t other = edge_key(&table->rectangles[j], opposite);
+            if (other.line == key.line && other.start == key.start && other.length == key.length) {
+                found = j;
             }
         }
-    } while (merged);
+    }
+
+    return found;
+}
+
+static void sift_index(void_mapper_count_t *arr, void_mapper_count_t root, void_mapper_count_t len)
+{
+    while (true) {
+        size_t child = 2 * (size_t) root + 1;
+        if (child >= len) {
+            return;
+        }
 
-    int new_length = 0;
-    for (int i = 0; i < input_length; i++) {
-        if (input[i].size.x != 0 && input[i].size.y != 0) {
-            input[new_length++] = input[i];
+        if (child + 1 < len && arr[child] < arr[child + 1]) {
+            child++;
+        }
+
+        if (arr[root] >= arr[child]) {
+            return;
         }
+
+        void_mapper_count_t tmp = arr[root];
+        arr[root] = arr[child];
+        arr[child] = tmp;
+        root = child;
     }
+}
 
-    return new_length;
+static void sort_indices(void_mapper_count_t *arr, void_mapper_count_t len)
+{
+    if (len < 2) {
+        return;
+    }
+
+    for (void_mapper_count_t i = len / 2; i-- > 0;) {
+        sift_index(arr, i, len);
+    }
+
+    for (void_mapper_count_t end = len - 1; end > 0; end--) {
+        void_mapper_count_t tmp = arr[0];
+        arr[0] = arr[end];
+        arr[end] = tmp;
+        sift_index(arr, 0, end);
+    }
 }
 
-uint16_t void_mapper(void_mapper_rectangle_t area, void_mapper_rectangle_t *input, uint16_t input_length,
-                                     void_mapper_rectangle_t * buffer, uint16_t buffer_length)
+size_t void_mapper_group_workspace_size(void_mapper_count_t input_length)
 {
-    if (buffer == NULL || buffer_length == 0) {
+    return edge_buckets(input_length) * sizeof(uint32_t) + (size_t) input_length * EDGE_COUNT * sizeof(uint32_t) +
+           (size_t) input_length * (2 * sizeof(void_mapper_count_t) + 1);
+}
+
+void_mapper_count_t void_mapper_group_with_workspace(void_mapper_rectangle_t input[], void_mapper_count_t input_length,
+                                                     const void_mapper_workspace_t *workspace)
+{
+    if (input == NULL || input_length == 0) {
         return 0;
     }
 
+    if ((uint64_t) input_length * EDGE_COUNT >= NO_EDGE || workspace == NULL || workspace->memory == NULL ||
+        workspace->size < void_mapper_group_workspace_size(input_length) ||
+        (uintptr_t) workspace->memory % sizeof(void_mapper_word_t) != 0) {
+        return 0;
+    }
 
-    if (input == NULL || input_length == 0) {
-        buffer[0] = area;
-        return 1;
+    STATS_START(group_start);
+    void_mapper_count_t new_length = 0;
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        if (input[i].size.x != 0 && input[i].size.y != 0) {
+            input[new_length++] = input[i];
+        }
     }
 
-    uint16_t vec_len = input_length * 2 + 2;
+    /* Widest types first, keeping every part aligned */
+    uint64_t buckets = edge_buckets(new_length);
+    uint8_t *memory = workspace->memory;
+    edge_table_t table = { .rectangles = input, .length = new_length, .mask = buckets - 1 };
+    table.heads = (uint32_t *) memory;
+    memory += buckets * sizeof(uint32_t);
+    table.next = (uint32_t *) memory;
+    memory += (size_t) new_length * EDGE_COUNT * sizeof(uint32_t);
+    table.pending = (void_mapper_count_t *) memory;
+    memory += new_length * sizeof(void_mapper_count_t);
+    table.changed = (void_mapper_count_t *) memory;
+    memory += new_length * sizeof(void_mapper_count_t);
+    table.flags = memory;
 
-    // Create, sort and cull vectors
-    uint16_t x_vector[vec_len];
-    uint16_t y_vector[vec_len];
-    build_vectors(area, input, input_length, x_vector, y_vector, vec_len);
+    memset(table.heads, 0xff, buckets * sizeof(uint32_t));
+    memset(table.flags, 0, new_length);
+    for (void_mapper_count_t i = 0; i < new_length; i++) {
+        edge_update(&table, i, true);
+        table.pending[i] = i;
+    }
+
+    /*
+     * Each pass visits the rectangles in order, and merges each one with every later rectangle
+     * it shares a whole side with, in order, as the scan over all pairs does. A rectangle only
+     * has something to merge in the next pass if it shares a side with a later one at the end
+     * of this pass, and one of the two grew, so only those are visited.
+     */
+    void_mapper_count_t n_pending = new_length;
+    uint32_t round = 0;
+    while (n_pending > 0) {
+        void_mapper_count_t n_changed = 0;
+        for (void_mapper_count_t p = 0; p < n_pending; p++) {
+            void_mapper_count_t i = table.pending[p];
+            void_mapper_rectangle_t *a = &input[i];
+            table.flags[i] &= ~GROUP_PENDING;
+            if (a->size.x == 0) {
+                continue;
+            }
 
-    sort_vector(x_vector, vec_len);
-    sort_vector(y_vector, vec_len);
+            /* The rectangle leaves the table while it grows, no lookup of this pass can find it */
+            void_mapper_count_t j = edge_partner(&table, i, i + 1);
+            if (j < new_length) {
+                edge_update(&table, i, false);
+            }
 
-    uint16_t x_len = remove_duplicates(x_vector, vec_len);
-    uint16_t y_len = remove_duplicates(y_vector, vec_len);
+            while (j < new_length) {
+                void_mapper_rectangle_t *b = &input[j];
+                if (a->position.x == b->position.x && a->size.x == b->size.x) {
+                    a->position.y = a->position.y < b->position.y ? a->position.y : b->position.y;
+                    a->size.y += b->size.y;
+                } else {
+                    a->position.x = a->position.x < b->position.x ? a->position.x : b->position.x;
+                    a->size.x += b->size.x;
+                }
+                b->size.x = 0;
+                b->size.y = 0;
+                STATS_ADD(merges, 1);
 
-    x_len = saturate_vector(x_vector, x_len, area.position.x, area.position.x + area.size.x);
-    y_len = saturate_vector(y_vector, y_len, area.position.y, area.position.y + area.size.y);
+                if (!(table.flags[i] & GROUP_CHANGED)) {
+                    table.flags[i] |= GROUP_CHANGED;
+                    table.changed[n_changed++] = i;
+                }
+                j = edge_partner(&table, i, j + 1);
+            }
 
-    uint16_t required_buffer_length = (x_len - 1) * (y_len - 1) - input_length;
-    if (buffer_length < required_buffer_length) {
-        return 0;
+            if (table.flags[i] & GROUP_CHANGED) {
+                edge_update(&table, i, true);
+            }
+        }
+        STATS_ADD(merge_passes, n_changed > 0);
+
+        if (++round >= GROUP_ROUNDS) {
+            break;
+        }
+
+        n_pending = 0;
+        for (void_mapper_count_t c = 0; c < n_changed; c++) {
+            void_mapper_count_t i = table.changed[c];
+            table.flags[i] &= ~GROUP_CHANGED;
+            for (void_mapper_count_t j = edge_partner(&table, i, 0); j < new_length; j = edge_partner(&table, i, j + 1)) {
+                void_mapper_count_t first = i < j ? i : j;
+                if (!(table.flags[first] & GROUP_PENDING)) {
+                    table.flags[first] |= GROUP_PENDING;
+                    table.pending[n_pending++] = first;
+                }
+            }
+        }
+        sort_indices(table.pending, n_pending);
     }
 
-    // Build all possible rectangles
-    uint16_t potential_size = (x_len - 1) * (y_len - 1);
-    void_mapper_rectangle_t potential[potential_size];
-    x_len--; y_len--; /* Avoid iterating last element, as the loop accesses i + 1 */
-    for (uint32_t i = 0; i < x_len; i++) {
-        for(uint32_t j = 0; j < y_len; j++) {
-            uint32_t potential_index = i + j * (x_len);
-            potential[potential_index] = (void_mapper_rectangle_t) {
-                .position.x = x_vector[i],
-                .position.y = y_vector[j],
-                .size.x = x_vector[i + 1] - x_vector[i],
-                .size.y = y_vector[j + 1] - y_vector[j]
-            };
+    void_mapper_count_t n_kept = 0;
+    for (void_mapper_count_t i = 0; i < new_length; i++) {
+        if (input[i].size.x != 0) {
+            input[n_kept++] = input[i];
         }
     }
+    STATS_STOP(GROUP, group_start);
+
+    return n_kept;
+}
+
+static void_mapper_count_t group_pairs(void_mapper_rectangle_t input[], void_mapper_count_t input_length)
+{
+    STATS_START(group_start);
+    bool merged;
+    uint32_t round = 0;
+    do {
+        merged = false;
+        for (void_mapper_count_t i = 0; i < input_length; i++) {
+            void_mapper_rectangle_t *a = &input[i];
+            for (void_mapper_count_t j = i + 1; j < input_length && a->size.x != 0; j++) {
+                void_mapper_rectangle_t *b = &input[j];
+                if (b->size.x == 0) {
+                    continue;
+                }
+
+                if (a->position.x == b->position.x && a->size.x == b->size.x &&
+                    ((uint64_t) a->position.y + a->size.y == b->position.y || (uint64_t) b->position.y + b->size.y == a->position.y)) {
+                    a->position.y = a->position.y < b->position.y ? a->position.y : b->position.y;
+                    a->size.y += b->size.y;
+                } else if (a->position.y == b->position.y && a->size.y == b->size.y &&
+                           ((uint64_t) a->position.x + a->size.x == b->position.x || (uint64_t) b->position.x + b->size.x == a->position.x)) {
+                    a->position.x = a->position.x < b->position.x ? a->position.x : b->position.x;
+                    a->size.x += b->size.x;
+                } else {
+                    continue;
+                }
+                b->size.x = 0;
+                b->size.y = 0;
+                merged = true;
+                STATS_ADD(merges, 1);
+            }
+        }
+        STATS_ADD(merge_passes, merged);
+    } while (merged && ++round < GROUP_ROUNDS);
 
-    // Cull out all rectangles that is within the boxes
-    int32_t n_found = 0;
-    for (int i = 0; i < potential_size; i ++)
-    {
-        bool save = true;
-        for (int j = 0; j < input_length; j++)
-        {
-            save = rectangles_intersect(potential[i], input[j]) == true ? false : save;
+    void_mapper_count_t n_kept = 0;
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        if (input[i].size.x != 0) {
+            input[n_kept++] = input[i];
         }
-        if (save) {
-            buffer[n_found++] = potential[i];
+    }
+    STATS_STOP(GROUP, group_start);
+
+    return n_kept;
+}
+
+void_mapper_count_t void_mapper_group(void_mapper_rectangle_t input[], void_mapper_count_t input_length) {
+    if (input == NULL || input_length == 0) {
+        return 0;
+    }
+
+    /* The rectangles with an area, grouped in place without a workspace */
+    void_mapper_count_t new_length = 0;
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        if (input[i].size.x != 0 && input[i].size.y != 0) {
+            input[new_length++] = input[i];
         }
     }
 
-    return n_found;
+    return group_pairs(input, new_length);
+}
+
+void_mapper_count_t void_mapper_normalize(void_mapper_rectangle_t area, void_mapper_rectangle_t input[], void_mapper_count_t input_length)
+{
+    if (input == NULL) {
+        return 0;
+    }
+
+    /* Clip to the area, leaving out what is empty or outside of it */
+    uint64_t ax1 = (uint64_t) area.position.x + area.size.x;
+    uint64_t ay1 = (uint64_t) area.position.y + area.size.y;
+    void_mapper_count_t new_length = 0;
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        uint64_t x0 = input[i].position.x > area.position.x ? input[i].position.x : area.position.x;
+        uint64_t y0 = input[i].position.y > area.position.y ? input[i].position.y : area.position.y;
+        uint64_t x1 = (uint64_t) input[i].position.x + input[i].size.x;
+        uint64_t y1 = (uint64_t) input[i].position.y + input[i].size.y;
+        x1 = x1 < ax1 ? x1 : ax1;
+        y1 = y1 < ay1 ? y1 : ay1;
+        if (x0 >= x1 || y0 >= y1) {
+            continue;
+        }
+
+        input[new_length++] = (void_mapper_rectangle_t) {
+            .position = { .x = x0, .y = y0 },
+            .size = { .x = x1 - x0, .y = y1 - y0 },
+        };
+    }
+
+    /* Fusing blockers may bring others within them, and dropping some may let others fuse */
+    bool changed;
+    uint32_t round = 0;
+    do {
+        changed = false;
+        new_length = fuse_pass(input, new_length, true, &changed);
+        new_length = fuse_pass(input, new_length, false, &changed);
+        new_length = drop_covered(input, new_length, &changed);
+    } while (changed && ++round < GROUP_ROUNDS);
+
+    sort_rectangles(input, new_length, compare_raster);
+
+    return new_length;
+}
+
+static void group_start(grid_t *grid, grouping_t *grouping)
+{
+    grouping->above = grid->scratch;
+    grouping->current = grouping->above + grid->capacity + 1;
+    grouping->n_above = 0;
+}
+
+static bool group_row(grid_t *grid, output_t *output, grouping_t *grouping, void_mapper_count_t row)
+{
+    void_mapper_count_t columns = grid_columns(grid);
+    void_mapper_count_t *above = grouping->above;
+    void_mapper_count_t *current = grouping->current;
+    void_mapper_count_t n_above = grouping->n_above;
+
+    grid_row(grid, row);
+
+    void_mapper_count_t n_current = 0;
+    void_mapper_count_t k = 0;
+    void_mapper_count_t i = 0;
+    while (i < columns) {
+        if (!grid_void(grid, i)) {
+            i++;
+            continue;
+        }
+
+        void_mapper_count_t start = i;
+        while (i < columns && grid_void(grid, i)) {
+            i++;
+        }
+
+        void_mapper_rectangle_t run = grid_rectangle(grid, start, i, row);
+
+        /* Both rows are ordered from left to right, skip the runs above that end before this one */
+        while (k < n_above && output->buffer[above[k]].position.x < run.position.x) {
+            k++;
+        }
+
+        void_mapper_rectangle_t *match = k < n_above ? &output->buffer[above[k]] : NULL;
+        if (match != NULL && match->position.x == run.position.x && match->size.x == run.size.x) {
+            match->size.y += run.size.y;
+            current[n_current++] = above[k++];
+            continue;
+        }
+
+        if (!output_push(output, run)) {
+            return false;
+        }
+        current[n_current++] = output->n_found - 1;
+    }
+
+    grouping->above = current;
+    grouping->current = above;
+    grouping->n_above = n_current;
+    return true;
+}
+
+static bool map_grouped(grid_t *grid, output_t *output)
+{
+    grouping_t grouping;
+    group_start(grid, &grouping);
+
+    for (void_mapper_count_t j = 0; j < grid_rows(grid); j++) {
+        if (!group_row(grid, output, &grouping, j)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool budget_spent(const void_mapper_budget_t *budget, uint32_t operations)
+{
+    if (budget == NULL) {
+        return false;
+    }
+
+    if (budget->max_operations != 0 && operations > budget->max_operations) {
+        return true;
+    }
+
+    /* The clock may wrap around, the deadline is passed once the difference turns positive */
+    return budget->clock != NULL && (int32_t) (budget->clock() - budget->deadline) >= 0;
+}
+
+static void_mapper_count_t cover_band(void_mapper_rectangle_t area, void_mapper_coord_t top, const void_mapper_rectangle_t *input,
+                                      void_mapper_count_t input_length, void_mapper_rectangle_t *buffer, uint32_t room)
+{
+    void_mapper_coord_t left = area.position.x;
+    void_mapper_coord_t right = coordinates_end(area.position.x, area.size.x);
+    void_mapper_coord_t bottom = coordinates_end(area.position.y, area.size.y);
+    top = top > area.position.y ? top : area.position.y;
+    if (top >= bottom || left >= right) {
+        return 0;
+    }
+
+    /* The columns of the rectangles crossing the band, clipped to the area */
+    void_mapper_count_t n_columns = 0;
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        void_mapper_coord_t x0 = input[i].position.x;
+        void_mapper_coord_t x1 = coordinates_end(input[i].position.x, input[i].size.x);
+        if (input[i].size.y == 0 || input[i].position.y >= bottom || coordinates_end(input[i].position.y, input[i].size.y) <= top ||
+            x0 >= right || x1 <= left) {
+            continue;
+        }
+
+        /* One more place is needed for the gap after the last column */
+        if ((uint32_t) n_columns + 1 >= room) {
+            return 0;
+        }
+
+        x0 = x0 > left ? x0 : left;
+        x1 = x1 < right ? x1 : right;
+        buffer[n_columns++] = (void_mapper_rectangle_t) { .position = { .x = x0 }, .size = { .x = x1 - x0 } };
+    }
+    sort_rectangles(buffer, n_columns, compare_columns);
+
+    /* The gaps before a column are at most as many as the columns before it, it is read before it is overwritten */
+    void_mapper_count_t n_gaps = 0;
+    void_mapper_coord_t cursor = left;
+    for (void_mapper_count_t j = 0; j < n_columns; j++) {
+        void_mapper_coord_t x0 = buffer[j].position.x;
+        void_mapper_coord_t x1 = x0 + buffer[j].size.x;
+        if (x0 > cursor) {
+            buffer[n_gaps++] = (void_mapper_rectangle_t) {
+                .position = { .x = cursor, .y = top },
+                .size = { .x = x0 - cursor, .y = bottom - top },
+            };
+        }
+        cursor = x1 > cursor ? x1 : cursor;
+    }
+
+    if (cursor < right) {
+        buffer[n_gaps++] = (void_mapper_rectangle_t) {
+            .position = { .x = cursor, .y = top },
+            .size = { .x = right - cursor, .y = bottom - top },
+        };
+    }
+
+    return n_gaps;
+}
+
+size_t void_mapper_workspace_size(void_mapper_count_t input_length)
+{
+    return VOID_MAPPER_WORKSPACE_SIZE(input_length);
+}
+
+void_mapper_count_t void_mapper_with_workspace(void_mapper_rectangle_t area, void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                               void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                               const void_mapper_workspace_t *workspace)
+{
+    if (buffer == NULL || buffer_length == 0) {
+        return 0;
+    }
+
+    if (input == NULL || input_length == 0) {
+        buffer[0] = area;
+        return 1;
+    }
+
+    grid_t grid;
+    if (!grid_init(&grid, workspace, input_length)) {
+        return 0;
+    }
+
+    grid_layer_t layer = { .rectangles = input, .length = input_length, .weight = GRID_BLOCKER };
+    grid_build(&grid, area, &layer, 1);
+
+    output_t output = { .buffer = buffer, .buffer_length = buffer_length };
+    STATS_START(cull_start);
+    bool mapped = map_cells(&grid, &output);
+    STATS_STOP(CULL, cull_start);
+    if (!mapped) {
+        return 0;
+    }
+
+    return output.n_found;
+}
+
+size_t void_mapper_batch_workspace_size(const void_mapper_job_t *jobs, size_t n_jobs)
+{
+    void_mapper_count_t max_input = 0;
+    for (size_t j = 0; j < n_jobs; j++) {
+        max_input = jobs[j].input_length > max_input ? jobs[j].input_length : max_input;
+    }
+
+    return void_mapper_workspace_size(max_input);
+}
+
+size_t void_mapper_batch(void_mapper_job_t *jobs, size_t n_jobs, const void_mapper_workspace_t *workspace)
+{
+    void_mapper_count_t max_input = 0;
+    for (size_t j = 0; j < n_jobs; j++) {
+        max_input = jobs[j].input_length > max_input ? jobs[j].input_length : max_input;
+    }
+
+    /* The grid laid out for the longest input serves every job */
+    grid_t grid;
+    bool ready = grid_init(&grid, workspace, max_input);
+
+    size_t n_failed = 0;
+    for (size_t j = 0; j < n_jobs; j++) {
+        void_mapper_job_t *job = &jobs[j];
+        job->result = 0;
+
+        if (job->buffer == NULL || job->buffer_length == 0) {
+            n_failed++;
+            continue;
+        }
+
+        if (job->input == NULL || job->input_length == 0) {
+            job->buffer[0] = job->area;
+            job->result = 1;
+            continue;
+        }
+
+        if (!ready) {
+            n_failed++;
+            continue;
+        }
+
+        grid_layer_t layer = { .rectangles = job->input, .length = job->input_length, .weight = GRID_BLOCKER };
+        grid_build(&grid, job->area, &layer, 1);
+
+        output_t output = { .buffer = job->buffer, .buffer_length = job->buffer_length };
+        STATS_START(cull_start);
+        bool mapped = map_cells(&grid, &output);
+        STATS_STOP(CULL, cull_start);
+        if (!mapped) {
+            n_failed++;
+            continue;
+        }
+
+        job->result = output.n_found;
+    }
+
+    return n_failed;
+}
+
+void_mapper_count_t void_mapper_soa(void_mapper_rectangle_t area,
+                                    const void_mapper_coord_t *x, const void_mapper_coord_t *y, const void_mapper_coord_t *width, const void_mapper_coord_t *height,
+                                    void_mapper_count_t input_length, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                    const void_mapper_workspace_t *workspace)
+{
+    if (buffer == NULL || buffer_length == 0) {
+        return 0;
+    }
+
+    if (x == NULL || y == NULL || width == NULL || height == NULL || input_length == 0) {
+        buffer[0] = area;
+        return 1;
+    }
+
+    grid_t grid;
+    if (!grid_init(&grid, workspace, input_length)) {
+        return 0;
+    }
+
+    grid_layer_t layer = { .x = x, .y = y, .width = width, .height = height, .length = input_length, .weight = GRID_BLOCKER };
+    grid_build(&grid, area, &layer, 1);
+
+    output_t output = { .buffer = buffer, .buffer_length = buffer_length };
+    STATS_START(cull_start);
+    bool mapped = map_cells(&grid, &output);
+    STATS_STOP(CULL, cull_start);
+    if (!mapped) {
+        return 0;
+    }
+
+    return output.n_found;
+}
+
+void_mapper_count_t void_mapper_grouped(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                        void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace)
+{
+    if (buffer == NULL || buffer_length == 0) {
+        return 0;
+    }
+
+    if (input == NULL || input_length == 0) {
+        buffer[0] = area;
+        return 1;
+    }
+
+    grid_t grid;
+    if (!grid_init(&grid, workspace, input_length)) {
+        return 0;
+    }
+
+    grid_layer_t layer = { .rectangles = input, .length = input_length, .weight = GRID_BLOCKER };
+    grid_build(&grid, area, &layer, 1);
+
+    output_t output = { .buffer = buffer, .buffer_length = buffer_length };
+    STATS_START(cull_start);
+    bool mapped = map_grouped(&grid, &output);
+    STATS_STOP(CULL, cull_start);
+    if (!mapped) {
+        return 0;
+    }
+
+    return output.n_found;
+}
+
+static bool map_buckets(const void_mapper_index_t *index, const void_mapper_rectangle_t *input,
+                        const void_mapper_workspace_t *workspace, output_t *output)
+{
+    void_mapper_rectangle_t *gathered = workspace->memory;
+    size_t gathered_size = (size_t) index->max_bucket * sizeof(void_mapper_rectangle_t);
+    void_mapper_workspace_t grid_workspace = {
+        .memory = (uint8_t *) workspace->memory + gathered_size,
+        .size = workspace->size - gathered_size,
+    };
+
+    uint64_t x1 = (uint64_t) index->area.position.x + index->area.size.x;
+    uint64_t y1 = (uint64_t) index->area.position.y + index->area.size.y;
+    for (void_mapper_count_t by = 0; by < index->rows; by++) {
+        for (void_mapper_count_t bx = 0; bx < index->columns; bx++) {
+            uint64_t x = (uint64_t) index->area.position.x + (uint64_t) bx * index->bucket_size;
+            uint64_t y = (uint64_t) index->area.position.y + (uint64_t) by * index->bucket_size;
+            void_mapper_rectangle_t bucket = {
+                .position = { .x = x, .y = y },
+                .size = {
+                    .x = x1 - x < index->bucket_size ? x1 - x : index->bucket_size,
+                    .y = y1 - y < index->bucket_size ? y1 - y : index->bucket_size,
+                },
+            };
+
+            size_t b = (size_t) by * index->columns + bx;
+            void_mapper_count_t n_gathered = 0;
+            for (uint32_t r = index->starts[b]; r < index->starts[b + 1]; r++) {
+                gathered[n_gathered++] = input[index->refs[r]];
+            }
+
+            if (n_gathered == 0) {
+                if (!output_push(output, bucket)) {
+                    return false;
+                }
+                continue;
+            }
+
+            grid_t grid;
+            if (!grid_init(&grid, &grid_workspace, n_gathered)) {
+                return false;
+            }
+
+            grid_layer_t layer = { .rectangles = gathered, .length = n_gathered, .weight = GRID_BLOCKER };
+            grid_build(&grid, bucket, &layer, 1);
+            if (!map_grouped(&grid, output)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+size_t void_mapper_indexed_workspace_size(const void_mapper_index_t *index, void_mapper_count_t buffer_length)
+{
+    /* The rectangles of a bucket are gathered ahead of the grid of the bucket */
+    size_t mapping = (size_t) index->max_bucket * sizeof(void_mapper_rectangle_t) + void_mapper_workspace_size(index->max_bucket);
+
+    /* The grouping runs once every bucket is mapped, in the same memory */
+    size_t grouping = void_mapper_group_workspace_size(buffer_length);
+    return mapping > grouping ? mapping : grouping;
+}
+
+void_mapper_count_t void_mapper_indexed(const void_mapper_index_t *index, const void_mapper_rectangle_t *input,
+                                        void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace)
+{
+    if (index == NULL || buffer == NULL || buffer_length == 0 || workspace == NULL || workspace->memory == NULL ||
+        workspace->size < void_mapper_indexed_workspace_size(index, buffer_length)) {
+        return 0;
+    }
+
+    output_t output = { .buffer = buffer, .buffer_length = buffer_length };
+    STATS_START(cull_start);
+    bool mapped = map_buckets(index, input, workspace, &output);
+    STATS_STOP(CULL, cull_start);
+    if (!mapped) {
+        return 0;
+    }
+
+    /* Join the voids cut by the edges of the buckets */
+    return void_mapper_group_with_workspace(buffer, output.n_found, workspace);
+}
+
+uint64_t void_mapper_cost(const void_mapper_cost_t *cost, const void_mapper_rectangle_t *rectangles, void_mapper_count_t length)
+{
+    uint64_t pixels = 0;
+    for (void_mapper_count_t i = 0; i < length; i++) {
+        pixels += (uint64_t) rectangles[i].size.x * rectangles[i].size.y;
+    }
+
+    return (uint64_t) length * cost->per_command + pixels * cost->per_pixel;
+}
+
+void_mapper_count_t void_mapper_overdraw(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                         const void_mapper_cost_t *cost, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                         const void_mapper_workspace_t *workspace)
+{
+    void_mapper_count_t length = void_mapper_grouped(area, input, input_length, buffer, buffer_length, workspace);
+    if (length < 2 || cost == NULL) {
+        return length;
+    }
+
+    STATS_START(group_start);
+    bool merged;
+    uint32_t round = 0;
+    do {
+        merged = false;
+        length = merge_pass(buffer, length, true, cost, &merged);
+        length = merge_pass(buffer, length, false, cost, &merged);
+        length = absorb_pass(buffer, length, cost, &merged);
+        STATS_ADD(merge_passes, 3);
+    } while (merged && ++round < GROUP_ROUNDS);
+
+    sort_rectangles(buffer, length, compare_raster);
+    STATS_STOP(GROUP, group_start);
+
+    return length;
+}
+
+static uint8_t split_aligned(void_mapper_rectangle_t rectangle, void_mapper_coord_t x, void_mapper_coord_t y,
+                             void_mapper_rectangle_t pieces[5], uint8_t *aligned)
+{
+    uint64_t x0 = rectangle.position.x;
+    uint64_t y0 = rectangle.position.y;
+    uint64_t x1 = x0 + rectangle.size.x;
+    uint64_t y1 = y0 + rectangle.size.y;
+
+    /* Largest aligned part: the edges rounded inwards */
+    uint64_t ax0 = (x0 + x - 1) / x * x;
+    uint64_t ay0 = (y0 + y - 1) / y * y;
+    uint64_t ax1 = x1 / x * x;
+    uint64_t ay1 = y1 / y * y;
+
+    if (ax0 >= ax1 || ay0 >= ay1) {
+        pieces[0] = rectangle;
+        *aligned = 5;
+        return 1;
+    }
+
+    uint8_t n = 0;
+    if (ay0 > y0) {
+        pieces[n++] = (void_mapper_rectangle_t) { { x0, y0 }, { x1 - x0, ay0 - y0 } };
+    }
+    if (ax0 > x0) {
+        pieces[n++] = (void_mapper_rectangle_t) { { x0, ay0 }, { ax0 - x0, ay1 - ay0 } };
+    }
+    *aligned = n;
+    pieces[n++] = (void_mapper_rectangle_t) { { ax0, ay0 }, { ax1 - ax0, ay1 - ay0 } };
+    if (x1 > ax1) {
+        pieces[n++] = (void_mapper_rectangle_t) { { ax1, ay0 }, { x1 - ax1, ay1 - ay0 } };
+    }
+    if (y1 > ay1) {
+        pieces[n++] = (void_mapper_rectangle_t) { { x0, ay1 }, { x1 - x0, y1 - ay1 } };
+    }
+
+    return n;
+}
+
+void_mapper_count_t void_mapper_aligned(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                        void_mapper_alignment_t *alignment, void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace)
+{
+    alignment->n_aligned = 0;
+    alignment->n_unaligned = 0;
+    void_mapper_coord_t x = alignment->x > 0 ? alignment->x : 1;
+    void_mapper_coord_t y = alignment->y > 0 ? alignment->y : 1;
+
+    void_mapper_count_t length = void_mapper_grouped(area, input, input_length, buffer, buffer_length, workspace);
+
+    /* Count the pieces first, so that the voids can be split in place from the last one */
+    void_mapper_rectangle_t pieces[5];
+    uint8_t aligned;
+    size_t total = 0;
+    for (void_mapper_count_t i = 0; i < length; i++) {
+        total += split_aligned(buffer[i], x, y, pieces, &aligned);
+    }
+    if (total > buffer_length) {
+        return 0;
+    }
+
+    /* The pieces of a void end at or after it, so the voids before it are still unread */
+    size_t end = total;
+    for (void_mapper_count_t i = length; i-- > 0;) {
+        uint8_t n = split_aligned(buffer[i], x, y, pieces, &aligned);
+        end -= n;
+        memcpy(&buffer[end], pieces, n * sizeof(pieces[0]));
+        alignment->n_aligned += aligned < n;
+        alignment->n_unaligned += n - (aligned < n);
+    }
+
+    return total;
+}
+
+void_mapper_count_t void_mapper_anytime(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                        const void_mapper_budget_t *budget, void_mapper_progress_t *progress,
+                                        void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace)
+{
+    if (buffer == NULL || buffer_length == 0 || progress->n_exact >= buffer_length) {
+        return 0;
+    }
+
+    if (input == NULL || input_length == 0) {
+        buffer[0] = area;
+        progress->refined = coordinates_end(area.position.y, area.size.y);
+        progress->n_exact = 1;
+        progress->exact = true;
+        return 1;
+    }
+
+    if (progress->exact) {
+        return progress->n_exact;
+    }
+
+    /* Building the grid comes out of the budget too, without it only the cover is given */
+    uint64_t grid_steps = VOID_MAPPER_WCET_GRID_STEPS(input_length);
+    uint32_t operations = grid_steps < UINT32_MAX ? (uint32_t) grid_steps : UINT32_MAX;
+    if (budget_spent(budget, operations)) {
+        return progress->n_exact + cover_band(area, progress->refined, input, input_length,
+                                              &buffer[progress->n_exact], buffer_length - progress->n_exact);
+    }
+
+    grid_t grid;
+    if (!grid_init(&grid, workspace, input_length)) {
+        return 0;
+    }
+
+    grid_layer_t layer = { .rectangles = input, .length = input_length, .weight = GRID_BLOCKER };
+    grid_build(&grid, area, &layer, 1);
+
+    /* Carry on from the first row not refined yet */
+    void_mapper_count_t rows = grid_rows(&grid);
+    void_mapper_count_t row = 0;
+    while (row < rows && grid.y_vector[row] < progress->refined) {
+        row++;
+    }
+
+    /* The voids reaching down to that row may still grow, find them back in the buffer */
+    grouping_t grouping;
+    group_start(&grid, &grouping);
+    for (void_mapper_count_t i = 0; i < progress->n_exact && row > 0; i++) {
+        if ((uint32_t) buffer[i].position.y + buffer[i].size.y != (uint32_t) grid.y_vector[row]) {
+            continue;
+        }
+
+        void_mapper_count_t k = grouping.n_above++;
+        while (k > 0 && buffer[grouping.above[k - 1]].position.x > buffer[i].position.x) {
+            grouping.above[k] = grouping.above[k - 1];
+            k--;
+        }
+        grouping.above[k] = i;
+    }
+
+    /* A row is only started when all its runs fit, and the cover of the rows after it */
+    output_t output = { .buffer = buffer, .buffer_length = buffer_length, .n_found = progress->n_exact };
+    void_mapper_count_t columns = grid_columns(&grid);
+    STATS_START(cull_start);
+    for (; row < rows; row++) {
+        uint32_t cover = row + 1 < rows ? (uint32_t) input_length + 1 : 0;
+        operations += columns + grid.n_spans;
+        if (budget_spent(budget, operations) || output.buffer_length - output.n_found < (uint32_t) columns / 2 + 1 + cover) {
+            break;
+        }
+
+        group_row(&grid, &output, &grouping, row);
+    }
+    STATS_STOP(CULL, cull_start);
+
+    progress->n_exact = output.n_found;
+    progress->exact = row == rows;
+    if (progress->exact) {
+        progress->refined = coordinates_end(area.position.y, area.size.y);
+        return progress->n_exact;
+    }
+
+    /* The rows left are covered around the input crossing them */
+    progress->refined = grid.y_vector[row];
+    return progress->n_exact + cover_band(area, progress->refined, input, input_length,
+                                          &buffer[progress->n_exact], buffer_length - progress->n_exact);
+}
+
+void_mapper_count_t void_mapper_count(void_mapper_rectangle_t area, void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                      const void_mapper_workspace_t *workspace)
+{
+    if (input == NULL || input_length == 0) {
+        return 1;
+    }
+
+    grid_t grid;
+    if (!grid_init(&grid, workspace, input_length)) {
+        return 0;
+    }
+
+    grid_layer_t layer = { .rectangles = input, .length = input_length, .weight = GRID_BLOCKER };
+    grid_build(&grid, area, &layer, 1);
+
+    output_t output = { 0 };
+    STATS_START(cull_start);
+    map_cells(&grid, &output);
+    STATS_STOP(CULL, cull_start);
+
+    /* More voids than a count can hold would wrap around to a small, wrong buffer length */
+    return output.n_found > VOID_MAPPER_COUNT_MAX ? VOID_MAPPER_COUNT_MAX : output.n_found;
+}
+
+void_mapper_count_t void_mapper(void_mapper_rectangle_t area, void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                                                void_mapper_rectangle_t * buffer, void_mapper_count_t buffer_length)
+{
+    if (buffer == NULL || buffer_length == 0) {
+        return 0;
+    }
+
+    if (input == NULL || input_length == 0) {
+        buffer[0] = area;
+        return 1;
+    }
+
+#ifdef VOID_MAPPER_DETERMINISTIC
+    /* The workspace of the largest input, the stack used does not depend on the input */
+    void_mapper_word_t memory[(VOID_MAPPER_WORKSPACE_SIZE(VOID_MAPPER_MAX_SPRITES) + sizeof(void_mapper_word_t) - 1) / sizeof(void_mapper_word_t)];
+#else
+    /* The workspace grows linearly with the input */
+    void_mapper_word_t memory[(void_mapper_workspace_size(input_length) + sizeof(void_mapper_word_t) - 1) / sizeof(void_mapper_word_t)];
+#endif
+    void_mapper_workspace_t workspace = { .memory = memory, .size = sizeof(memory) };
+
+    return void_mapper_with_workspace(area, input, input_length, buffer, buffer_length, &workspace);
+}
+
+uint32_t void_mapper_stream(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                            void_mapper_emit_t emit, void *context, const void_mapper_workspace_t *workspace)
+{
+    if (emit == NULL) {
+        return 0;
+    }
+
+    if (input == NULL || input_length == 0) {
+        return emit(context, &area) ? 1 : 0;
+    }
+
+    grid_t grid;
+    if (!grid_init(&grid, workspace, input_length)) {
+        return 0;
+    }
+
+    grid_layer_t layer = { .rectangles = input, .length = input_length, .weight = GRID_BLOCKER };
+    grid_build(&grid, area, &layer, 1);
+
+    output_t output = { .emit = emit, .context = context };
+    STATS_START(cull_start);
+    map_cells(&grid, &output);
+    STATS_STOP(CULL, cull_start);
+
+    return output.n_found;
+}
+
+void_mapper_count_t void_mapper_residue(void_mapper_rectangle_t area,
+                                        const void_mapper_rectangle_t *previous, void_mapper_count_t previous_length,
+                                        const void_mapper_rectangle_t *current, void_mapper_count_t current_length,
+                                        const void_mapper_rectangle_t *dirty, void_mapper_count_t dirty_length,
+                                        void_mapper_rectangle_t *buffer, void_mapper_count_t buffer_length,
+                                        const void_mapper_workspace_t *workspace)
+{
+    previous_length = previous == NULL ? 0 : previous_length;
+    current_length = current == NULL ? 0 : current_length;
+    dirty_length = dirty == NULL ? 0 : dirty_length;
+
+    void_mapper_word_t total_length = (void_mapper_word_t) previous_length + current_length + dirty_length;
+    if (buffer == NULL || buffer_length == 0 || total_length > VOID_MAPPER_COUNT_MAX) {
+        return 0;
+    }
+
+    grid_t grid;
+    if (!grid_init(&grid, workspace, total_length)) {
+        return 0;
+    }
+
+    grid_layer_t layers[] = {
+        { .rectangles = previous, .length = previous_length, .weight = GRID_TARGET },
+        { .rectangles = dirty, .length = dirty_length, .weight = GRID_TARGET },
+        { .rectangles = current, .length = current_length, .weight = GRID_BLOCKER },
+    };
+    grid_build(&grid, area, layers, sizeof(layers) / sizeof(layers[0]));
+
+    output_t output = { .buffer = buffer, .buffer_length = buffer_length };
+    STATS_START(cull_start);
+    bool mapped = map_runs(&grid, &output);
+    STATS_STOP(CULL, cull_start);
+    if (!mapped) {
+        return 0;
+    }
+
+    return output.n_found;
 }
@@ -0,0 +1,124 @@
+#include <check.h>
+#include <stdlib.h>
+#include "void_mapper.h"
+#include "fixtures.h"
+#include "suites.h"
+
+#define MAX_INPUT 4
+#define MAX_VOIDS 16
+
+static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(MAX_INPUT) / sizeof(void_mapper_word_t) + 1];
+static void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+static void_mapper_word_t memory[VOID_MAPPER_CACHE_SIZE(2, MAX_INPUT, MAX_VOIDS) / sizeof(void_mapper_word_t) + 1];
+static void_mapper_rectangle_t buffer[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+static const void_mapper_count_t buffer_length = sizeof(buffer) / sizeof(buffer[0]);
+static void_mapper_rectangle_t expected[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+static const void_mapper_rectangle_t area = RECTANGLE(0, 0, 100, 200);
+
+static void assert_same(const void_mapper_rectangle_t *a, const void_mapper_rectangle_t *b, void_mapper_count_t length)
+{
+    for (void_mapper_count_t i = 0; i < length; i++) {
+        ck_assert_uint_eq(a[i].position.x, b[i].position.x);
+        ck_assert_uint_eq(a[i].position.y, b[i].position.y);
+        ck_assert_uint_eq(a[i].size.x, b[i].size.x);
+        ck_assert_uint_eq(a[i].size.y, b[i].size.y);
+    }
+}
+
+START_TEST(case_cache_hit)
+{
+    void_mapper_cache_t cache;
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+
+    ck_assert(void_mapper_cache_init(&cache, 2, MAX_INPUT, MAX_VOIDS, memory, sizeof(memory)));
+
+    void_mapper_count_t n_expected = void_mapper_with_workspace(area, square, 1, expected, buffer_length, &workspace);
+    ck_assert_uint_eq(void_mapper_cached(&cache, area, square, 1, buffer, buffer_length, &workspace), n_expected);
+    ck_assert_uint_eq(cache.misses, 1);
+
+    // The same input is answered from the cache, without a workspace
+    ck_assert_uint_eq(void_mapper_cached(&cache, area, square, 1, buffer, buffer_length, NULL), n_expected);
+    assert_same(expected, buffer, n_expected);
+    ck_assert_uint_eq(cache.hits, 1);
+
+    // Any change of the area or the input is a miss
+    square[0].size.x = 11;
+    void_mapper_cached(&cache, area, square, 1, buffer, buffer_length, &workspace);
+    void_mapper_rectangle_t other_area = RECTANGLE(0, 0, 100, 199);
+    void_mapper_cached(&cache, other_area, square, 1, buffer, buffer_length, &workspace);
+    ck_assert_uint_eq(cache.hits, 1);
+    ck_assert_uint_eq(cache.misses, 3);
+
+    // A hit with a buffer too small
+    ck_assert_uint_eq(void_mapper_cached(&cache, other_area, square, 1, buffer, 2, NULL), 0);
+    ck_assert_uint_eq(cache.hits, 2);
+}
+END_TEST
+
+START_TEST(case_cache_clock)
+{
+    void_mapper_cache_t cache;
+    void_mapper_rectangle_t layouts[3][1] = { { RECTANGLE(10, 10, 10, 10) }, { RECTANGLE(20, 20, 10, 10) }, { RECTANGLE(30, 30, 10, 10) } };
+
+    ck_assert(void_mapper_cache_init(&cache, 2, MAX_INPUT, MAX_VOIDS, memory, sizeof(memory)));
+
+    // A is hit before C comes, so B is the one replaced
+    void_mapper_cached(&cache, area, layouts[0], 1, buffer, buffer_length, &workspace);
+    void_mapper_cached(&cache, area, layouts[1], 1, buffer, buffer_length, &workspace);
+    void_mapper_cached(&cache, area, layouts[0], 1, buffer, buffer_length, &workspace);
+    void_mapper_cached(&cache, area, layouts[2], 1, buffer, buffer_length, &workspace);
+    ck_assert_uint_eq(cache.evictions, 1);
+
+    void_mapper_cached(&cache, area, layouts[0], 1, buffer, buffer_length, NULL);
+    ck_assert_uint_eq(cache.hits, 2);
+    void_mapper_cached(&cache, area, layouts[2], 1, buffer, buffer_length, NULL);
+    ck_assert_uint_eq(cache.hits, 3);
+    void_mapper_cached(&cache, area, layouts[1], 1, buffer, buffer_length, &workspace);
+    ck_assert_uint_eq(cache.misses, 4);
+
+    void_mapper_cache_clear(&cache);
+    void_mapper_cached(&cache, area, layouts[0], 1, buffer, buffer_length, &workspace);
+    ck_assert_uint_eq(cache.misses, 5);
+}
+END_TEST
+
+START_TEST(case_cache_limits)
+{
+    void_mapper_cache_t cache;
+    void_mapper_rectangle_t squares[2] = { RECTANGLE(20, 20, 10, 10), RECTANGLE(0, 0, 100, 200) };
+
+    ck_assert(!void_mapper_cache_init(&cache, 2, MAX_INPUT, MAX_VOIDS, memory, void_mapper_cache_size(2, MAX_INPUT, MAX_VOIDS) - 1));
+    ck_assert(!void_mapper_cache_init(&cache, 0, MAX_INPUT, MAX_VOIDS, memory, sizeof(memory)));
+    ck_assert(void_mapper_cache_init(&cache, 2, MAX_INPUT, 4, memory, sizeof(memory)));
+
+    // More voids than an entry holds, and no void at all, are mapped every time
+    void_mapper_count_t n_voids = void_mapper_cached(&cache, area, squares, 1, buffer, buffer_length, &workspace);
+    ck_assert_uint_eq(n_voids, 8);
+    ck_assert_uint_eq(void_mapper_cached(&cache, area, squares, 1, buffer, buffer_length, &workspace), 8);
+    ck_assert_uint_eq(void_mapper_cached(&cache, area, squares, 2, buffer, buffer_length, &workspace), 0);
+    ck_assert_uint_eq(void_mapper_cached(&cache, area, squares, 2, buffer, buffer_length, &workspace), 0);
+    ck_assert_uint_eq(cache.hits, 0);
+
+    // No input at all
+    ck_assert_uint_eq(void_mapper_cached(&cache, area, NULL, 0, buffer, buffer_length, NULL), 1);
+    ck_assert_uint_eq(void_mapper_cached(&cache, area, NULL, 0, buffer, buffer_length, NULL), 1);
+    ck_assert_uint_eq(cache.hits, 1);
+}
+END_TEST
+
+Suite * cache_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Cache");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_cache_hit);
+    tcase_add_test(tc_core, case_cache_clock);
+    tcase_add_test(tc_core, case_cache_limits);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
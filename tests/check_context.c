@@ -0,0 +1,208 @@
+#include <check.h>
+#include <stdlib.h>
+#include "void_mapper.h"
+#include "suites.h"
+
+#define RECTANGLE(px, py, sw, sl)               \
+        (void_mapper_rectangle_t) {             \
+            .position = { .x = px, .y = py},    \
+            .size = { .x = sw, .y = sl },       \
+        }                                       \
+
+#define CAPACITY 8
+
+static void_mapper_word_t memory[VOID_MAPPER_CTX_SIZE(CAPACITY) / sizeof(void_mapper_word_t) + 1];
+static void_mapper_rectangle_t expected[VOID_MAPPER_MIN_BUFFER_LENGTH(CAPACITY)];
+static void_mapper_rectangle_t actual[VOID_MAPPER_MIN_BUFFER_LENGTH(CAPACITY)];
+static const void_mapper_count_t length = sizeof(actual) / sizeof(actual[0]);
+
+/* Compare the voids of the context with void_mapper() run on the same rectangles */
+static void assert_same_as_void_mapper(const void_mapper_ctx_t *ctx)
+{
+    void_mapper_rectangle_t input[CAPACITY];
+    void_mapper_count_t input_length = 0;
+    for (void_mapper_count_t i = 0; i < ctx->capacity; i++) {
+        if (ctx->used[i]) {
+            input[input_length++] = ctx->rectangles[i];
+        }
+    }
+
+    void_mapper_count_t n_expected = void_mapper(ctx->area, input, input_length, expected, length);
+    void_mapper_count_t n_actual = void_mapper_ctx_voids(ctx, actual, length);
+
+    ck_assert_uint_eq(n_expected, n_actual);
+    ck_assert_mem_eq(expected, actual, n_actual * sizeof(actual[0]));
+}
+
+START_TEST(case_ctx_init)
+{
+    void_mapper_ctx_t ctx;
+    void_mapper_rectangle_t area = RECTANGLE(0, 0, 100, 200);
+
+    ck_assert(!void_mapper_ctx_init(&ctx, area, CAPACITY, memory, void_mapper_ctx_size(CAPACITY) - 1));
+    ck_assert(void_mapper_ctx_init(&ctx, area, CAPACITY, memory, sizeof(memory)));
+
+    void_mapper_count_t result = void_mapper_ctx_voids(&ctx, actual, length);
+    ck_assert_uint_eq(result, 1);
+    ck_assert_mem_eq(&actual[0], &area, sizeof(area));
+}
+END_TEST
+
+START_TEST(case_ctx_add_move_remove)
+{
+    void_mapper_ctx_t ctx;
+    ck_assert(void_mapper_ctx_init(&ctx, RECTANGLE(0, 0, 100, 200), CAPACITY, memory, sizeof(memory)));
+
+    void_mapper_handle_t a = void_mapper_ctx_add(&ctx, RECTANGLE(20, 20, 10, 10));
+    void_mapper_handle_t b = void_mapper_ctx_add(&ctx, RECTANGLE(40, 40, 5, 5));
+    ck_assert_uint_ne(a, VOID_MAPPER_INVALID_HANDLE);
+    ck_assert_uint_ne(b, VOID_MAPPER_INVALID_HANDLE);
+    assert_same_as_void_mapper(&ctx);
+
+    /* Share an edge with the other rectangle */
+    ck_assert(void_mapper_ctx_move(&ctx, b, RECTANGLE(30, 20, 5, 10)));
+    assert_same_as_void_mapper(&ctx);
+
+    /* Partially outside the area */
+    ck_assert(void_mapper_ctx_move(&ctx, a, RECTANGLE(95, 195, 10, 10)));
+    assert_same_as_void_mapper(&ctx);
+
+    ck_assert(void_mapper_ctx_remove(&ctx, a));
+    ck_assert(!void_mapper_ctx_remove(&ctx, a));
+    ck_assert(!void_mapper_ctx_move(&ctx, a, RECTANGLE(0, 0, 1, 1)));
+    assert_same_as_void_mapper(&ctx);
+
+    ck_assert(void_mapper_ctx_remove(&ctx, b));
+    assert_same_as_void_mapper(&ctx);
+    ck_assert_uint_eq(ctx.x_len, 2);
+    ck_assert_uint_eq(ctx.y_len, 2);
+}
+END_TEST
+
+START_TEST(case_ctx_full)
+{
+    void_mapper_ctx_t ctx;
+    ck_assert(void_mapper_ctx_init(&ctx, RECTANGLE(0, 0, 100, 200), 1, memory, sizeof(memory)));
+
+    ck_assert_uint_ne(void_mapper_ctx_add(&ctx, RECTANGLE(20, 20, 10, 10)), VOID_MAPPER_INVALID_HANDLE);
+    ck_assert_uint_eq(void_mapper_ctx_add(&ctx, RECTANGLE(40, 40, 5, 5)), VOID_MAPPER_INVALID_HANDLE);
+}
+END_TEST
+
+START_TEST(case_ctx_random)
+{
+    void_mapper_ctx_t ctx;
+    void_mapper_handle_t handles[CAPACITY];
+    ck_assert(void_mapper_ctx_init(&ctx, RECTANGLE(10, 20, 100, 80), CAPACITY, memory, sizeof(memory)));
+
+    srand(7);
+    for (void_mapper_count_t i = 0; i < CAPACITY; i++) {
+        handles[i] = void_mapper_ctx_add(&ctx, RECTANGLE(rand() % 120, rand() % 120, rand() % 40, rand() % 40));
+    }
+    assert_same_as_void_mapper(&ctx);
+
+    for (int step = 0; step < 500; step++) {
+        void_mapper_count_t i = rand() % CAPACITY;
+        /* Coarse coordinates to make the rectangles share edges often */
+        void_mapper_rectangle_t rectangle = RECTANGLE((rand() % 12) * 10, (rand() % 12) * 10, (rand() % 5) * 10, (rand() % 5) * 10);
+
+        if (handles[i] == VOID_MAPPER_INVALID_HANDLE) {
+            handles[i] = void_mapper_ctx_add(&ctx, rectangle);
+        } else if (rand() % 4 == 0) {
+            ck_assert(void_mapper_ctx_remove(&ctx, handles[i]));
+            handles[i] = VOID_MAPPER_INVALID_HANDLE;
+        } else {
+            ck_assert(void_mapper_ctx_move(&ctx, handles[i], rectangle));
+        }
+
+        assert_same_as_void_mapper(&ctx);
+    }
+}
+END_TEST
+
+START_TEST(case_ctx_dirty_voids)
+{
+    void_mapper_ctx_t ctx;
+    ck_assert(void_mapper_ctx_init(&ctx, RECTANGLE(0, 0, 100, 200), CAPACITY, memory, sizeof(memory)));
+
+    void_mapper_handle_t a = void_mapper_ctx_add(&ctx, RECTANGLE(20, 20, 10, 10));
+    void_mapper_ctx_add(&ctx, RECTANGLE(60, 60, 10, 10));
+
+    /* The changed region is the two rectangles apart, not the cells between them */
+    ck_assert_uint_eq(ctx.n_dirty, 2);
+    ck_assert_uint_eq(void_mapper_ctx_dirty_voids(&ctx, actual, length), 0);
+    ck_assert_uint_eq(ctx.n_dirty, 0);
+
+    /* Moving 5 pixels to the right leaves a 5 pixel residue to the left */
+    ck_assert(void_mapper_ctx_move(&ctx, a, RECTANGLE(25, 20, 10, 10)));
+    void_mapper_count_t result = void_mapper_ctx_dirty_voids(&ctx, actual, length);
+
+    void_mapper_rectangle_t residue = RECTANGLE(20, 20, 5, 10);
+    ck_assert_uint_eq(result, 1);
+    ck_assert_mem_eq(&actual[0], &residue, sizeof(residue));
+
+    /* Nothing changed since */
+    ck_assert_uint_eq(void_mapper_ctx_dirty_voids(&ctx, actual, length), 0);
+}
+END_TEST
+
+START_TEST(case_ctx_dirty_corners)
+{
+    void_mapper_ctx_t ctx;
+    ck_assert(void_mapper_ctx_init(&ctx, RECTANGLE(0, 0, 100, 200), CAPACITY, memory, sizeof(memory)));
+
+    void_mapper_handle_t a = void_mapper_ctx_add(&ctx, RECTANGLE(0, 0, 10, 10));
+    void_mapper_handle_t b = void_mapper_ctx_add(&ctx, RECTANGLE(90, 190, 10, 10));
+    void_mapper_ctx_dirty_voids(&ctx, actual, length);
+
+    /* Sprites in opposite corners move apart, only their residues are returned */
+    ck_assert(void_mapper_ctx_move(&ctx, a, RECTANGLE(5, 0, 10, 10)));
+    ck_assert(void_mapper_ctx_move(&ctx, b, RECTANGLE(85, 190, 10, 10)));
+    ck_assert_uint_eq(ctx.n_dirty, 2);
+
+    void_mapper_rectangle_t residues[] = {
+        RECTANGLE(0, 0, 5, 10),
+        RECTANGLE(95, 190, 5, 10),
+    };
+    ck_assert_uint_eq(void_mapper_ctx_dirty_voids(&ctx, actual, length), 2);
+    ck_assert_mem_eq(actual, residues, sizeof(residues));
+
+    /* More changes apart than the context keeps are merged, and their residues still returned */
+    void_mapper_handle_t handles[VOID_MAPPER_CTX_DIRTY + 1];
+    for (void_mapper_count_t i = 0; i <= VOID_MAPPER_CTX_DIRTY; i++) {
+        handles[i] = void_mapper_ctx_add(&ctx, RECTANGLE(30, 20 + 20 * i, 10, 10));
+    }
+    void_mapper_ctx_dirty_voids(&ctx, actual, length);
+    for (void_mapper_count_t i = 0; i <= VOID_MAPPER_CTX_DIRTY; i++) {
+        ck_assert(void_mapper_ctx_remove(&ctx, handles[i]));
+    }
+    ck_assert_uint_le(ctx.n_dirty, VOID_MAPPER_CTX_DIRTY);
+
+    void_mapper_count_t result = void_mapper_ctx_dirty_voids(&ctx, actual, length);
+    uint64_t cleared = 0;
+    for (void_mapper_count_t i = 0; i < result; i++) {
+        cleared += (uint64_t) actual[i].size.x * actual[i].size.y;
+    }
+    ck_assert_uint_ge(cleared, 100 * (VOID_MAPPER_CTX_DIRTY + 1));
+}
+END_TEST
+
+Suite * context_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Context");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_ctx_init);
+    tcase_add_test(tc_core, case_ctx_add_move_remove);
+    tcase_add_test(tc_core, case_ctx_full);
+    tcase_add_test(tc_core, case_ctx_random);
+    tcase_add_test(tc_core, case_ctx_dirty_voids);
+    tcase_add_test(tc_core, case_ctx_dirty_corners);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
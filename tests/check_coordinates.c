@@ -0,0 +1,142 @@
+#include <check.h>
+#include <stdlib.h>
+#include "coordinates.h"
+#include "suites.h"
+
+#define LENGTH(arr) (sizeof(arr) / sizeof(arr[0]))
+
+static void assert_vector(const void_mapper_coord_t *expected, void_mapper_count_t expected_length,
+                          const void_mapper_coord_t *actual, void_mapper_count_t actual_length)
+{
+    ck_assert_uint_eq(expected_length, actual_length);
+    for (void_mapper_count_t i = 0; i < expected_length; i++) {
+        ck_assert_msg(expected[i] == actual[i], "n: %lu, expected %lu, got %lu",
+                      (unsigned long) i, (unsigned long) expected[i], (unsigned long) actual[i]);
+    }
+}
+
+START_TEST(case_sort)
+{
+    void_mapper_coord_t vector[] = { 300, 20, 65535, 0, 256, 20, 1, 511, 255 };
+    void_mapper_coord_t scratch[LENGTH(vector)];
+    void_mapper_coord_t expected[] = { 0, 1, 20, 20, 255, 256, 300, 511, 65535 };
+
+    coordinates_sort(vector, scratch, LENGTH(vector));
+
+    assert_vector(expected, LENGTH(expected), vector, LENGTH(vector));
+}
+END_TEST
+
+START_TEST(case_sort_single_byte)
+{
+    /* Only the low byte differs, the result is in the scratch after the first pass */
+    void_mapper_coord_t vector[] = { 7, 3, 5, 1 };
+    void_mapper_coord_t scratch[LENGTH(vector)];
+    void_mapper_coord_t expected[] = { 1, 3, 5, 7 };
+
+    coordinates_sort(vector, scratch, LENGTH(vector));
+
+    assert_vector(expected, LENGTH(expected), vector, LENGTH(vector));
+}
+END_TEST
+
+#if VOID_MAPPER_COORD_BITS == 32
+START_TEST(case_sort_wide)
+{
+    /* Coordinates past 16 bits take the upper passes of the sort */
+    void_mapper_coord_t vector[] = { 70000, 20, 4000000000u, 65536, 65535, 0 };
+    void_mapper_coord_t scratch[LENGTH(vector)];
+    void_mapper_coord_t expected[] = { 0, 20, 65535, 65536, 70000, 4000000000u };
+
+    coordinates_sort(vector, scratch, LENGTH(vector));
+
+    assert_vector(expected, LENGTH(expected), vector, LENGTH(vector));
+}
+END_TEST
+#endif
+
+START_TEST(case_sort_random)
+{
+    void_mapper_coord_t vector[1000];
+    void_mapper_coord_t scratch[LENGTH(vector)];
+
+    srand(42);
+    for (void_mapper_count_t i = 0; i < LENGTH(vector); i++) {
+        vector[i] = (void_mapper_coord_t) rand();
+    }
+
+    coordinates_sort(vector, scratch, LENGTH(vector));
+
+    for (void_mapper_count_t i = 1; i < LENGTH(vector); i++) {
+        ck_assert_uint_le(vector[i - 1], vector[i]);
+    }
+}
+END_TEST
+
+START_TEST(case_unique_clamp)
+{
+    void_mapper_coord_t vector[] = { 0, 5, 10, 10, 10, 20, 30, 30, 40, 50 };
+    void_mapper_coord_t expected[] = { 10, 20, 30, 40 };
+
+    void_mapper_count_t len = coordinates_unique_clamp(vector, LENGTH(vector), 10, 40);
+
+    assert_vector(expected, LENGTH(expected), vector, len);
+}
+END_TEST
+
+START_TEST(case_prepare)
+{
+    /* Tile grid sharing edges, as well as a box outside the area */
+    void_mapper_coord_t vector[] = { 0, 100, 10, 20, 20, 30, 30, 40, 120, 130 };
+    void_mapper_coord_t scratch[LENGTH(vector)];
+    void_mapper_coord_t expected[] = { 0, 10, 20, 30, 40, 100 };
+
+    void_mapper_count_t len = coordinates_prepare(vector, scratch, LENGTH(vector), 0, 100);
+
+    assert_vector(expected, LENGTH(expected), vector, len);
+}
+END_TEST
+
+START_TEST(case_lower_bound)
+{
+    void_mapper_coord_t vector[] = { 0, 10, 20, 30 };
+
+    ck_assert_uint_eq(coordinates_lower_bound(vector, LENGTH(vector), 0), 0);
+    ck_assert_uint_eq(coordinates_lower_bound(vector, LENGTH(vector), 10), 1);
+    ck_assert_uint_eq(coordinates_lower_bound(vector, LENGTH(vector), 15), 2);
+    ck_assert_uint_eq(coordinates_lower_bound(vector, LENGTH(vector), 31), 4);
+}
+END_TEST
+
+START_TEST(case_end)
+{
+    ck_assert_uint_eq(coordinates_end(10, 20), 30);
+    ck_assert_uint_eq(coordinates_end(VOID_MAPPER_COORD_MAX - 10, 10), VOID_MAPPER_COORD_MAX);
+    ck_assert_uint_eq(coordinates_end(VOID_MAPPER_COORD_MAX - 10, 11), VOID_MAPPER_COORD_MAX);
+    ck_assert_uint_eq(coordinates_end(VOID_MAPPER_COORD_MAX, VOID_MAPPER_COORD_MAX), VOID_MAPPER_COORD_MAX);
+}
+END_TEST
+
+Suite * coordinates_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Coordinates");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_sort);
+    tcase_add_test(tc_core, case_sort_single_byte);
+#if VOID_MAPPER_COORD_BITS == 32
+    tcase_add_test(tc_core, case_sort_wide);
+#endif
+    tcase_add_test(tc_core, case_sort_random);
+    tcase_add_test(tc_core, case_unique_clamp);
+    tcase_add_test(tc_core, case_prepare);
+    tcase_add_test(tc_core, case_lower_bound);
+    tcase_add_test(tc_core, case_end);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
@@ -0,0 +1,167 @@
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "fixtures.h"
+#include "suites.h"
+
+#define MAX_INPUT 8
+
+static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(MAX_INPUT) / sizeof(void_mapper_word_t) + 1];
+static void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+static void_mapper_rectangle_t expected[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+static void_mapper_rectangle_t decoded[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+static const void_mapper_rectangle_t area = RECTANGLE(0, 0, 240, 320);
+
+/* Column and row address set then a fill, as on ILI9341 and ST7789 class controllers */
+static const void_mapper_field_t window_fields[] = {
+    { .kind = VOID_MAPPER_FIELD_BYTE, .value = 0x2A },
+    { .kind = VOID_MAPPER_FIELD_LEFT, .size = 2 },
+    { .kind = VOID_MAPPER_FIELD_RIGHT, .size = 2 },
+    { .kind = VOID_MAPPER_FIELD_BYTE, .value = 0x2B },
+    { .kind = VOID_MAPPER_FIELD_TOP, .size = 2 },
+    { .kind = VOID_MAPPER_FIELD_BOTTOM, .size = 2 },
+    { .kind = VOID_MAPPER_FIELD_BYTE, .value = 0x2C },
+};
+static const void_mapper_encoder_t window = { .fields = window_fields, .n_fields = 7, .big_endian = true };
+
+/**
+ * @brief Read a value of the stream.
+ */
+static uint32_t read_value(const uint8_t *bytes, uint8_t size, bool big_endian)
+{
+    uint32_t value = 0;
+    for (uint8_t b = 0; b < size; b++) {
+        value |= (uint32_t) bytes[b] << (8 * (big_endian ? size - 1 - b : b));
+    }
+    return value;
+}
+
+/**
+ * @brief Decode the address window commands back to rectangles.
+ */
+static void_mapper_count_t decode_windows(const uint8_t *bytes, size_t length, void_mapper_rectangle_t *rectangles)
+{
+    ck_assert_uint_eq(length % 11, 0);
+    void_mapper_count_t n = 0;
+    for (size_t at = 0; at < length; at += 11) {
+        ck_assert_uint_eq(bytes[at], 0x2A);
+        ck_assert_uint_eq(bytes[at + 5], 0x2B);
+        ck_assert_uint_eq(bytes[at + 10], 0x2C);
+        uint32_t x0 = read_value(&bytes[at + 1], 2, true);
+        uint32_t x1 = read_value(&bytes[at + 3], 2, true);
+        uint32_t y0 = read_value(&bytes[at + 6], 2, true);
+        uint32_t y1 = read_value(&bytes[at + 8], 2, true);
+        rectangles[n++] = (void_mapper_rectangle_t) RECTANGLE(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    }
+    return n;
+}
+
+START_TEST(case_encode_resume)
+{
+    /* Room for 3 commands and a bit, the stream goes out in many buffers */
+    uint8_t dma_buffer[40];
+    void_mapper_dma_t dma = { .buffer = dma_buffer, .size = sizeof(dma_buffer) };
+    ck_assert_uint_eq(void_mapper_encoded_size(&window), 11);
+
+    srand(20);
+    void_mapper_rectangle_t input[MAX_INPUT];
+    for (int round = 0; round < 20; round++) {
+        void_mapper_count_t input_length = 1 + rand() % MAX_INPUT;
+        for (void_mapper_count_t i = 0; i < input_length; i++) {
+            input[i] = (void_mapper_rectangle_t) RECTANGLE(rand() % 250, rand() % 330, rand() % 80, rand() % 80);
+        }
+
+        void_mapper_count_t n_expected = void_mapper(area, input, input_length, expected, VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT));
+
+        void_mapper_count_t n_decoded = 0;
+        dma.n_done = 0;
+        do {
+            uint32_t n = void_mapper_encode(area, input, input_length, &window, &dma, &workspace);
+            ck_assert_uint_le(dma.length, dma.size);
+            ck_assert_uint_eq(decode_windows(dma_buffer, dma.length, &decoded[n_decoded]), n);
+            ck_assert(n > 0 || dma.done);
+            n_decoded += n;
+        } while (!dma.done);
+
+        ck_assert_uint_eq(n_decoded, n_expected);
+        ck_assert_uint_eq(dma.n_done, n_expected);
+        ck_assert_mem_eq(decoded, expected, n_expected * sizeof(expected[0]));
+    }
+}
+END_TEST
+
+START_TEST(case_encode_fields)
+{
+    static const void_mapper_field_t fields[] = {
+        { .kind = VOID_MAPPER_FIELD_BYTE, .value = 0x22 },
+        { .kind = VOID_MAPPER_FIELD_LEFT, .size = 1 },
+        { .kind = VOID_MAPPER_FIELD_TOP, .size = 1 },
+        { .kind = VOID_MAPPER_FIELD_WIDTH, .size = 3 },
+        { .kind = VOID_MAPPER_FIELD_HEIGHT, .size = 2 },
+        { .kind = VOID_MAPPER_FIELD_PIXELS, .size = 4 },
+    };
+    void_mapper_encoder_t encoder = { .fields = fields, .n_fields = 6, .big_endian = false };
+    void_mapper_rectangle_t square[1] = { RECTANGLE(0, 0, 240, 300) };
+    uint8_t dma_buffer[32];
+    void_mapper_dma_t dma = { .buffer = dma_buffer, .size = sizeof(dma_buffer) };
+
+    // Only the bottom band is void
+    ck_assert_uint_eq(void_mapper_encode(area, square, 1, &encoder, &dma, &workspace), 1);
+    ck_assert(dma.done);
+    const uint8_t bytes[] = { 0x22, 0, 44, 240, 0, 0, 20, 0, 0xC0, 0x12, 0, 0 };
+    ck_assert_uint_eq(dma.length, sizeof(bytes));
+    ck_assert_mem_eq(dma_buffer, bytes, sizeof(bytes));
+
+    // Resuming past the end encodes nothing more
+    ck_assert_uint_eq(void_mapper_encode(area, square, 1, &encoder, &dma, &workspace), 0);
+    ck_assert(dma.done);
+    ck_assert_uint_eq(dma.length, 0);
+}
+END_TEST
+
+START_TEST(case_encode_limits)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    uint8_t dma_buffer[16];
+    void_mapper_dma_t dma = { .buffer = dma_buffer, .size = 10 };
+
+    // The buffer cannot hold a single command
+    ck_assert_uint_eq(void_mapper_encode(area, square, 1, &window, &dma, &workspace), 0);
+    ck_assert(!dma.done);
+
+    // The workspace is too small
+    dma.size = sizeof(dma_buffer);
+    void_mapper_workspace_t small = { .memory = arena, .size = void_mapper_workspace_size(1) - 1 };
+    ck_assert_uint_eq(void_mapper_encode(area, square, 1, &window, &dma, &small), 0);
+    ck_assert(!dma.done);
+
+    // A field too wide
+    void_mapper_field_t wide[1] = { { .kind = VOID_MAPPER_FIELD_LEFT, .size = 5 } };
+    void_mapper_encoder_t encoder = { .fields = wide, .n_fields = 1 };
+    ck_assert_uint_eq(void_mapper_encode(area, square, 1, &encoder, &dma, &workspace), 0);
+    ck_assert(!dma.done);
+
+    // Everything covered, nothing to encode
+    void_mapper_rectangle_t cover[1] = { area };
+    ck_assert_uint_eq(void_mapper_encode(area, cover, 1, &window, &dma, &workspace), 0);
+    ck_assert(dma.done);
+}
+END_TEST
+
+Suite * encode_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Encode");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_encode_resume);
+    tcase_add_test(tc_core, case_encode_fields);
+    tcase_add_test(tc_core, case_encode_limits);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
@@ -0,0 +1,157 @@
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "coverage.h"
+#include "fixtures.h"
+#include "suites.h"
+
+#define MAX_INPUT 200
+#define MAX_REFS 2000
+#define BUCKET 32
+
+static uint32_t memory[VOID_MAPPER_INDEX_SIZE(10 * 8, MAX_REFS) / sizeof(uint32_t) + 1];
+static void_mapper_word_t arena[(MAX_INPUT * sizeof(void_mapper_rectangle_t) + VOID_MAPPER_WORKSPACE_SIZE(MAX_INPUT) +
+                                 VOID_MAPPER_GROUP_WORKSPACE_SIZE(VOID_MAPPER_MIN_BUFFER_LENGTH(32))) / sizeof(void_mapper_word_t) + 1];
+static void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+static void_mapper_rectangle_t buffer[VOID_MAPPER_MIN_BUFFER_LENGTH(32)];
+static const void_mapper_count_t buffer_length = sizeof(buffer) / sizeof(buffer[0]);
+
+/**
+ * @brief Fill the input with rectangles of up to 40 by 30 pixels, some of them past the edges of the area.
+ */
+static void random_input(void_mapper_rectangle_t *input, void_mapper_count_t input_length)
+{
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        input[i] = (void_mapper_rectangle_t) RECTANGLE(rand() % 330, rand() % 250, 1 + rand() % 40, 1 + rand() % 30);
+    }
+}
+
+START_TEST(case_index_one_square)
+{
+    void_mapper_rectangle_t area = RECTANGLE(0, 0, 320, 240);
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 30, 30) };
+
+    void_mapper_index_t index;
+    ck_assert(void_mapper_index_build(&index, area, square, 1, BUCKET, memory, sizeof(memory)));
+    ck_assert_uint_eq(index.columns, 10);
+    ck_assert_uint_eq(index.rows, 8);
+    ck_assert_uint_eq(index.max_bucket, 1);
+
+    // The square crosses 4 buckets, grouping joins most of the voids cut by their edges, 6 against 4 without the index
+    void_mapper_count_t result = void_mapper_indexed(&index, square, buffer, buffer_length, &workspace);
+    coverage_assert_exact(area, square, 1, buffer, result);
+    ck_assert_uint_eq(result, 6);
+
+    void_mapper_count_t found[2];
+    ck_assert_uint_eq(void_mapper_index_find(&index, square, (void_mapper_rectangle_t) RECTANGLE(0, 0, 320, 240), found, 2), 1);
+    ck_assert_uint_eq(found[0], 0);
+    ck_assert_uint_eq(void_mapper_index_find(&index, square, (void_mapper_rectangle_t) RECTANGLE(50, 0, 10, 240), found, 2), 0);
+}
+END_TEST
+
+START_TEST(case_index_random)
+{
+    void_mapper_rectangle_t input[MAX_INPUT];
+    void_mapper_rectangle_t areas[] = { RECTANGLE(0, 0, 320, 240), RECTANGLE(10, 5, 300, 230) };
+
+    srand(23);
+    for (int round = 0; round < 40; round++) {
+        void_mapper_rectangle_t area = areas[round % 2];
+        void_mapper_count_t input_length = 1 + rand() % 60;
+        random_input(input, input_length);
+
+        void_mapper_index_t index;
+        ck_assert(void_mapper_index_build(&index, area, input, input_length, BUCKET, memory, sizeof(memory)));
+        ck_assert_uint_le(void_mapper_indexed_workspace_size(&index, buffer_length), sizeof(arena));
+
+        void_mapper_count_t result = void_mapper_indexed(&index, input, buffer, buffer_length, &workspace);
+        ck_assert_uint_gt(result, 0);
+        coverage_assert_exact(area, input, input_length, buffer, result);
+    }
+}
+END_TEST
+
+START_TEST(case_index_find)
+{
+    void_mapper_rectangle_t input[MAX_INPUT];
+    void_mapper_count_t found[MAX_INPUT];
+    void_mapper_rectangle_t area = RECTANGLE(0, 0, 320, 240);
+
+    srand(29);
+    random_input(input, MAX_INPUT);
+    void_mapper_index_t index;
+    ck_assert(void_mapper_index_build(&index, area, input, MAX_INPUT, BUCKET, memory, sizeof(memory)));
+
+    for (int round = 0; round < 100; round++) {
+        void_mapper_rectangle_t region = RECTANGLE(rand() % 320, rand() % 240, 1 + rand() % 100, 1 + rand() % 100);
+        uint32_t n_found = void_mapper_index_find(&index, input, region, found, MAX_INPUT);
+        ck_assert_uint_eq(void_mapper_index_find(&index, input, region, NULL, 0), n_found);
+
+        // Same rectangles as testing all of them, each found once, the region being within the area
+        uint32_t expected = 0;
+        for (void_mapper_count_t i = 0; i < MAX_INPUT; i++) {
+            bool crosses = input[i].position.x < region.position.x + region.size.x && region.position.x < input[i].position.x + input[i].size.x &&
+                           input[i].position.y < region.position.y + region.size.y && region.position.y < input[i].position.y + input[i].size.y &&
+                           input[i].position.x < 320 && input[i].position.y < 240;
+            if (!crosses) {
+                continue;
+            }
+
+            expected++;
+            uint32_t times = 0;
+            for (uint32_t f = 0; f < n_found; f++) {
+                times += found[f] == i;
+            }
+            ck_assert_uint_eq(times, 1);
+        }
+        ck_assert_uint_eq(n_found, expected);
+    }
+}
+END_TEST
+
+START_TEST(case_index_limits)
+{
+    void_mapper_rectangle_t area = RECTANGLE(0, 0, 320, 240);
+    void_mapper_rectangle_t wide[1] = { RECTANGLE(0, 0, 320, 240) };
+    void_mapper_index_t index;
+
+    // The rectangle needs one reference per bucket
+    size_t size = void_mapper_index_size(area, BUCKET, 80);
+    ck_assert_uint_eq(size, VOID_MAPPER_INDEX_SIZE(80, 80));
+    ck_assert(!void_mapper_index_build(&index, area, wide, 1, BUCKET, memory, size - 1));
+    ck_assert(void_mapper_index_build(&index, area, wide, 1, BUCKET, memory, size));
+    ck_assert(!void_mapper_index_build(&index, area, wide, 1, 0, memory, sizeof(memory)));
+    ck_assert_uint_eq(void_mapper_index_size(area, 0, 80), 0);
+
+    // Fully covered, then an empty input leaves a void per bucket, grouped into the whole area
+    ck_assert_uint_eq(void_mapper_indexed(&index, wide, buffer, buffer_length, &workspace), 0);
+    ck_assert(void_mapper_index_build(&index, area, NULL, 0, BUCKET, memory, sizeof(memory)));
+    ck_assert_uint_eq(void_mapper_indexed(&index, NULL, buffer, buffer_length, &workspace), 1);
+    ck_assert_mem_eq(&buffer[0], &area, sizeof(area));
+
+    // Buffer too small for the voids of the buckets, workspace too small for the grouping of the buffer
+    ck_assert_uint_eq(void_mapper_indexed(&index, NULL, buffer, 79, &workspace), 0);
+    ck_assert_uint_eq(void_mapper_indexed_workspace_size(&index, buffer_length), void_mapper_group_workspace_size(buffer_length));
+    void_mapper_workspace_t small = { .memory = arena, .size = void_mapper_indexed_workspace_size(&index, buffer_length) - 1 };
+    ck_assert_uint_eq(void_mapper_indexed(&index, NULL, buffer, buffer_length, &small), 0);
+}
+END_TEST
+
+Suite * index_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Index");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_index_one_square);
+    tcase_add_test(tc_core, case_index_random);
+    tcase_add_test(tc_core, case_index_find);
+    tcase_add_test(tc_core, case_index_limits);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
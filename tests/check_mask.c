@@ -0,0 +1,114 @@
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "coverage.h"
+#include "fixtures.h"
+#include "suites.h"
+
+#define MAX_INPUT 16
+#define MAX_WIDTH 128
+#define HEIGHT 60
+#define STRIDE (MAX_WIDTH / 8 + 3)
+
+static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(MAX_INPUT) / sizeof(void_mapper_word_t) + 1];
+static void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+static void_mapper_rectangle_t buffer[MAX_WIDTH * HEIGHT];
+static const void_mapper_count_t buffer_length = sizeof(buffer) / sizeof(buffer[0]);
+static uint8_t pixels[STRIDE * HEIGHT];
+
+/**
+ * @brief Draw rectangles on the mask, clipped to its size.
+ */
+static void draw(void_mapper_coord_t width, const void_mapper_rectangle_t *input, void_mapper_count_t input_length)
+{
+    memset(pixels, 0, sizeof(pixels));
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        for (unsigned y = input[i].position.y; y < (unsigned) input[i].position.y + input[i].size.y && y < HEIGHT; y++) {
+            for (unsigned x = input[i].position.x; x < (unsigned) input[i].position.x + input[i].size.x && x < width; x++) {
+                pixels[y * STRIDE + x / 8] |= 1 << (x % 8);
+            }
+        }
+    }
+}
+
+START_TEST(case_mask_one_square)
+{
+    void_mapper_rectangle_t area = RECTANGLE(0, 0, 100, HEIGHT);
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    draw(100, square, 1);
+
+    void_mapper_count_t result = void_mapper_mask(pixels, STRIDE, 100, HEIGHT, buffer, buffer_length, &workspace);
+
+    ck_assert_uint_eq(result, 4);
+    coverage_assert_exact(area, square, 1, buffer, result);
+
+    // Without a mask the whole area is void
+    ck_assert_uint_eq(void_mapper_mask(NULL, STRIDE, 100, HEIGHT, buffer, buffer_length, &workspace), 1);
+    ck_assert_uint_eq(buffer[0].size.x, 100);
+    ck_assert_uint_eq(buffer[0].size.y, HEIGHT);
+}
+END_TEST
+
+START_TEST(case_mask_random)
+{
+    static void_mapper_rectangle_t grouped[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+    void_mapper_rectangle_t input[MAX_INPUT];
+
+    srand(19);
+    for (int round = 0; round < 100; round++) {
+        /* Widths around and on the 64 pixel words */
+        void_mapper_coord_t widths[] = { 1, 63, 64, 100, 128 };
+        void_mapper_coord_t width = widths[round % 5];
+        void_mapper_rectangle_t area = RECTANGLE(0, 0, width, HEIGHT);
+        void_mapper_count_t input_length = 1 + rand() % MAX_INPUT;
+        for (void_mapper_count_t i = 0; i < input_length; i++) {
+            input[i] = (void_mapper_rectangle_t) RECTANGLE(rand() % (width + 10), rand() % 70, rand() % 40, rand() % 20);
+        }
+        draw(width, input, input_length);
+
+        void_mapper_count_t result = void_mapper_mask(pixels, STRIDE, width, HEIGHT, buffer, buffer_length, &workspace);
+        void_mapper_count_t n_grouped = void_mapper_grouped(area, input, input_length, grouped, VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT), &workspace);
+
+        // Pixel runs merge the same way as the runs of the grid
+        ck_assert_uint_eq(result, n_grouped);
+        ck_assert_mem_eq(buffer, grouped, result * sizeof(buffer[0]));
+    }
+}
+END_TEST
+
+START_TEST(case_mask_limits)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    draw(100, square, 1);
+
+    // Buffer too small, stride too short, workspace too small
+    ck_assert_uint_eq(void_mapper_mask(pixels, STRIDE, 100, HEIGHT, buffer, 3, &workspace), 0);
+    ck_assert_uint_eq(void_mapper_mask(pixels, 12, 100, HEIGHT, buffer, buffer_length, &workspace), 0);
+    void_mapper_workspace_t small = { .memory = arena, .size = void_mapper_mask_workspace_size(100) - 1 };
+    ck_assert_uint_eq(void_mapper_mask(pixels, STRIDE, 100, HEIGHT, buffer, buffer_length, &small), 0);
+    small.size++;
+    ck_assert_uint_eq(void_mapper_mask(pixels, STRIDE, 100, HEIGHT, buffer, buffer_length, &small), 4);
+
+    // A full mask has no void
+    memset(pixels, 0xff, sizeof(pixels));
+    ck_assert_uint_eq(void_mapper_mask(pixels, STRIDE, 100, HEIGHT, buffer, buffer_length, &workspace), 0);
+}
+END_TEST
+
+Suite * mask_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Mask");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_mask_one_square);
+    tcase_add_test(tc_core, case_mask_random);
+    tcase_add_test(tc_core, case_mask_limits);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
@@ -0,0 +1,185 @@
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "void_mapper_parallel.h"
+#include "coverage.h"
+#include "fixtures.h"
+#include "suites.h"
+
+#define MAX_INPUT 16
+
+static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(MAX_INPUT) / sizeof(void_mapper_word_t) + 1];
+static void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+static void_mapper_rectangle_t buffer[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+static const void_mapper_count_t buffer_length = sizeof(buffer) / sizeof(buffer[0]);
+static const void_mapper_rectangle_t area = RECTANGLE(0, 0, 100, 200);
+
+START_TEST(case_parallel_one_square)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+
+    // The seams cut through the square and the voids around it, and are all stitched
+    void_mapper_count_t result = void_mapper_parallel(area, square, 1, buffer, buffer_length, 4);
+
+    ck_assert_uint_eq(result, 4);
+    coverage_assert_exact(area, square, 1, buffer, result);
+}
+END_TEST
+
+START_TEST(case_parallel_random)
+{
+    void_mapper_rectangle_t small_area = RECTANGLE(5, 5, 60, 50);
+    void_mapper_rectangle_t input[MAX_INPUT];
+    static void_mapper_rectangle_t grouped[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+
+    srand(13);
+    for (int round = 0; round < 200; round++) {
+        void_mapper_count_t input_length = 1 + rand() % MAX_INPUT;
+        for (void_mapper_count_t i = 0; i < input_length; i++) {
+            input[i] = (void_mapper_rectangle_t) RECTANGLE((rand() % 14) * 5, (rand() % 12) * 5, (rand() % 5) * 5, (rand() % 5) * 5);
+        }
+
+        unsigned int n_threads = 1 + round % 8;
+        void_mapper_count_t result = void_mapper_parallel(small_area, input, input_length, buffer, buffer_length, n_threads);
+        coverage_assert_exact(small_area, input, input_length, buffer, result);
+
+        // Stitching leaves no trace of the bands
+        void_mapper_count_t n_grouped = void_mapper_grouped(small_area, input, input_length, grouped, buffer_length, &workspace);
+        ck_assert_uint_eq(result, n_grouped);
+        for (void_mapper_count_t i = 0; i < result; i++) {
+            ck_assert_uint_eq(buffer[i].position.x, grouped[i].position.x);
+            ck_assert_uint_eq(buffer[i].position.y, grouped[i].position.y);
+            ck_assert_uint_eq(buffer[i].size.x, grouped[i].size.x);
+            ck_assert_uint_eq(buffer[i].size.y, grouped[i].size.y);
+        }
+    }
+}
+END_TEST
+
+START_TEST(case_parallel_edge_cases)
+{
+    void_mapper_rectangle_t squares[2] = { RECTANGLE(20, 20, 10, 10), RECTANGLE(0, 0, 100, 200) };
+    void_mapper_rectangle_t flat = RECTANGLE(0, 0, 100, 3);
+
+    ck_assert_uint_eq(void_mapper_parallel(area, NULL, 0, buffer, buffer_length, 4), 1);
+    ck_assert_uint_eq(void_mapper_parallel(area, squares, 1, buffer, 3, 4), 0);
+    ck_assert_uint_eq(void_mapper_parallel(area, squares, 1, NULL, 0, 4), 0);
+
+    // Fully covered
+    ck_assert_uint_eq(void_mapper_parallel(area, squares, 2, buffer, buffer_length, 4), 0);
+
+    // Fewer rows than bands, and one thread per processor
+    void_mapper_count_t result = void_mapper_parallel(flat, squares, 1, buffer, buffer_length, 0);
+    ck_assert_uint_eq(result, 1);
+    coverage_assert_exact(flat, squares, 1, buffer, result);
+}
+END_TEST
+
+#ifndef VOID_MAPPER_DETERMINISTIC
+START_TEST(case_parallel_many_cells)
+{
+    enum { N_BARS = 40, N_SQUARES = 154, N_INPUT = 2 * N_BARS + N_SQUARES };
+    static void_mapper_word_t large_arena[VOID_MAPPER_WORKSPACE_SIZE(N_INPUT) / sizeof(void_mapper_word_t) + 1];
+    static void_mapper_rectangle_t voids[VOID_MAPPER_COUNT_MAX < UINT16_MAX ? VOID_MAPPER_COUNT_MAX : UINT16_MAX];
+    static void_mapper_rectangle_t grouped[sizeof(voids) / sizeof(voids[0])];
+    void_mapper_workspace_t large = { .memory = large_arena, .size = sizeof(large_arena) };
+    void_mapper_rectangle_t screen = RECTANGLE(0, 0, 3840, 2160);
+    void_mapper_rectangle_t input[N_INPUT];
+
+    // Full height and full width bars, and one pixel squares in the top band: its void cells are past the bound of a count
+    for (int i = 0; i < N_BARS; i++) {
+        input[i] = (void_mapper_rectangle_t) RECTANGLE(96 * i + 10, 0, 4, 2160);
+        input[N_BARS + i] = (void_mapper_rectangle_t) RECTANGLE(0, 54 * i + 5, 3840, 2);
+    }
+    for (int i = 0; i < N_SQUARES; i++) {
+        input[2 * N_BARS + i] = (void_mapper_rectangle_t) RECTANGLE((29 * i + 7) % 3840, (37 * i) % 530 + 1, 1, 1);
+    }
+
+    void_mapper_count_t n_grouped = void_mapper_grouped(screen, input, N_INPUT, grouped, sizeof(grouped) / sizeof(grouped[0]), &large);
+    ck_assert_uint_gt(n_grouped, 0);
+
+    // The band buffers grow until the voids fit, whatever the number of cells
+    void_mapper_count_t result = void_mapper_parallel(screen, input, N_INPUT, voids, sizeof(voids) / sizeof(voids[0]), 1);
+    ck_assert_uint_eq(result, n_grouped);
+    ck_assert_mem_eq(voids, grouped, result * sizeof(voids[0]));
+}
+END_TEST
+#endif
+
+START_TEST(case_batch_parallel)
+{
+    enum { N_JOBS = 50 };
+    static void_mapper_rectangle_t inputs[N_JOBS][MAX_INPUT];
+    static void_mapper_rectangle_t outputs[N_JOBS][VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+    void_mapper_job_t jobs[N_JOBS];
+
+    srand(17);
+    for (int j = 0; j < N_JOBS; j++) {
+        jobs[j] = (void_mapper_job_t) {
+            .area = (void_mapper_rectangle_t) RECTANGLE(j * 10, 0, 60, 50),
+            .input = inputs[j],
+            .input_length = rand() % MAX_INPUT,
+            .buffer = outputs[j],
+            .buffer_length = j == 7 ? 1 : buffer_length,    /* <-- Too small, unless the input is empty */
+        };
+        for (void_mapper_count_t i = 0; i < jobs[j].input_length; i++) {
+            inputs[j][i] = (void_mapper_rectangle_t) RECTANGLE(j * 10 + (rand() % 14) * 5, (rand() % 12) * 5, 5 + (rand() % 4) * 5, 5 + (rand() % 4) * 5);
+        }
+    }
+
+    size_t n_failed = void_mapper_batch_parallel(jobs, N_JOBS, 3);
+    ck_assert_uint_eq(n_failed, jobs[7].input_length > 0 ? 1 : 0);
+
+    for (int j = 0; j < N_JOBS; j++) {
+        if (j == 7) {
+            continue;
+        }
+        void_mapper_count_t result = void_mapper_with_workspace(jobs[j].area, inputs[j], jobs[j].input_length, buffer, buffer_length, &workspace);
+        ck_assert_uint_eq(jobs[j].result, result);
+        coverage_assert_exact(jobs[j].area, inputs[j], jobs[j].input_length, jobs[j].buffer, jobs[j].result);
+    }
+}
+END_TEST
+
+#ifdef VOID_MAPPER_STATS
+START_TEST(case_parallel_stats)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    void_mapper_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+
+    // The threads collect nothing, and the statistics are hooked again once they are done
+    void_mapper_stats_hook(&stats, NULL);
+    ck_assert_uint_eq(void_mapper_parallel(area, square, 1, buffer, buffer_length, 4), 4);
+    ck_assert_uint_eq(stats.cells, 0);
+
+    void_mapper(area, square, 1, buffer, buffer_length);
+    void_mapper_stats_hook(NULL, NULL);
+    ck_assert_uint_eq(stats.cells, 9);
+}
+END_TEST
+#endif
+
+Suite * parallel_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Parallel");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_parallel_one_square);
+    tcase_add_test(tc_core, case_parallel_random);
+    tcase_add_test(tc_core, case_parallel_edge_cases);
+#ifndef VOID_MAPPER_DETERMINISTIC
+    tcase_add_test(tc_core, case_parallel_many_cells);
+#endif
+    tcase_add_test(tc_core, case_batch_parallel);
+#ifdef VOID_MAPPER_STATS
+    tcase_add_test(tc_core, case_parallel_stats);
+#endif
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
@@ -0,0 +1,125 @@
+#include <check.h>
+#include <stdlib.h>
+#include "void_mapper.h"
+#include "coverage.h"
+#include "fixtures.h"
+#include "suites.h"
+
+#define MAX_INPUT 16
+
+static void_mapper_word_t arena[VOID_MAPPER_PARTITION_WORKSPACE_SIZE(MAX_INPUT) / sizeof(void_mapper_word_t) + 1];
+static void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+static void_mapper_rectangle_t buffer[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+static const void_mapper_count_t buffer_length = sizeof(buffer) / sizeof(buffer[0]);
+static const void_mapper_rectangle_t area = RECTANGLE(0, 0, 100, 200);
+
+START_TEST(case_partition_one_square)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+
+    void_mapper_count_t result = void_mapper_partition(area, square, 1, buffer, buffer_length, &workspace);
+
+    ck_assert_uint_eq(result, 4);
+    coverage_assert_exact(area, square, 1, buffer, result);
+}
+END_TEST
+
+START_TEST(case_partition_corner)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(0, 0, 10, 10) };
+
+    void_mapper_count_t result = void_mapper_partition(area, square, 1, buffer, buffer_length, &workspace);
+
+    ck_assert_uint_eq(result, 2);
+    coverage_assert_exact(area, square, 1, buffer, result);
+}
+END_TEST
+
+START_TEST(case_partition_good_chords)
+{
+    /* The top and bottom edges of the squares line up, cutting along them gives 5 rectangles */
+    void_mapper_rectangle_t squares[2] = {
+        RECTANGLE(20, 20, 10, 10),
+        RECTANGLE(40, 20, 10, 10),
+    };
+
+    void_mapper_count_t result = void_mapper_partition(area, squares, 2, buffer, buffer_length, &workspace);
+
+    ck_assert_uint_eq(result, 5);
+    coverage_assert_exact(area, squares, 2, buffer, result);
+}
+END_TEST
+
+START_TEST(case_partition_crossing_chords)
+{
+    /*
+     * Four squares around a center, both the horizontal and the vertical chords between them
+     * cross in the middle. Only one orientation can be used, giving 16 - 2 - 4 + 1 = 11
+     * rectangles (concave corners - independent chords - holes + 1).
+     */
+    void_mapper_rectangle_t squares[4] = {
+        RECTANGLE(40, 20, 10, 10),
+        RECTANGLE(20, 40, 10, 10),
+        RECTANGLE(60, 40, 10, 10),
+        RECTANGLE(40, 60, 10, 10),
+    };
+
+    void_mapper_count_t result = void_mapper_partition(area, squares, 4, buffer, buffer_length, &workspace);
+
+    coverage_assert_exact(area, squares, 4, buffer, result);
+    ck_assert_uint_eq(result, 16 - 2 - 4 + 1);
+}
+END_TEST
+
+START_TEST(case_partition_random)
+{
+    void_mapper_rectangle_t small_area = RECTANGLE(5, 5, 60, 50);
+    void_mapper_rectangle_t input[MAX_INPUT];
+    static void_mapper_rectangle_t grouped[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+
+    srand(3);
+    for (int round = 0; round < 200; round++) {
+        void_mapper_count_t input_length = 1 + rand() % MAX_INPUT;
+        for (void_mapper_count_t i = 0; i < input_length; i++) {
+            input[i] = (void_mapper_rectangle_t) RECTANGLE((rand() % 14) * 5, (rand() % 12) * 5, (rand() % 5) * 5, (rand() % 5) * 5);
+        }
+
+        void_mapper_count_t result = void_mapper_partition(small_area, input, input_length, buffer, buffer_length, &workspace);
+        coverage_assert_exact(small_area, input, input_length, buffer, result);
+
+        void_mapper_count_t n_grouped = void_mapper(small_area, input, input_length, grouped, buffer_length);
+        n_grouped = void_mapper_group(grouped, n_grouped);
+        ck_assert_uint_le(result, n_grouped);
+    }
+}
+END_TEST
+
+START_TEST(case_partition_workspace_too_small)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    void_mapper_workspace_t small = { .memory = arena, .size = void_mapper_partition_workspace_size(1) - 1 };
+
+    ck_assert_uint_eq(void_mapper_partition(area, square, 1, buffer, buffer_length, &small), 0);
+    ck_assert_uint_eq(void_mapper_partition(area, square, 1, buffer, 3, &workspace), 0);
+}
+END_TEST
+
+Suite * partition_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Partition");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_partition_one_square);
+    tcase_add_test(tc_core, case_partition_corner);
+    tcase_add_test(tc_core, case_partition_good_chords);
+    tcase_add_test(tc_core, case_partition_crossing_chords);
+    tcase_add_test(tc_core, case_partition_random);
+    tcase_add_test(tc_core, case_partition_workspace_too_small);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
@@ -0,0 +1,177 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "void_mapper_replay.h"
+#include "coverage.h"
+#include "fixtures.h"
+#include "suites.h"
+
+static char path[] = "/tmp/void_mapper_replay_XXXXXX";
+
+/**
+ * @brief Make a fresh path for a file of the test.
+ */
+static void make_path(void)
+{
+    strcpy(path, "/tmp/void_mapper_replay_XXXXXX");
+    int fd = mkstemp(path);
+    ck_assert_int_ge(fd, 0);
+    close(fd);
+}
+
+START_TEST(case_replay_round_trip)
+{
+    void_mapper_rectangle_t area = RECTANGLE(0, 0, 320, 240);
+    void_mapper_rectangle_t sprites[3] = {
+        RECTANGLE(10, 10, 20, 20),
+        RECTANGLE(100, 50, 30, 10),
+        RECTANGLE(200, 200, 40, 40),
+    };
+
+    make_path();
+    void_mapper_replay_writer_t writer;
+    ck_assert(void_mapper_replay_create(&writer, path, VOID_MAPPER_REPLAY_SCENES));
+    ck_assert(void_mapper_replay_write(&writer, area, sprites, 3));
+    ck_assert(void_mapper_replay_write(&writer, area, NULL, 0));
+    ck_assert(void_mapper_replay_write(&writer, area, &sprites[1], 1));
+    ck_assert(void_mapper_replay_finish(&writer));
+
+    // The results of another kind are not mistaken for scenes
+    void_mapper_replay_t replay;
+    ck_assert(!void_mapper_replay_open(&replay, path, VOID_MAPPER_REPLAY_VOIDS));
+    ck_assert(void_mapper_replay_open(&replay, path, VOID_MAPPER_REPLAY_SCENES));
+    ck_assert_uint_eq(replay.n_frames, 3);
+    ck_assert_uint_eq(replay.max_length, 3);
+    ck_assert_uint_eq(replay.n_rectangles, 4);
+
+    // The frames are read in place, in the order written
+    const void_mapper_replay_frame_t *frame = void_mapper_replay_first(&replay);
+    ck_assert_ptr_nonnull(frame);
+    ck_assert_uint_eq(frame->length, 3);
+    ck_assert_mem_eq(&frame->area, &area, sizeof(area));
+    ck_assert_mem_eq(void_mapper_replay_rectangles(frame), sprites, sizeof(sprites));
+
+    frame = void_mapper_replay_next(&replay, frame);
+    ck_assert_ptr_nonnull(frame);
+    ck_assert_uint_eq(frame->length, 0);
+
+    frame = void_mapper_replay_next(&replay, frame);
+    ck_assert_ptr_nonnull(frame);
+    ck_assert_uint_eq(frame->length, 1);
+    ck_assert_mem_eq(void_mapper_replay_rectangles(frame), &sprites[1], sizeof(sprites[1]));
+    ck_assert_ptr_null(void_mapper_replay_next(&replay, frame));
+
+    void_mapper_replay_close(&replay);
+    unlink(path);
+}
+END_TEST
+
+START_TEST(case_replay_invalid)
+{
+    static uint64_t data[64];
+    void_mapper_replay_header_t *header = (void_mapper_replay_header_t *) data;
+    void_mapper_replay_frame_t *frame = (void_mapper_replay_frame_t *) (header + 1);
+    void_mapper_replay_t replay;
+
+    memcpy(header->magic, VOID_MAPPER_REPLAY_SCENES, 4);
+    header->version = VOID_MAPPER_REPLAY_VERSION;
+    header->coord_bits = VOID_MAPPER_COORD_BITS;
+    header->n_frames = 1;
+    frame->length = 2;
+    size_t size = sizeof(*header) + sizeof(*frame) + 2 * sizeof(void_mapper_rectangle_t);
+    ck_assert(void_mapper_replay_load(&replay, data, size, VOID_MAPPER_REPLAY_SCENES));
+
+    // Cut short, in the rectangles and in the frame header
+    ck_assert(!void_mapper_replay_load(&replay, data, size - 1, VOID_MAPPER_REPLAY_SCENES));
+    ck_assert(!void_mapper_replay_load(&replay, data, sizeof(*header) + 4, VOID_MAPPER_REPLAY_SCENES));
+
+    // More frames than the file holds, a length past the end
+    header->n_frames = 2;
+    ck_assert(!void_mapper_replay_load(&replay, data, size, VOID_MAPPER_REPLAY_SCENES));
+    header->n_frames = 1;
+    frame->length = UINT32_MAX;
+    ck_assert(!void_mapper_replay_load(&replay, data, sizeof(data), VOID_MAPPER_REPLAY_SCENES));
+    frame->length = 2;
+
+    // Other coordinates or version
+    header->coord_bits = VOID_MAPPER_COORD_BITS == 16 ? 32 : 16;
+    ck_assert(!void_mapper_replay_load(&replay, data, size, VOID_MAPPER_REPLAY_SCENES));
+    header->coord_bits = VOID_MAPPER_COORD_BITS;
+    header->version++;
+    ck_assert(!void_mapper_replay_load(&replay, data, size, VOID_MAPPER_REPLAY_SCENES));
+
+    ck_assert(!void_mapper_replay_open(&replay, "/nonexistent/scenes", VOID_MAPPER_REPLAY_SCENES));
+}
+END_TEST
+
+#ifndef VOID_MAPPER_DETERMINISTIC
+START_TEST(case_replay_map_group)
+{
+    enum { N = 40, LENGTH = 8192 };
+    static void_mapper_rectangle_t squares[N * N];
+    static void_mapper_rectangle_t voids[LENGTH];
+    static void_mapper_rectangle_t expected[LENGTH];
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(N * N) / sizeof(void_mapper_word_t) + 1];
+    static void_mapper_word_t group_arena[VOID_MAPPER_GROUP_WORKSPACE_SIZE(LENGTH) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_workspace_t group_workspace = { .memory = group_arena, .size = sizeof(group_arena) };
+    void_mapper_rectangle_t area = RECTANGLE(0, 0, 3 * N, 3 * N);
+
+    // A lattice of small squares leaves thousands of voids in one frame
+    for (int i = 0; i < N * N; i++) {
+        squares[i] = (void_mapper_rectangle_t) RECTANGLE(1 + 3 * (i % N), 1 + 3 * (i / N), 1, 1);
+    }
+
+    make_path();
+    void_mapper_replay_writer_t writer;
+    ck_assert(void_mapper_replay_create(&writer, path, VOID_MAPPER_REPLAY_SCENES));
+    ck_assert(void_mapper_replay_write(&writer, area, squares, N * N));
+    ck_assert(void_mapper_replay_finish(&writer));
+
+    void_mapper_replay_t replay;
+    ck_assert(void_mapper_replay_open(&replay, path, VOID_MAPPER_REPLAY_SCENES));
+    const void_mapper_replay_frame_t *frame = void_mapper_replay_first(&replay);
+
+    // Without grouping, every void as found
+    void_mapper_count_t n_found = void_mapper_replay_map(frame, expected, LENGTH, &workspace, NULL);
+    ck_assert_uint_gt(n_found, 3 * N * N);
+    coverage_assert_exact(area, squares, N * N, expected, n_found);
+
+    // Grouped in the workspaces of the caller, as void_mapper_group() does on its own
+    void_mapper_count_t result = void_mapper_replay_map(frame, voids, LENGTH, &workspace, &group_workspace);
+    void_mapper_count_t n_expected = void_mapper_group(expected, n_found);
+    ck_assert_uint_lt(result, n_found);
+    ck_assert_uint_eq(result, n_expected);
+    ck_assert_mem_eq(voids, expected, result * sizeof(voids[0]));
+    coverage_assert_exact(area, squares, N * N, voids, result);
+
+    // A workspace too small for the voids fails the frame
+    group_workspace.size = void_mapper_group_workspace_size(LENGTH) / 2;
+    ck_assert_uint_eq(void_mapper_replay_map(frame, voids, LENGTH, &workspace, &group_workspace), 0);
+
+    void_mapper_replay_close(&replay);
+    unlink(path);
+}
+END_TEST
+#endif
+
+Suite * replay_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Replay");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_replay_round_trip);
+    tcase_add_test(tc_core, case_replay_invalid);
+#ifndef VOID_MAPPER_DETERMINISTIC
+    tcase_add_test(tc_core, case_replay_map_group);
+#endif
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
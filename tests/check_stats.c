@@ -0,0 +1,152 @@
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "void_mapper.h"
+#include "fixtures.h"
+#include "suites.h"
+
+static void_mapper_rectangle_t buffer[VOID_MAPPER_MIN_BUFFER_LENGTH(2)];
+static const void_mapper_count_t buffer_length = sizeof(buffer) / sizeof(buffer[0]);
+static const void_mapper_rectangle_t area = RECTANGLE(0, 0, 100, 200);
+
+#ifdef VOID_MAPPER_STATS
+
+static uint32_t ticks;
+
+static uint32_t fake_clock(void)
+{
+    return ticks++;
+}
+
+START_TEST(case_stats_one_square)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    void_mapper_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+
+    void_mapper_stats_hook(&stats, fake_clock);
+    void_mapper_count_t result = void_mapper(area, square, 1, buffer, buffer_length);
+    result = void_mapper_group(buffer, result);
+    void_mapper_stats_hook(NULL, NULL);
+
+    ck_assert_uint_eq(result, 4);
+    ck_assert_uint_eq(stats.x_len, 4);
+    ck_assert_uint_eq(stats.y_len, 4);
+    ck_assert_uint_eq(stats.cells, 9);
+    ck_assert_uint_eq(stats.culled, 1);
+    ck_assert_uint_eq(stats.span_tests, 3);
+    ck_assert_uint_eq(stats.duplicates, 0);
+
+    // The row above the square and the two sides down to the bottom merge in one pass
+    ck_assert_uint_eq(stats.merges, 4);
+    ck_assert_uint_eq(stats.merge_passes, 1);
+
+    for (int p = 0; p < VOID_MAPPER_PHASE_COUNT; p++) {
+        ck_assert_uint_gt(stats.ticks[p], 0);
+    }
+
+    // Nothing is collected once unhooked
+    void_mapper_stats_t before = stats;
+    void_mapper(area, square, 1, buffer, buffer_length);
+    ck_assert_mem_eq(&before, &stats, sizeof(stats));
+}
+END_TEST
+
+START_TEST(case_stats_duplicates)
+{
+    void_mapper_rectangle_t squares[2] = {
+        RECTANGLE(20, 20, 10, 10),
+        RECTANGLE(20, 30, 10, 300),    /* <-- Shares an x edge twice, and ends outside the area */
+    };
+    void_mapper_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+
+    void_mapper_stats_hook(&stats, NULL);
+    void_mapper(area, squares, 2, buffer, buffer_length);
+    void_mapper_stats_hook(NULL, NULL);
+
+    // 6 edges of each vector: x keeps 0, 20, 30, 100 and y keeps 0, 20, 30, 200
+    ck_assert_uint_eq(stats.x_len, 4);
+    ck_assert_uint_eq(stats.y_len, 4);
+    ck_assert_uint_eq(stats.duplicates, 4);
+    ck_assert_uint_eq(stats.culled, 2);
+
+    // Without a clock nothing is timed
+    for (int p = 0; p < VOID_MAPPER_PHASE_COUNT; p++) {
+        ck_assert_uint_eq(stats.ticks[p], 0);
+    }
+}
+END_TEST
+
+START_TEST(case_stats_wcet_steps)
+{
+    enum { N = 16 };
+    static void_mapper_rectangle_t voids[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    void_mapper_rectangle_t squares[N];
+    void_mapper_stats_t stats;
+
+    // Squares on a diagonal have edges of their own, the grid is as large as it gets
+    for (int n = 1; n <= N; n++) {
+        for (int i = 0; i < n; i++) {
+            squares[i] = (void_mapper_rectangle_t) RECTANGLE(1 + 6 * i, 1 + 12 * i, 5, 5);
+        }
+
+        memset(&stats, 0, sizeof(stats));
+        void_mapper_stats_hook(&stats, NULL);
+        void_mapper(area, squares, n, voids, VOID_MAPPER_MIN_BUFFER_LENGTH(N));
+        void_mapper_stats_hook(NULL, NULL);
+
+        ck_assert_uint_eq(stats.span_tests + stats.cells, VOID_MAPPER_WCET_CELL_STEPS(n));
+    }
+
+    // Any other input takes fewer steps
+    srand(22);
+    for (int round = 0; round < 50; round++) {
+        void_mapper_count_t n = 1 + rand() % N;
+        for (void_mapper_count_t i = 0; i < n; i++) {
+            squares[i] = (void_mapper_rectangle_t) RECTANGLE(rand() % 110, rand() % 210, rand() % 30, rand() % 30);
+        }
+
+        memset(&stats, 0, sizeof(stats));
+        void_mapper_stats_hook(&stats, NULL);
+        void_mapper(area, squares, n, voids, VOID_MAPPER_MIN_BUFFER_LENGTH(N));
+        void_mapper_stats_hook(NULL, NULL);
+
+        ck_assert_uint_le(stats.span_tests + stats.cells, VOID_MAPPER_WCET_CELL_STEPS(n));
+    }
+}
+END_TEST
+
+#endif /* VOID_MAPPER_STATS */
+
+START_TEST(case_stats_same_result)
+{
+    /* The statistics must not change the outcome, whether they are compiled in or not */
+    void_mapper_rectangle_t squares[2] = {
+        RECTANGLE(20, 20, 10, 10),
+        RECTANGLE(40, 40, 5, 5),
+    };
+
+    ck_assert_uint_eq(void_mapper(area, squares, 2, buffer, buffer_length), 23);
+}
+END_TEST
+
+Suite * stats_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Stats");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_stats_same_result);
+#ifdef VOID_MAPPER_STATS
+    tcase_add_test(tc_core, case_stats_one_square);
+    tcase_add_test(tc_core, case_stats_duplicates);
+    tcase_add_test(tc_core, case_stats_wcet_steps);
+#endif
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
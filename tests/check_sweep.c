@@ -0,0 +1,95 @@
+#include <check.h>
+#include <stdlib.h>
+#include "void_mapper.h"
+#include "coverage.h"
+#include "fixtures.h"
+#include "suites.h"
+
+#define MAX_INPUT 16
+
+static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(MAX_INPUT) / sizeof(void_mapper_word_t) + 1];
+static void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+static void_mapper_rectangle_t buffer[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+static const void_mapper_count_t buffer_length = sizeof(buffer) / sizeof(buffer[0]);
+static const void_mapper_rectangle_t area = RECTANGLE(0, 0, 100, 200);
+
+START_TEST(case_sweep_one_square)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+
+    void_mapper_count_t result = void_mapper_sweep(area, square, 1, buffer, buffer_length, &workspace);
+
+    ck_assert_uint_eq(result, 4);
+    coverage_assert_exact(area, square, 1, buffer, result);
+}
+END_TEST
+
+START_TEST(case_sweep_outside)
+{
+    void_mapper_rectangle_t squares[3] = {
+        RECTANGLE(95, 195, 10, 10),     /* <-- Partially outside the area */
+        RECTANGLE(150, 20, 10, 10),     /* <-- Outside the area */
+        RECTANGLE(40, 40, 0, 10),       /* <-- Empty */
+    };
+
+    void_mapper_count_t result = void_mapper_sweep(area, squares, 3, buffer, buffer_length, &workspace);
+
+    ck_assert_uint_eq(result, 2);
+    coverage_assert_exact(area, squares, 3, buffer, result);
+}
+END_TEST
+
+START_TEST(case_sweep_random)
+{
+    void_mapper_rectangle_t small_area = RECTANGLE(5, 5, 60, 50);
+    void_mapper_rectangle_t input[MAX_INPUT];
+    static void_mapper_rectangle_t grouped[VOID_MAPPER_MIN_BUFFER_LENGTH(MAX_INPUT)];
+
+    srand(11);
+    for (int round = 0; round < 200; round++) {
+        void_mapper_count_t input_length = 1 + rand() % MAX_INPUT;
+        for (void_mapper_count_t i = 0; i < input_length; i++) {
+            input[i] = (void_mapper_rectangle_t) RECTANGLE((rand() % 14) * 5, (rand() % 12) * 5, (rand() % 5) * 5, (rand() % 5) * 5);
+        }
+
+        void_mapper_count_t result = void_mapper_sweep(small_area, input, input_length, buffer, buffer_length, &workspace);
+        coverage_assert_exact(small_area, input, input_length, buffer, result);
+
+        // The strips are the runs of the grid merged with identical runs below them
+        void_mapper_count_t n_grouped = void_mapper_grouped(small_area, input, input_length, grouped, buffer_length, &workspace);
+        ck_assert_uint_eq(result, n_grouped);
+    }
+}
+END_TEST
+
+START_TEST(case_sweep_workspace_too_small)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    void_mapper_workspace_t small = { .memory = arena, .size = void_mapper_sweep_workspace_size(1) - 1 };
+
+    // The sweep needs far less than the grid
+    ck_assert_uint_lt(void_mapper_sweep_workspace_size(MAX_INPUT), void_mapper_workspace_size(MAX_INPUT));
+
+    ck_assert_uint_eq(void_mapper_sweep(area, square, 1, buffer, buffer_length, &small), 0);
+    ck_assert_uint_eq(void_mapper_sweep(area, square, 1, buffer, 3, &workspace), 0);
+    ck_assert_uint_eq(void_mapper_sweep(area, NULL, 0, buffer, buffer_length, NULL), 1);
+}
+END_TEST
+
+Suite * sweep_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Sweep");
+
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, case_sweep_one_square);
+    tcase_add_test(tc_core, case_sweep_outside);
+    tcase_add_test(tc_core, case_sweep_random);
+    tcase_add_test(tc_core, case_sweep_workspace_too_small);
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
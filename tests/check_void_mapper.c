@@ -2,16 +2,15 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
 #include "void_mapper.h"
-
-#define RECTANGLE(px, py, sw, sl)               \
-        {                                       \
-            .position = { .x = px, .y = py},    \
-            .size = { .x = sw, .y = sl },       \
-        }                                       \
+#include "suites.h"
+#include "coverage.h"
+#include "fixtures.h"
 
 void_mapper_rectangle_t input[1] = { 0 };
-uint16_t input_length = sizeof(input[0]) / sizeof(input);
+void_mapper_count_t input_length = sizeof(input[0]) / sizeof(input);
 
 void_mapper_rectangle_t area = {
     .position = { .x = 0, .y = 0},
@@ -19,7 +18,7 @@ void_mapper_rectangle_t area = {
 };
 
 void_mapper_rectangle_t buffer[512];
-uint16_t buffer_length = sizeof(buffer) / sizeof(buffer[0]);
+void_mapper_count_t buffer_length = sizeof(buffer) / sizeof(buffer[0]);
 
 static void assert_rectangle(void_mapper_rectangle_t expected, void_mapper_rectangle_t actual, unsigned int n)
 {
@@ -40,7 +39,7 @@ START_TEST(case_empty_input_size)
 {
     input_length = 0;
 
-    uint16_t result = void_mapper(area, input, input_length, buffer, buffer_length);
+    void_mapper_count_t result = void_mapper(area, input, input_length, buffer, buffer_length);
 
     ck_assert_mem_eq(&buffer[0], &area, sizeof(area));
     ck_assert_uint_eq(result, 1);
@@ -51,7 +50,7 @@ START_TEST(case_empty_input_ptr)
  {
     void_mapper_rectangle_t *input = NULL;
 
-    uint16_t result = void_mapper(area, input, input_length, buffer, buffer_length);
+    void_mapper_count_t result = void_mapper(area, input, input_length, buffer, buffer_length);
 
     ck_assert_mem_eq(&buffer[0], &area, sizeof(area));
     ck_assert_uint_eq(result, 1);
@@ -62,7 +61,7 @@ START_TEST(case_empty_buffer_ptr)
 {
     void_mapper_rectangle_t *buffer = NULL;
 
-    uint16_t result = void_mapper(area, input, input_length, buffer, buffer_length);
+    void_mapper_count_t result = void_mapper(area, input, input_length, buffer, buffer_length);
 
     ck_assert_uint_eq(result, 0);
 }
@@ -70,9 +69,9 @@ END_TEST
 
 START_TEST(case_empty_buffer_size)
 {
-    uint16_t buffer_length = 0;
+    void_mapper_count_t buffer_length = 0;
 
-    uint16_t result = void_mapper(area, input, input_length, buffer, buffer_length);
+    void_mapper_count_t result = void_mapper(area, input, input_length, buffer, buffer_length);
 
     ck_assert_uint_eq(result, 0);
 }
@@ -87,9 +86,9 @@ START_TEST(case_buffer_size)
 
     // One square in the middle of an area results in 8 voids. (see 'case_one_square_in_the_middle' to see that
     // this is correct)
-    uint16_t n_input_assets = 1;
-    uint16_t buffer_length = 7;
-    uint16_t result = void_mapper(area, input, n_input_assets, buffer, buffer_length);
+    void_mapper_count_t n_input_assets = 1;
+    void_mapper_count_t buffer_length = 7;
+    void_mapper_count_t result = void_mapper(area, input, n_input_assets, buffer, buffer_length);
     ck_assert_int_eq(result, 0);
 
     // Two squares results in 23 voids (see 'case_two_squares')
@@ -105,8 +104,8 @@ START_TEST(case_one_square_in_the_middle)
     void_mapper_rectangle_t square[1] = { { .position = { .x = 20, .y = 20},
                                             .size =     { .x = 10, .y = 10} } };
 
-    uint16_t buffer_length = 9;
-    uint16_t result = void_mapper(area, square, 1, buffer, buffer_length);
+    void_mapper_count_t buffer_length = 9;
+    void_mapper_count_t result = void_mapper(area, square, 1, buffer, buffer_length);
 
 
     void_mapper_rectangle_t expected[8] = {
@@ -130,8 +129,8 @@ START_TEST(case_two_squares)
         RECTANGLE(40, 40, 5, 5),
     };
 
-    uint16_t buffer_length = 23;
-    uint16_t result = void_mapper(area, squares, 2, buffer, buffer_length);
+    void_mapper_count_t buffer_length = 23;
+    void_mapper_count_t result = void_mapper(area, squares, 2, buffer, buffer_length);
 
     ck_assert_int_eq(result, 23);
     void_mapper_rectangle_t expected[23] = {
@@ -151,8 +150,8 @@ END_TEST
 
 START_TEST(case_one_square_inside_one_outside)
 {
-    uint16_t area_bottom_right_x = area.position.x + area.size.x;
-    uint16_t area_bottom_right_y =  area.position.y + area.size.y;
+    void_mapper_count_t area_bottom_right_x = area.position.x + area.size.x;
+    void_mapper_count_t area_bottom_right_y =  area.position.y + area.size.y;
 
     void_mapper_rectangle_t squares[2] = {
         RECTANGLE(20, 20, 10, 10),
@@ -160,7 +159,7 @@ START_TEST(case_one_square_inside_one_outside)
     };
 
     uint8_t expected_voids = 8;
-    uint16_t result = void_mapper(area, squares, 2, buffer, expected_voids);
+    void_mapper_count_t result = void_mapper(area, squares, 2, buffer, expected_voids);
 
     void_mapper_rectangle_t expected[8] = {
         RECTANGLE(0, 0, 20, 20),    RECTANGLE(20, 0, 10, 20),   RECTANGLE(30, 0, 70, 20),
@@ -178,15 +177,15 @@ END_TEST
 
 START_TEST(case_one_square_partially_outside)
 {
-    uint16_t area_bottom_right_x = area.position.x + area.size.x;
-    uint16_t area_bottom_right_y =  area.position.y + area.size.y;
+    void_mapper_count_t area_bottom_right_x = area.position.x + area.size.x;
+    void_mapper_count_t area_bottom_right_y =  area.position.y + area.size.y;
 
     void_mapper_rectangle_t squares[1] = {
         RECTANGLE(area_bottom_right_x - 5, area_bottom_right_y - 5, 10, 10), // <-- This rectangle is partially outside the area
     };
 
-    uint16_t expected_voids = 3;
-    uint16_t result = void_mapper(area, squares, 1, buffer, expected_voids);
+    void_mapper_count_t expected_voids = 3;
+    void_mapper_count_t result = void_mapper(area, squares, 1, buffer, expected_voids);
 
     ck_assert_int_eq(result, expected_voids);
     void_mapper_rectangle_t expected[3] = {
@@ -208,8 +207,8 @@ START_TEST(case_two_squares_reverse_order)
         RECTANGLE(20, 20, 10, 10),
     };
 
-    uint16_t expected_voids = 23;
-    uint16_t result = void_mapper(area, squares, 2, buffer, expected_voids);
+    void_mapper_count_t expected_voids = 23;
+    void_mapper_count_t result = void_mapper(area, squares, 2, buffer, expected_voids);
 
     ck_assert_int_eq(result, expected_voids);
     void_mapper_rectangle_t expected[23] = {
@@ -235,7 +234,7 @@ START_TEST(case_squares_sharing_x_and_y)
         RECTANGLE(20, 40, 10, 5),
     };
 
-    uint16_t result = void_mapper(area, squares, 3, buffer, buffer_length);
+    void_mapper_count_t result = void_mapper(area, squares, 3, buffer, buffer_length);
 
     void_mapper_rectangle_t expected[22] = {
         RECTANGLE(0, 0,  20, 20),   RECTANGLE(20, 0, 10, 20),   RECTANGLE(30,  0, 10, 20),  RECTANGLE(40,  0, 5, 20),   RECTANGLE(45,  0, 55, 20),
@@ -261,7 +260,7 @@ START_TEST(case_squares_adjacent_x_and_y)
         RECTANGLE(20, 30, 10, 10),
     };
 
-    uint16_t result = void_mapper(area, squares, 3, buffer, buffer_length);
+    void_mapper_count_t result = void_mapper(area, squares, 3, buffer, buffer_length);
 
     void_mapper_rectangle_t expected[13] = {
         RECTANGLE(0, 0,  20, 20),   RECTANGLE(20, 0, 10, 20),   RECTANGLE(30,  0, 10, 20),  RECTANGLE(40,  0, 60, 20),
@@ -287,7 +286,7 @@ START_TEST(case_different_sized_sides)
         RECTANGLE(166, 89, 16, 16)  /* < -- Box 1 */
     };
 
-    uint16_t result = void_mapper(area, squares, 2, buffer, buffer_length);
+    void_mapper_count_t result = void_mapper(area, squares, 2, buffer, buffer_length);
 
     void_mapper_rectangle_t expected[] = {
         RECTANGLE(90, 84, 25, 5),   /* -------------- */ RECTANGLE(166, 84, 16, 5),   RECTANGLE(182, 84, 26, 5),
@@ -326,9 +325,9 @@ START_TEST(case_sort_vectors)
         { {188, 178}, { 11,  27} },
         { {199, 178}, {  8,  27} }
     };
-    uint16_t result = void_mapper(area, squares, sizeof(squares)/sizeof(squares[0]), buffer, buffer_length);
+    void_mapper_count_t result = void_mapper(area, squares, sizeof(squares)/sizeof(squares[0]), buffer, buffer_length);
 
-    for (int i = 0; i < result; i ++) {
+    for (void_mapper_count_t i = 0; i < result; i ++) {
         ck_assert_int_le(buffer[i].position.x, 320);
         ck_assert_int_le(buffer[i].position.x + buffer[i].size.x, 320);
         ck_assert_int_le(buffer[i].position.y, 240);
@@ -337,6 +336,866 @@ START_TEST(case_sort_vectors)
 }
 END_TEST
 
+START_TEST(case_overlapping_squares)
+{
+    void_mapper_rectangle_t squares[2] = {
+        RECTANGLE(20, 20, 20, 20),
+        RECTANGLE(30, 30, 20, 20),
+    };
+
+    void_mapper_count_t result = void_mapper(area, squares, 2, buffer, buffer_length);
+
+    void_mapper_rectangle_t expected[18] = {
+        RECTANGLE(0, 0,  20, 20),   RECTANGLE(20, 0, 10, 20),   RECTANGLE(30,  0, 10, 20),  RECTANGLE(40,  0, 10, 20),  RECTANGLE(50,  0, 50, 20),
+        RECTANGLE(0, 20, 20, 10),   /* Input here */            /* Input here */            RECTANGLE(40, 20, 10, 10),  RECTANGLE(50, 20, 50, 10),
+        RECTANGLE(0, 30, 20, 10),   /* Input here */            /* Both inputs here */      /* Input here */            RECTANGLE(50, 30, 50, 10),
+        RECTANGLE(0, 40, 20, 10),   RECTANGLE(20, 40, 10, 10),  /* Input here */            /* Input here */            RECTANGLE(50, 40, 50, 10),
+        RECTANGLE(0, 50, 20, 150),  RECTANGLE(20, 50, 10, 150), RECTANGLE(30, 50, 10, 150), RECTANGLE(40, 50, 10, 150), RECTANGLE(50, 50, 50, 150),
+    };
+
+    for (unsigned int i = 0; i < sizeof(expected)/sizeof(expected[0]); i ++)
+    {
+        assert_rectangle(expected[i], buffer[i], i);
+    }
+    ck_assert_int_eq(result, sizeof(expected)/sizeof(expected[0]));
+}
+END_TEST
+
+START_TEST(case_large_coordinates)
+{
+    /* Coordinates above INT16_MAX must not be treated as negative numbers */
+    void_mapper_rectangle_t area = RECTANGLE(40000, 40000, 100, 200);
+    void_mapper_rectangle_t square[1] = { RECTANGLE(40020, 40020, 10, 10) };
+
+    void_mapper_count_t result = void_mapper(area, square, 1, buffer, buffer_length);
+
+    void_mapper_rectangle_t expected[8] = {
+        RECTANGLE(40000, 40000, 20, 20),   RECTANGLE(40020, 40000, 10, 20),   RECTANGLE(40030, 40000, 70, 20),
+        RECTANGLE(40000, 40020, 20, 10),   /* Input was here */               RECTANGLE(40030, 40020, 70, 10),
+        RECTANGLE(40000, 40030, 20, 170),  RECTANGLE(40020, 40030, 10, 170),  RECTANGLE(40030, 40030, 70, 170)
+    };
+
+    for (unsigned int i = 0; i < sizeof(expected)/sizeof(expected[0]); i ++)
+    {
+        assert_rectangle(expected[i], buffer[i], i);
+    }
+    ck_assert_int_eq(result, 8);
+}
+END_TEST
+
+START_TEST(case_edge_saturates)
+{
+    /* A rectangle reaching past the largest coordinate ends there instead of wrapping around */
+    void_mapper_rectangle_t area = RECTANGLE(VOID_MAPPER_COORD_MAX - 100, VOID_MAPPER_COORD_MAX - 100, 100, 100);
+    void_mapper_rectangle_t square[1] = { RECTANGLE(VOID_MAPPER_COORD_MAX - 50, VOID_MAPPER_COORD_MAX - 50, 100, 100) };
+
+    void_mapper_count_t result = void_mapper(area, square, 1, buffer, buffer_length);
+
+    void_mapper_rectangle_t expected[3] = {
+        RECTANGLE(VOID_MAPPER_COORD_MAX - 100, VOID_MAPPER_COORD_MAX - 100, 50, 50),
+        RECTANGLE(VOID_MAPPER_COORD_MAX - 50, VOID_MAPPER_COORD_MAX - 100, 50, 50),
+        RECTANGLE(VOID_MAPPER_COORD_MAX - 100, VOID_MAPPER_COORD_MAX - 50, 50, 50),
+    };
+
+    ck_assert_int_eq(result, 3);
+    for (unsigned int i = 0; i < sizeof(expected)/sizeof(expected[0]); i ++)
+    {
+        assert_rectangle(expected[i], buffer[i], i);
+    }
+}
+END_TEST
+
+#if VOID_MAPPER_COORD_BITS == 32
+START_TEST(case_wide_area)
+{
+    /* Areas wider than 16 bit coordinates */
+    void_mapper_rectangle_t area = RECTANGLE(100000, 0, 200000, 10);
+    void_mapper_rectangle_t square[1] = { RECTANGLE(150000, 0, 10, 10) };
+
+    void_mapper_count_t result = void_mapper(area, square, 1, buffer, buffer_length);
+
+    ck_assert_int_eq(result, 2);
+    assert_rectangle((void_mapper_rectangle_t) RECTANGLE(100000, 0, 50000, 10), buffer[0], 0);
+    assert_rectangle((void_mapper_rectangle_t) RECTANGLE(150010, 0, 149990, 10), buffer[1], 1);
+}
+END_TEST
+#endif
+
+START_TEST(case_workspace)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(2) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t squares[2] = {
+        RECTANGLE(20, 20, 10, 10),
+        RECTANGLE(40, 40, 5, 5),
+    };
+    void_mapper_rectangle_t expected[23];
+
+    ck_assert_uint_le(void_mapper_workspace_size(2), sizeof(arena));
+
+    void_mapper_count_t n_expected = void_mapper(area, squares, 2, expected, 23);
+    void_mapper_count_t result = void_mapper_with_workspace(area, squares, 2, buffer, buffer_length, &workspace);
+
+    ck_assert_int_eq(result, n_expected);
+    for (unsigned int i = 0; i < n_expected; i ++)
+    {
+        assert_rectangle(expected[i], buffer[i], i);
+    }
+}
+END_TEST
+
+START_TEST(case_workspace_too_small)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(2) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = void_mapper_workspace_size(2) - 1 };
+    void_mapper_rectangle_t squares[2] = {
+        RECTANGLE(20, 20, 10, 10),
+        RECTANGLE(40, 40, 5, 5),
+    };
+
+    void_mapper_count_t result = void_mapper_with_workspace(area, squares, 2, buffer, buffer_length, &workspace);
+    ck_assert_int_eq(result, 0);
+
+    result = void_mapper_with_workspace(area, squares, 2, buffer, buffer_length, NULL);
+    ck_assert_int_eq(result, 0);
+}
+END_TEST
+
+START_TEST(case_count)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(3) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t squares[3] = {
+        RECTANGLE(20, 20, 10, 10),
+        RECTANGLE(40, 20, 5, 10),
+        RECTANGLE(20, 40, 10, 5),
+    };
+
+    void_mapper_count_t count = void_mapper_count(area, squares, 3, &workspace);
+    ck_assert_int_eq(count, 22);
+
+    // The count is exactly what is needed, one less is not enough
+    ck_assert_int_eq(void_mapper(area, squares, 3, buffer, count), count);
+    ck_assert_int_eq(void_mapper(area, squares, 3, buffer, count - 1), 0);
+
+    ck_assert_int_eq(void_mapper_count(area, NULL, 0, &workspace), 1);
+}
+END_TEST
+
+#ifndef VOID_MAPPER_DETERMINISTIC
+START_TEST(case_count_saturates)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(200) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t large = RECTANGLE(0, 0, 400, 400);
+    void_mapper_rectangle_t squares[200];
+
+    // One pixel squares on the diagonal cut the area in 400 by 400 cells, 200 of them covered
+    for (int i = 0; i < 200; i++) {
+        squares[i] = (void_mapper_rectangle_t) RECTANGLE(2 * i, 2 * i, 1, 1);
+    }
+
+    uint32_t expected = 400 * 400 - 200;
+    expected = expected < VOID_MAPPER_COUNT_MAX ? expected : VOID_MAPPER_COUNT_MAX;
+    ck_assert_uint_eq(void_mapper_count(large, squares, 200, &workspace), expected);
+}
+END_TEST
+#endif
+
+START_TEST(case_residue_moved_square)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(2) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t previous[1] = { RECTANGLE(20, 20, 10, 10) };
+    void_mapper_rectangle_t current[1] = { RECTANGLE(25, 20, 10, 10) };
+
+    void_mapper_count_t result = void_mapper_residue(area, previous, 1, current, 1, NULL, 0, buffer, buffer_length, &workspace);
+
+    void_mapper_rectangle_t expected[1] = { RECTANGLE(20, 20, 5, 10) };
+    assert_rectangle(expected[0], buffer[0], 0);
+    ck_assert_int_eq(result, 1);
+
+    // Nothing moved, nothing to clear
+    result = void_mapper_residue(area, current, 1, current, 1, NULL, 0, buffer, buffer_length, &workspace);
+    ck_assert_int_eq(result, 0);
+}
+END_TEST
+
+START_TEST(case_residue_dirty)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(3) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t previous[1] = { RECTANGLE(95, 195, 10, 10) }; /* <-- Partially outside the area */
+    void_mapper_rectangle_t current[1] = { RECTANGLE(5, 5, 10, 10) };
+    void_mapper_rectangle_t dirty[1] = { RECTANGLE(0, 0, 10, 10) };
+
+    void_mapper_count_t result = void_mapper_residue(area, previous, 1, current, 1, dirty, 1, buffer, buffer_length, &workspace);
+
+    void_mapper_rectangle_t expected[3] = {
+        RECTANGLE(0, 0, 10, 5),
+        RECTANGLE(0, 5, 5, 5),      /* Current was here */
+        RECTANGLE(95, 195, 5, 5),
+    };
+
+    for (unsigned int i = 0; i < sizeof(expected)/sizeof(expected[0]); i ++)
+    {
+        assert_rectangle(expected[i], buffer[i], i);
+    }
+    ck_assert_int_eq(result, sizeof(expected)/sizeof(expected[0]));
+
+    // The buffer is too small
+    result = void_mapper_residue(area, previous, 1, current, 1, dirty, 1, buffer, 2, &workspace);
+    ck_assert_int_eq(result, 0);
+}
+END_TEST
+
+typedef struct {
+    void_mapper_rectangle_t *rectangles;
+    void_mapper_count_t length;
+    void_mapper_count_t limit;
+} collector_t;
+
+static bool collect(void *context, const void_mapper_rectangle_t *rectangle)
+{
+    collector_t *collector = context;
+    collector->rectangles[collector->length++] = *rectangle;
+    return collector->length < collector->limit;
+}
+
+START_TEST(case_stream)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(3) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t squares[3] = {
+        RECTANGLE(20, 20, 10, 10),
+        RECTANGLE(40, 20, 5, 10),
+        RECTANGLE(20, 40, 10, 5),
+    };
+    void_mapper_rectangle_t expected[22];
+    collector_t collector = { .rectangles = buffer, .limit = buffer_length };
+
+    void_mapper_count_t n_expected = void_mapper(area, squares, 3, expected, 22);
+    uint32_t result = void_mapper_stream(area, squares, 3, collect, &collector, &workspace);
+
+    ck_assert_uint_eq(result, n_expected);
+    ck_assert_uint_eq(collector.length, n_expected);
+    for (unsigned int i = 0; i < n_expected; i ++)
+    {
+        assert_rectangle(expected[i], buffer[i], i);
+    }
+}
+END_TEST
+
+START_TEST(case_stream_stop)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(1) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    collector_t collector = { .rectangles = buffer, .limit = 3 };
+
+    uint32_t result = void_mapper_stream(area, square, 1, collect, &collector, &workspace);
+
+    // The callback asked to stop after the third void
+    ck_assert_uint_eq(result, 3);
+    ck_assert_uint_eq(collector.length, 3);
+}
+END_TEST
+
+START_TEST(case_group_one_square)
+{
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+
+    void_mapper_count_t result = void_mapper(area, square, 1, buffer, buffer_length);
+    result = void_mapper_group(buffer, result);
+
+    // The row above the square, both sides of it down to the bottom, then the column below it
+    void_mapper_rectangle_t expected[4] = {
+        RECTANGLE(0, 0, 100, 20),
+        RECTANGLE(0, 20, 20, 180),
+        RECTANGLE(30, 20, 70, 180),
+        RECTANGLE(20, 30, 10, 170),
+    };
+
+    for (unsigned int i = 0; i < sizeof(expected)/sizeof(expected[0]); i ++)
+    {
+        assert_rectangle(expected[i], buffer[i], i);
+    }
+    ck_assert_int_eq(result, 4);
+}
+END_TEST
+
+START_TEST(case_group_no_merge_left)
+{
+    void_mapper_rectangle_t squares[4] = {
+        RECTANGLE(20, 20, 10, 10),
+        RECTANGLE(40, 30, 5, 10),
+        RECTANGLE(10, 60, 30, 5),
+        RECTANGLE(60, 90, 20, 40),
+    };
+
+    void_mapper_count_t result = void_mapper(area, squares, 4, buffer, buffer_length);
+    result = void_mapper_group(buffer, result);
+
+    coverage_assert_exact(area, squares, 4, buffer, result);
+    for (void_mapper_count_t i = 0; i < result; i++) {
+        for (void_mapper_count_t j = 0; j < result; j++) {
+            const void_mapper_rectangle_t *a = &buffer[i];
+            const void_mapper_rectangle_t *b = &buffer[j];
+            ck_assert(!(a->position.y == b->position.y && a->size.y == b->size.y &&
+                        a->position.x + a->size.x == b->position.x));
+            ck_assert(!(a->position.x == b->position.x && a->size.x == b->size.x &&
+                        a->position.y + a->size.y == b->position.y));
+        }
+    }
+}
+END_TEST
+
+static bool can_merge(void_mapper_rectangle_t *a, void_mapper_rectangle_t *b) {
+    return (a->position.x == b->position.x && a->size.x == b->size.x &&
+            ((uint64_t) a->position.y + a->size.y == b->position.y || (uint64_t) b->position.y + b->size.y == a->position.y)) ||
+           (a->position.y == b->position.y && a->size.y == b->size.y &&
+            ((uint64_t) a->position.x + a->size.x == b->position.x || (uint64_t) b->position.x + b->size.x == a->position.x));
+}
+
+static void merge_rectangle(void_mapper_rectangle_t *a, void_mapper_rectangle_t *b) {
+    if (a->position.x == b->position.x && a->size.x == b->size.x) {
+        a->size.y += b->size.y;
+        if (b->position.y < a->position.y) {
+            a->position.y = b->position.y;
+        }
+    } else if (a->position.y == b->position.y && a->size.y == b->size.y) {
+        a->size.x += b->size.x;
+        if (b->position.x < a->position.x) {
+            a->position.x = b->position.x;
+        }
+    }
+}
+
+/**
+ * @brief Group with a plain scan over all pairs, as a reference.
+ */
+static void_mapper_count_t group_pairwise(void_mapper_rectangle_t input[], void_mapper_count_t input_length) {
+    bool merged;
+    do {
+        merged = false;
+        for (void_mapper_count_t i = 0; i < input_length; i++) {
+            if (input[i].size.x == 0 && input[i].size.y == 0) continue;
+            for (void_mapper_count_t j = i + 1; j < input_length; j++) {
+                if (input[j].size.x == 0 && input[j].size.y == 0) continue;
+                if (can_merge(&input[i], &input[j])) {
+                    merge_rectangle(&input[i], &input[j]);
+                    input[j].size.x = 0;
+                    input[j].size.y = 0;
+                    merged = true;
+                }
+            }
+        }
+    } while (merged);
+
+    void_mapper_count_t new_length = 0;
+    for (void_mapper_count_t i = 0; i < input_length; i++) {
+        if (input[i].size.x != 0 && input[i].size.y != 0) {
+            input[new_length++] = input[i];
+        }
+    }
+
+    return new_length;
+}
+
+START_TEST(case_group_pairwise)
+{
+    enum { N = 16, LATTICE = 120 };
+    static void_mapper_rectangle_t voids[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    static void_mapper_rectangle_t expected[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    static void_mapper_rectangle_t hashed[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    static void_mapper_word_t arena[VOID_MAPPER_GROUP_WORKSPACE_SIZE(VOID_MAPPER_MIN_BUFFER_LENGTH(N)) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t squares[N];
+
+    // Same rectangles in the same order as the scan over all pairs, on voids, with or without a workspace
+    srand(37);
+    for (int round = 0; round < 100; round++) {
+        void_mapper_count_t n = 1 + rand() % N;
+        for (void_mapper_count_t i = 0; i < n; i++) {
+            squares[i] = (void_mapper_rectangle_t) RECTANGLE((rand() % 10) * 10, (rand() % 20) * 10, 5 + (rand() % 4) * 5, 5 + (rand() % 4) * 5);
+        }
+
+        void_mapper_count_t n_voids = void_mapper(area, squares, n, voids, VOID_MAPPER_MIN_BUFFER_LENGTH(N));
+        memcpy(expected, voids, n_voids * sizeof(voids[0]));
+        memcpy(hashed, voids, n_voids * sizeof(voids[0]));
+        void_mapper_count_t n_expected = group_pairwise(expected, n_voids);
+
+        void_mapper_count_t result = void_mapper_group(voids, n_voids);
+        ck_assert_uint_eq(result, n_expected);
+        ck_assert_mem_eq(voids, expected, result * sizeof(voids[0]));
+
+        result = void_mapper_group_with_workspace(hashed, n_voids, &workspace);
+        ck_assert_uint_eq(result, n_expected);
+        ck_assert_mem_eq(hashed, expected, result * sizeof(hashed[0]));
+    }
+
+    // And on rectangles on a lattice, which overlap, repeat each other and share many sides
+    for (int round = 0; round < 100; round++) {
+        void_mapper_count_t n = 1 + rand() % LATTICE;
+        for (void_mapper_count_t i = 0; i < n; i++) {
+            voids[i] = (void_mapper_rectangle_t) RECTANGLE((rand() % 6) * 4, (rand() % 6) * 4, (1 + rand() % 2) * 4, (1 + rand() % 2) * 4);
+        }
+        memcpy(expected, voids, n * sizeof(voids[0]));
+        void_mapper_count_t n_expected = group_pairwise(expected, n);
+
+        void_mapper_count_t result = void_mapper_group_with_workspace(voids, n, &workspace);
+        ck_assert_uint_eq(result, n_expected);
+        ck_assert_mem_eq(voids, expected, result * sizeof(voids[0]));
+    }
+
+    // The workspace is too small
+    void_mapper_workspace_t small = { .memory = arena, .size = void_mapper_group_workspace_size(4) - 1 };
+    ck_assert_uint_le(void_mapper_group_workspace_size(4), VOID_MAPPER_GROUP_WORKSPACE_SIZE(4));
+    ck_assert_uint_eq(void_mapper_group_with_workspace(voids, 4, &small), 0);
+}
+END_TEST
+
+START_TEST(case_grouped)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(4) / sizeof(void_mapper_word_t) + 1];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t squares[4] = {
+        RECTANGLE(20, 20, 10, 10),
+        RECTANGLE(40, 30, 5, 10),
+        RECTANGLE(10, 60, 30, 5),
+        RECTANGLE(60, 90, 20, 40),
+    };
+
+    void_mapper_count_t result = void_mapper_grouped(area, squares, 4, buffer, buffer_length, &workspace);
+    ck_assert_int_gt(result, 0);
+    coverage_assert_exact(area, squares, 4, buffer, result);
+
+    // Never more voids than the plain grid
+    ck_assert_int_le(result, void_mapper_count(area, squares, 4, &workspace));
+
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    result = void_mapper_grouped(area, square, 1, buffer, buffer_length, &workspace);
+    ck_assert_int_eq(result, 4);
+    void_mapper_rectangle_t bottom = RECTANGLE(0, 30, 100, 170);
+    assert_rectangle(bottom, buffer[3], 3);
+
+    // The buffer is too small
+    ck_assert_int_eq(void_mapper_grouped(area, square, 1, buffer, 3, &workspace), 0);
+}
+END_TEST
+
+START_TEST(case_normalize)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(16) / sizeof(void_mapper_word_t) + 1];
+    static void_mapper_rectangle_t voids[VOID_MAPPER_MIN_BUFFER_LENGTH(16)];
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+
+    // Outside, empty, within another one, and a row of 4 tiles overlapping the bottom edge
+    void_mapper_rectangle_t tiles[8] = {
+        RECTANGLE(120, 10, 10, 10),
+        RECTANGLE(10, 10, 0, 10),
+        RECTANGLE(10, 10, 30, 30),
+        RECTANGLE(15, 15, 10, 10),
+        RECTANGLE(0, 190, 25, 20),
+        RECTANGLE(25, 190, 25, 20),
+        RECTANGLE(50, 190, 25, 20),
+        RECTANGLE(70, 190, 30, 20),
+    };
+    void_mapper_rectangle_t expected[2] = {
+        RECTANGLE(10, 10, 30, 30),
+        RECTANGLE(0, 190, 100, 10),
+    };
+
+    void_mapper_count_t result = void_mapper_normalize(area, tiles, 8);
+    ck_assert_uint_eq(result, 2);
+    assert_rectangle(expected[0], tiles[0], 0);
+    assert_rectangle(expected[1], tiles[1], 1);
+
+    // Random inputs keep the same void, with no more voids found
+    void_mapper_rectangle_t input[16];
+    void_mapper_rectangle_t normalized[16];
+    srand(31);
+    for (int round = 0; round < 100; round++) {
+        void_mapper_count_t input_length = 1 + rand() % 16;
+        for (void_mapper_count_t i = 0; i < input_length; i++) {
+            // Coarse positions make tiles in line and blockers within others common
+            input[i] = (void_mapper_rectangle_t) RECTANGLE(10 * (rand() % 12), 10 * (rand() % 22), 10 * (rand() % 5), 10 * (rand() % 5));
+        }
+        memcpy(normalized, input, sizeof(input));
+        void_mapper_count_t n_normalized = void_mapper_normalize(area, normalized, input_length);
+        ck_assert_uint_le(n_normalized, input_length);
+
+        void_mapper_count_t n_voids = void_mapper_grouped(area, normalized, n_normalized, voids, VOID_MAPPER_MIN_BUFFER_LENGTH(16), &workspace);
+        coverage_assert_exact(area, input, input_length, voids, n_voids);
+        ck_assert_uint_le(n_voids, void_mapper_grouped(area, input, input_length, voids, VOID_MAPPER_MIN_BUFFER_LENGTH(16), &workspace));
+    }
+}
+END_TEST
+
+START_TEST(case_overdraw)
+{
+    enum { N = 20 };
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(N) / sizeof(void_mapper_word_t) + 1];
+    static void_mapper_rectangle_t grouped[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    static void_mapper_rectangle_t result[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    static uint8_t covered[100 * 200];
+    static uint8_t cleared[100 * 200];
+    const void_mapper_count_t length = sizeof(result) / sizeof(result[0]);
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+
+    // A pillar splits the area in two, bridging it costs 20 * 200 pixels
+    void_mapper_rectangle_t pillar[1] = { RECTANGLE(40, 0, 20, 200) };
+    void_mapper_cost_t cheap_pixels = { .per_command = 5000, .per_pixel = 1 };
+    void_mapper_cost_t dear_pixels = { .per_command = 3000, .per_pixel = 1 };
+    ck_assert_int_eq(void_mapper_overdraw(area, pillar, 1, &cheap_pixels, result, length, &workspace), 1);
+    assert_rectangle(area, result[0], 0);
+    ck_assert_int_eq(void_mapper_overdraw(area, pillar, 1, &dear_pixels, result, length, &workspace), 2);
+    ck_assert_uint_eq(void_mapper_cost(&dear_pixels, result, 2), 2 * 3000 + 80 * 200);
+
+    // Every void is cleared, and never at a higher cost than the grouped voids
+    srand(17);
+    void_mapper_rectangle_t squares[N];
+    void_mapper_cost_t costs[3] = { { 0, 1 }, { 400, 1 }, { 1, 0 } };
+    for (int round = 0; round < 30; round++) {
+        void_mapper_count_t n = 1 + rand() % N;
+        for (void_mapper_count_t i = 0; i < n; i++) {
+            squares[i] = (void_mapper_rectangle_t) RECTANGLE(rand() % 110, rand() % 210, 1 + rand() % 30, 1 + rand() % 30);
+        }
+
+        void_mapper_count_t n_grouped = void_mapper_grouped(area, squares, n, grouped, length, &workspace);
+        const void_mapper_cost_t *cost = &costs[round % 3];
+        void_mapper_count_t n_result = void_mapper_overdraw(area, squares, n, cost, result, length, &workspace);
+        ck_assert_int_gt(n_result, 0);
+        ck_assert_int_le(n_result, n_grouped);
+        ck_assert_uint_le(void_mapper_cost(cost, result, n_result), void_mapper_cost(cost, grouped, n_grouped));
+
+        memset(covered, 0, sizeof(covered));
+        memset(cleared, 0, sizeof(cleared));
+        coverage_add(covered, area, squares, n);
+        coverage_add(cleared, area, result, n_result);
+        for (size_t p = 0; p < sizeof(covered); p++) {
+            ck_assert_msg(covered[p] > 0 || cleared[p] > 0, "void pixel (%zu, %zu) not cleared", p % 100, p / 100);
+        }
+    }
+
+    // Without a cost model the voids are the grouped ones
+    ck_assert_int_eq(void_mapper_overdraw(area, pillar, 1, NULL, result, length, &workspace), 2);
+}
+END_TEST
+
+START_TEST(case_aligned)
+{
+    enum { N = 20 };
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(N) / sizeof(void_mapper_word_t) + 1];
+    static void_mapper_rectangle_t result[5 * VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    const void_mapper_count_t length = sizeof(result) / sizeof(result[0]);
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    void_mapper_alignment_t pages = { .x = 8, .y = 8 };
+    void_mapper_rectangle_t expected[8] = {
+        RECTANGLE(0, 0, 96, 16),
+        RECTANGLE(96, 0, 4, 16),
+        RECTANGLE(0, 16, 100, 4),
+        RECTANGLE(0, 20, 20, 10),
+        RECTANGLE(30, 20, 70, 10),
+        RECTANGLE(0, 30, 100, 2),
+        RECTANGLE(0, 32, 96, 168),
+        RECTANGLE(96, 32, 4, 168),
+    };
+    ck_assert_int_eq(void_mapper_aligned(area, square, 1, &pages, result, length, &workspace), 8);
+    for (int i = 0; i < 8; i++) {
+        assert_rectangle(expected[i], result[i], i);
+    }
+    ck_assert_int_eq(pages.n_aligned, 2);
+    ck_assert_int_eq(pages.n_unaligned, 6);
+
+    // The buffer holds the grouped voids but not their pieces
+    ck_assert_int_eq(void_mapper_aligned(area, square, 1, &pages, result, 7, &workspace), 0);
+
+    // Without alignment the voids are the grouped ones, all aligned
+    void_mapper_alignment_t any = { .x = 1, .y = 0 };
+    ck_assert_int_eq(void_mapper_aligned(area, square, 1, &any, result, length, &workspace), 4);
+    ck_assert_int_eq(any.n_aligned, 4);
+    ck_assert_int_eq(any.n_unaligned, 0);
+
+    srand(18);
+    void_mapper_rectangle_t squares[N];
+    for (int round = 0; round < 20; round++) {
+        void_mapper_count_t n = 1 + rand() % N;
+        for (void_mapper_count_t i = 0; i < n; i++) {
+            squares[i] = (void_mapper_rectangle_t) RECTANGLE(rand() % 110, rand() % 210, rand() % 30, rand() % 30);
+        }
+
+        void_mapper_alignment_t alignment = { .x = 1 + rand() % 8, .y = 1 + rand() % 8 };
+        void_mapper_count_t n_result = void_mapper_aligned(area, squares, n, &alignment, result, length, &workspace);
+        coverage_assert_exact(area, squares, n, result, n_result);
+        ck_assert_int_eq(alignment.n_aligned + alignment.n_unaligned, n_result);
+
+        void_mapper_count_t n_aligned = 0;
+        for (void_mapper_count_t i = 0; i < n_result; i++) {
+            n_aligned += result[i].position.x % alignment.x == 0 && result[i].size.x % alignment.x == 0 &&
+                         result[i].position.y % alignment.y == 0 && result[i].size.y % alignment.y == 0;
+        }
+        ck_assert_int_eq(alignment.n_aligned, n_aligned);
+    }
+}
+END_TEST
+
+static uint32_t ticks;
+
+static uint32_t tick(void)
+{
+    return ticks++;
+}
+
+START_TEST(case_anytime)
+{
+    enum { N = 20 };
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(N) / sizeof(void_mapper_word_t) + 1];
+    static void_mapper_rectangle_t grouped[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    static void_mapper_rectangle_t result[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    static uint8_t covered[100 * 200];
+    static uint8_t cleared[100 * 200];
+    const void_mapper_count_t length = sizeof(result) / sizeof(result[0]);
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t squares[N];
+
+    srand(21);
+    for (int round = 0; round < 20; round++) {
+        void_mapper_count_t n = 1 + rand() % N;
+        for (void_mapper_count_t i = 0; i < n; i++) {
+            squares[i] = (void_mapper_rectangle_t) RECTANGLE(rand() % 110, rand() % 210, rand() % 30, rand() % 30);
+        }
+        void_mapper_count_t n_grouped = void_mapper_grouped(area, squares, n, grouped, length, &workspace);
+
+        // A few rows per call after building the grid, no partial result covers input
+        void_mapper_budget_t budget = { .max_operations = VOID_MAPPER_WCET_GRID_STEPS(n) + 3 * (2 * n + 1 + n) };
+        void_mapper_progress_t progress = { 0 };
+        void_mapper_count_t n_result;
+        int n_calls = 0;
+        do {
+            n_result = void_mapper_anytime(area, squares, n, &budget, &progress, result, length, &workspace);
+            ck_assert_int_le(progress.n_exact, n_result);
+            n_calls++;
+
+            for (void_mapper_count_t c = progress.n_exact; c < n_result; c++) {
+                ck_assert_int_ge(result[c].position.y, progress.refined);
+                for (void_mapper_count_t i = 0; i < n; i++) {
+                    bool crosses = squares[i].size.x > 0 && squares[i].size.y > 0 &&
+                                   result[c].position.x < squares[i].position.x + squares[i].size.x &&
+                                   squares[i].position.x < result[c].position.x + result[c].size.x &&
+                                   result[c].position.y < squares[i].position.y + squares[i].size.y &&
+                                   squares[i].position.y < result[c].position.y + result[c].size.y;
+                    ck_assert_msg(!crosses, "cover %u crosses square %u", (unsigned) c, (unsigned) i);
+                }
+            }
+
+            // The void is cleared once down to the refined row, the input never
+            memset(covered, 0, sizeof(covered));
+            memset(cleared, 0, sizeof(cleared));
+            coverage_add(covered, area, squares, n);
+            coverage_add(cleared, area, result, n_result);
+            for (size_t p = 0; p < sizeof(covered); p++) {
+                ck_assert_int_le(cleared[p], covered[p] > 0 ? 0 : 1);
+                ck_assert_msg(p / 100 >= progress.refined || covered[p] > 0 || cleared[p] > 0,
+                              "void pixel (%zu, %zu) not cleared", p % 100, p / 100);
+            }
+        } while (!progress.exact);
+
+        // Refined in slices, the result ends up the same as the one of a single pass
+        ck_assert_int_gt(n_calls, 1);
+        ck_assert_int_eq(progress.refined, 200);
+        ck_assert_int_eq(n_result, n_grouped);
+        ck_assert_mem_eq(result, grouped, n_grouped * sizeof(grouped[0]));
+    }
+
+    // A deadline already passed leaves the cover around the square only, without building the grid
+    void_mapper_rectangle_t square[1] = { RECTANGLE(20, 20, 10, 10) };
+    void_mapper_budget_t deadline = { .clock = tick, .deadline = 0 };
+    void_mapper_progress_t progress = { 0 };
+    ticks = 0;
+    ck_assert_int_eq(void_mapper_anytime(area, square, 1, &deadline, &progress, result, length, NULL), 2);
+    void_mapper_rectangle_t left = RECTANGLE(0, 0, 20, 200);
+    void_mapper_rectangle_t right = RECTANGLE(30, 0, 70, 200);
+    assert_rectangle(left, result[0], 0);
+    assert_rectangle(right, result[1], 1);
+    ck_assert(!progress.exact);
+
+    // So does a budget of operations smaller than the grid
+    void_mapper_budget_t small = { .max_operations = VOID_MAPPER_WCET_GRID_STEPS(1) - 1 };
+    ck_assert_int_eq(void_mapper_anytime(area, square, 1, &small, &progress, result, length, NULL), 2);
+    ck_assert_int_eq(progress.refined, 0);
+
+    // Each reading of the clock past the one before the grid allows one more row
+    deadline.deadline = 4;
+    ck_assert_int_eq(void_mapper_anytime(area, square, 1, &deadline, &progress, result, length, &workspace), 4);
+    ck_assert_int_eq(progress.n_exact, 3);
+    ck_assert_int_eq(progress.refined, 30);
+    void_mapper_rectangle_t rest = RECTANGLE(0, 30, 100, 170);
+    assert_rectangle(rest, result[3], 3);
+
+    // Without a budget it completes, and stays complete
+    ck_assert_int_eq(void_mapper_anytime(area, square, 1, NULL, &progress, result, length, &workspace), 4);
+    ck_assert(progress.exact);
+    ck_assert_int_eq(void_mapper_anytime(area, square, 1, NULL, &progress, result, length, &workspace), 4);
+    ck_assert_int_eq(void_mapper_anytime(area, square, 1, NULL, &progress, result, 4, &workspace), 0);
+
+    // A band crossed by a bar through its width has no cover
+    void_mapper_rectangle_t bar[1] = { RECTANGLE(0, 20, 100, 10) };
+    progress = (void_mapper_progress_t) { 0 };
+    ck_assert_int_eq(void_mapper_anytime(area, bar, 1, &small, &progress, result, length, NULL), 0);
+}
+END_TEST
+
+#ifdef VOID_MAPPER_DETERMINISTIC
+
+#define STACK_PATTERN 0xA5
+
+static uint8_t stack[256 * 1024] __attribute__((aligned(64)));
+
+/**
+ * @brief Map the number of squares pointed to by the argument, on a stack of its own.
+ */
+static void *map_on_stack(void *arg)
+{
+    static void_mapper_rectangle_t voids[VOID_MAPPER_MAX_VOIDS];
+    void_mapper_rectangle_t squares[VOID_MAPPER_MAX_SPRITES];
+    void_mapper_count_t n = *(void_mapper_count_t *) arg;
+    if (n == 0) {
+        return NULL;
+    }
+
+    for (void_mapper_count_t i = 0; i < n; i++) {
+        squares[i] = (void_mapper_rectangle_t) RECTANGLE(1 + 3 * i, 1 + 6 * i, 2, 2);
+    }
+
+    *(void_mapper_count_t *) arg = void_mapper(area, squares, n, voids, VOID_MAPPER_MAX_VOIDS);
+    return NULL;
+}
+
+/**
+ * @brief Run a mapping on a painted stack and measure how deep it went.
+ */
+static size_t stack_used(void_mapper_count_t n, void_mapper_count_t *result)
+{
+    memset(stack, STACK_PATTERN, sizeof(stack));
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, sizeof(stack));
+    pthread_t thread;
+    *result = n;
+    ck_assert_int_eq(pthread_create(&thread, &attr, map_on_stack, result), 0);
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+
+    /* The stack grows down, the lowest byte written is its depth */
+    size_t untouched = 0;
+    while (untouched < sizeof(stack) && stack[untouched] == STACK_PATTERN) {
+        untouched++;
+    }
+    return sizeof(stack) - untouched;
+}
+
+START_TEST(case_deterministic)
+{
+    void_mapper_count_t result;
+
+    // The stack is the same for any input, and within the published bound with its margin to spare
+    size_t thread = stack_used(0, &result);
+    size_t smallest = stack_used(1, &result) - thread;
+    ck_assert_int_eq(result, 8);
+    size_t largest = stack_used(VOID_MAPPER_MAX_SPRITES, &result) - thread;
+    ck_assert_int_gt(result, 0);
+    ck_assert_uint_eq(smallest, largest);
+    ck_assert_uint_le(largest - VOID_MAPPER_WORKSPACE_SIZE(VOID_MAPPER_MAX_SPRITES), VOID_MAPPER_STACK_OVERHEAD);
+    ck_assert_uint_le(largest + VOID_MAPPER_STACK_MARGIN, VOID_MAPPER_WCET_STACK(VOID_MAPPER_MAX_SPRITES));
+
+    // Larger inputs are refused
+    static void_mapper_rectangle_t squares[VOID_MAPPER_MAX_SPRITES + 1];
+    ck_assert_int_eq(void_mapper(area, squares, VOID_MAPPER_MAX_SPRITES + 1, buffer, buffer_length), 0);
+}
+END_TEST
+
+#endif /* VOID_MAPPER_DETERMINISTIC */
+
+START_TEST(case_soa)
+{
+    /* Enough rectangles for the vector kernels and their remainders */
+    enum { N = 45 };
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(N) / sizeof(void_mapper_word_t) + 1];
+    static void_mapper_rectangle_t expected[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    static void_mapper_rectangle_t result[VOID_MAPPER_MIN_BUFFER_LENGTH(N)];
+    const void_mapper_count_t length = sizeof(result) / sizeof(result[0]);
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t squares[N];
+    void_mapper_coord_t x[N], y[N], width[N], height[N];
+
+    srand(5);
+    for (int round = 0; round < 20; round++) {
+        void_mapper_count_t n = 1 + rand() % N;
+        for (void_mapper_count_t i = 0; i < n; i++) {
+            x[i] = rand() % 110;
+            y[i] = rand() % 210;
+            width[i] = rand() % 30;
+            height[i] = rand() % 30;
+            squares[i] = (void_mapper_rectangle_t) RECTANGLE(x[i], y[i], width[i], height[i]);
+        }
+
+        void_mapper_count_t n_expected = void_mapper_with_workspace(area, squares, n, expected, length, &workspace);
+        void_mapper_count_t n_result = void_mapper_soa(area, x, y, width, height, n, result, length, &workspace);
+
+        ck_assert_int_eq(n_result, n_expected);
+        for (void_mapper_count_t i = 0; i < n_expected; i++) {
+            assert_rectangle(expected[i], result[i], i);
+        }
+    }
+
+    ck_assert_int_eq(void_mapper_soa(area, NULL, NULL, NULL, NULL, 0, result, length, &workspace), 1);
+    ck_assert_int_eq(void_mapper_soa(area, x, y, width, height, 1, result, length, NULL), 0);
+}
+END_TEST
+
+START_TEST(case_batch)
+{
+    static void_mapper_word_t arena[VOID_MAPPER_WORKSPACE_SIZE(3) / sizeof(void_mapper_word_t) + 1];
+    static void_mapper_rectangle_t outputs[4][VOID_MAPPER_MIN_BUFFER_LENGTH(3)];
+    const void_mapper_count_t length = VOID_MAPPER_MIN_BUFFER_LENGTH(3);
+    void_mapper_workspace_t workspace = { .memory = arena, .size = sizeof(arena) };
+    void_mapper_rectangle_t panel = RECTANGLE(320, 0, 320, 240);
+    void_mapper_rectangle_t squares[3] = { RECTANGLE(20, 20, 10, 10), RECTANGLE(40, 40, 10, 10), RECTANGLE(340, 30, 50, 50) };
+    void_mapper_job_t jobs[5] = {
+        { .area = area, .input = squares, .input_length = 2, .buffer = outputs[0], .buffer_length = length },
+        { .area = panel, .input = squares, .input_length = 3, .buffer = outputs[1], .buffer_length = length },
+        { .area = area, .input = NULL, .input_length = 0, .buffer = outputs[2], .buffer_length = length },
+        { .area = area, .input = squares, .input_length = 1, .buffer = outputs[3], .buffer_length = 3 },  /* <-- Too small */
+        { .area = area, .input = squares, .input_length = 1, .buffer = NULL, .buffer_length = 0 },
+    };
+
+    ck_assert_uint_eq(void_mapper_batch_workspace_size(jobs, 5), void_mapper_workspace_size(3));
+    ck_assert_uint_eq(void_mapper_batch(jobs, 5, &workspace), 2);
+
+    // Every job gives the same voids as its own call
+    for (int j = 0; j < 2; j++) {
+        void_mapper_count_t result = void_mapper_with_workspace(jobs[j].area, squares, jobs[j].input_length, buffer, buffer_length, &workspace);
+        ck_assert_uint_eq(jobs[j].result, result);
+        for (void_mapper_count_t i = 0; i < result; i++) {
+            assert_rectangle(buffer[i], jobs[j].buffer[i], i);
+        }
+    }
+    ck_assert_uint_eq(jobs[2].result, 1);
+    assert_rectangle(area, outputs[2][0], 0);
+    ck_assert_uint_eq(jobs[3].result, 0);
+    ck_assert_uint_eq(jobs[4].result, 0);
+
+    // With a workspace too small only the jobs without input succeed
+    workspace.size = void_mapper_workspace_size(2);
+    ck_assert_uint_eq(void_mapper_batch(jobs, 3, &workspace), 2);
+    ck_assert_uint_eq(jobs[2].result, 1);
+}
+END_TEST
+
 Suite * void_mapper_suite(void)
 {
     Suite *s;
@@ -361,6 +1220,35 @@ Suite * void_mapper_suite(void)
     tcase_add_test(tc_core, case_squares_adjacent_x_and_y);
     tcase_add_test(tc_core, case_different_sized_sides);
     tcase_add_test(tc_core, case_sort_vectors);
+    tcase_add_test(tc_core, case_overlapping_squares);
+    tcase_add_test(tc_core, case_large_coordinates);
+    tcase_add_test(tc_core, case_edge_saturates);
+#if VOID_MAPPER_COORD_BITS == 32
+    tcase_add_test(tc_core, case_wide_area);
+#endif
+    tcase_add_test(tc_core, case_workspace);
+    tcase_add_test(tc_core, case_workspace_too_small);
+    tcase_add_test(tc_core, case_count);
+#ifndef VOID_MAPPER_DETERMINISTIC
+    tcase_add_test(tc_core, case_count_saturates);
+#endif
+    tcase_add_test(tc_core, case_residue_moved_square);
+    tcase_add_test(tc_core, case_residue_dirty);
+    tcase_add_test(tc_core, case_stream);
+    tcase_add_test(tc_core, case_stream_stop);
+    tcase_add_test(tc_core, case_group_one_square);
+    tcase_add_test(tc_core, case_group_no_merge_left);
+    tcase_add_test(tc_core, case_group_pairwise);
+    tcase_add_test(tc_core, case_grouped);
+    tcase_add_test(tc_core, case_normalize);
+    tcase_add_test(tc_core, case_overdraw);
+    tcase_add_test(tc_core, case_aligned);
+    tcase_add_test(tc_core, case_anytime);
+#ifdef VOID_MAPPER_DETERMINISTIC
+    tcase_add_test(tc_core, case_deterministic);
+#endif
+    tcase_add_test(tc_core, case_soa);
+    tcase_add_test(tc_core, case_batch);
     suite_add_tcase(s, tc_core);
 
     return s;
@@ -374,6 +1262,17 @@ int main(void)
 
     s = void_mapper_suite();
     sr = srunner_create(s);
+    srunner_add_suite(sr, coordinates_suite());
+    srunner_add_suite(sr, context_suite());
+    srunner_add_suite(sr, partition_suite());
+    srunner_add_suite(sr, stats_suite());
+    srunner_add_suite(sr, sweep_suite());
+    srunner_add_suite(sr, parallel_suite());
+    srunner_add_suite(sr, cache_suite());
+    srunner_add_suite(sr, mask_suite());
+    srunner_add_suite(sr, encode_suite());
+    srunner_add_suite(sr, index_suite());
+    srunner_add_suite(sr, replay_suite());
 
     srunner_set_fork_status(sr, CK_NOFORK);
 
@@ -0,0 +1,45 @@
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "coverage.h"
+
+void coverage_add(uint8_t *pixels, void_mapper_rectangle_t area, const void_mapper_rectangle_t *rectangles, void_mapper_count_t length)
+{
+    for (void_mapper_count_t k = 0; k < length; k++) {
+        const void_mapper_rectangle_t *r = &rectangles[k];
+        for (uint64_t y = r->position.y; y < (uint64_t) r->position.y + r->size.y; y++) {
+            if (y < area.position.y || y >= (uint64_t) area.position.y + area.size.y) {
+                continue;
+            }
+            for (uint64_t x = r->position.x; x < (uint64_t) r->position.x + r->size.x; x++) {
+                if (x < area.position.x || x >= (uint64_t) area.position.x + area.size.x) {
+                    continue;
+                }
+                pixels[(y - area.position.y) * area.size.x + (x - area.position.x)]++;
+            }
+        }
+    }
+}
+
+void coverage_assert_exact(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                           const void_mapper_rectangle_t *rectangles, void_mapper_count_t length)
+{
+    size_t n_pixels = (size_t) area.size.x * area.size.y;
+    uint8_t *blocked = calloc(n_pixels, 1);
+    uint8_t *covered = calloc(n_pixels, 1);
+    ck_assert_ptr_nonnull(blocked);
+    ck_assert_ptr_nonnull(covered);
+
+    coverage_add(blocked, area, input, input_length);
+    coverage_add(covered, area, rectangles, length);
+
+    for (size_t i = 0; i < n_pixels; i++) {
+        uint8_t expected = blocked[i] ? 0 : 1;
+        ck_assert_msg(covered[i] == expected, "pixel (%i, %i) covered %i times, expected %i",
+                      (int)(area.position.x + i % area.size.x), (int)(area.position.y + i / area.size.x),
+                      covered[i], expected);
+    }
+
+    free(blocked);
+    free(covered);
+}
@@ -0,0 +1,31 @@
+#ifndef __COVERAGE_H__
+#define __COVERAGE_H__
+
+#include <stdint.h>
+#include "void_mapper.h"
+
+/**
+ * @brief Count how many times each pixel of the area is covered by the rectangles. The
+ * pixels are stored row by row, area.size.x pixels per row. Parts of the rectangles
+ * outside the area are ignored.
+ *
+ * @param pixels Coverage count of each pixel, increased by the call
+ * @param area Area of the pixels
+ * @param rectangles Rectangles to count
+ * @param length Number of rectangles
+ */
+void coverage_add(uint8_t *pixels, void_mapper_rectangle_t area, const void_mapper_rectangle_t *rectangles, void_mapper_count_t length);
+
+/**
+ * @brief Assert that the rectangles cover every void pixel exactly once and no pixel of the input.
+ *
+ * @param area Area to search
+ * @param input Array of the non void areas
+ * @param input_length Number of elements of the input array
+ * @param rectangles Rectangles covering the void
+ * @param length Number of rectangles
+ */
+void coverage_assert_exact(void_mapper_rectangle_t area, const void_mapper_rectangle_t *input, void_mapper_count_t input_length,
+                           const void_mapper_rectangle_t *rectangles, void_mapper_count_t length);
+
+#endif /* __COVERAGE_H__ */
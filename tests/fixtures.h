@@ -0,0 +1,13 @@
+#ifndef __FIXTURES_H__
+#define __FIXTURES_H__
+
+#include "void_mapper.h"
+
+/* Initializer of a rectangle, shared by the suites */
+#define RECTANGLE(px, py, sw, sl)               \
+        {                                       \
+            .position = { .x = px, .y = py},    \
+            .size = { .x = sw, .y = sl },       \
+        }                                       \
+
+#endif /* __FIXTURES_H__ */
@@ -0,0 +1,19 @@
+#ifndef __SUITES_H__
+#define __SUITES_H__
+
+#include <check.h>
+
+Suite * void_mapper_suite(void);
+Suite * coordinates_suite(void);
+Suite * context_suite(void);
+Suite * partition_suite(void);
+Suite * stats_suite(void);
+Suite * sweep_suite(void);
+Suite * parallel_suite(void);
+Suite * cache_suite(void);
+Suite * mask_suite(void);
+Suite * encode_suite(void);
+Suite * index_suite(void);
+Suite * replay_suite(void);
+
+#endif /* __SUITES_H__ */